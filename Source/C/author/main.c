@@ -0,0 +1,383 @@
+/**
+ * \file 		main.c
+ * \brief 		Define the main function
+ */
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "../config.h"
+#include "../synthesis/profile.h"
+#include "../synthesis/merge.h"
+#include "../synthesis/pool.h"
+#include "../synthesis/radix.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define input_file (argv[1]) /* input_file */
+#define BIN_FORMAT (".bin") /* synthesis format */
+#define ORDER_GRAMS ("order_grams.bin") /* profile of an author */
+#define ORDER_CHUNK 4096 /* num of grams written at once */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		author_t
+ * \note		This structure is used to implement an author with its works.
+*/
+typedef struct
+{
+	char 	    name[FILENAME_MAX]; 	/*!< folder of the author */
+	int32_t* 	works; 	                /*!< index of each work in the list */
+	int32_t 	count; 	                /*!< num of works */
+} author_t;
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+char 	            source_directory[FILENAME_MAX]; 	/*!< directory of the training syntheses */
+char 	            destination_directory[FILENAME_MAX]; 	/*!< directory of the training analyses */
+char** 	            names; 	                /*!< list of works respect the folder */
+int32_t 	        count; 	                /*!< num of works */
+author_t* 	        authors; 	            /*!< authors of the works */
+int32_t 	        num_of_authors; 	    /*!< num of authors */
+atomic_int 	        next; 	                /*!< next author of the threads */
+pthread_t* 	        threads; 	            /*!< vector of threads */
+int32_t 	        num_of_threads; 	    /*!< num of threads */
+pthread_mutex_t 	error_mutex; 	        /*!< mutex used to coordinate error reporting.  */
+uint8_t 	        flag; 	                /*!< if flag is 0 the threads stop */
+char 	            buffer[8]; 	            /*!< buffer used to save the format images */
+
+int 	aggregate(const author_t*);
+int 	write_profile(const merged_t*, const char*);
+void* 	activation(void*);
+int 	read_input(FILE*);
+void 	free_input(void);
+int 	main(int, char**);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    write the profile of an author
+ * \note 	    the grams are sorted by increasing recurrence, equal recurrences keep the
+ *              order of the grams. A gram is packed in (gram_size^2 + 7) / 8 bytes, its
+ *              first pixel is the most significant bit of the first byte. The recurrences
+ *              are written as uint64, as the sums of the works can exceed 32 bits.
+ * \param[in] 	profile: merged profile of the author
+ * \param[in] 	path: output file
+ * \return 		0: any error.
+ *              1: out of memory.
+ *              2: the file can not be written.
+ */
+int
+write_profile(const merged_t* profile, const char* path)
+{
+	uint32_t bits = (uint32_t)(profile->gram_size * profile->gram_size), bytes = (bits + 7) / 8;
+	uint64_t* keys = malloc((profile->size + 1) * sizeof (uint64_t));
+	size_t* order = malloc((profile->size + 1) * sizeof (size_t));
+	int32_t header[2] = {profile->gram_size, (int32_t)profile->size};
+	uint8_t grams[ORDER_CHUNK * 8];
+	uint64_t recurrences[ORDER_CHUNK];
+	FILE* fp;
+	bool written;
+
+	if (keys == NULL || order == NULL) {
+		free(keys);
+		free(order);
+		return 1;
+	}
+	for (size_t i = 0; i < profile->size; ++i) {
+		keys[i] = profile->counts[i];
+		order[i] = i;
+	}
+	if (radix_sort(keys, order, profile->size, 64, NULL, NULL)) {
+		free(keys);
+		free(order);
+		return 1;
+	}
+	free(keys);
+
+	fp = fopen(path, "wb");
+	if (fp == NULL) {
+		free(order);
+		return 2;
+	}
+	written = fwrite(header, sizeof (int32_t), 2, fp) == 2;
+	for (size_t k = 0; written && k < profile->size; k += ORDER_CHUNK) {
+		size_t len = profile->size - k < ORDER_CHUNK ? profile->size - k : ORDER_CHUNK;
+
+		for (size_t i = 0; i < len; ++i) {
+			uint64_t code = profile->codes[order[k + i]] << (8*bytes - bits);
+
+			for (uint32_t b = 0; b < bytes; ++b)
+				grams[i*bytes + b] = (uint8_t)(code >> (8*(bytes - 1 - b)));
+		}
+		written = fwrite(grams, bytes, len, fp) == len;
+	}
+	for (size_t k = 0; written && k < profile->size; k += ORDER_CHUNK) {
+		size_t len = profile->size - k < ORDER_CHUNK ? profile->size - k : ORDER_CHUNK;
+
+		for (size_t i = 0; i < len; ++i)
+			recurrences[i] = profile->counts[order[k + i]];
+		written = fwrite(recurrences, sizeof (uint64_t), len, fp) == len;
+	}
+	free(order);
+	return fclose(fp) != 0 || !written ? 2 : 0;
+}
+
+/**
+ * \brief 	    aggregate the profiles of the works of an author
+ * \note 	    the works are merged at once by a loser tree, then the profile is written in
+ *              the folder of the author. In the event of an error, it writes to stderr the
+ *              communicating thread and error details.
+ * \param[in] 	author: author
+ * \return 		0: any error.
+ *              1: error encountered.
+ */
+int
+aggregate(const author_t* author)
+{
+	char path[FILENAME_MAX] = {'\0'};
+	profile_t* profiles = calloc(author->count ? author->count : 1, sizeof (profile_t));
+	merged_t merged = {NULL, NULL, 0, 0, 0};
+	bool written = true;
+	int output = PROFILE_OK;
+
+	if (profiles == NULL) {
+		output = PROFILE_OUT_OF_MEMORY;
+	}
+
+	/* read the works */
+	for (int32_t i = 0; output == PROFILE_OK && i < author->count; ++i) {
+		strcpy(path, source_directory);
+		strcat(path, "/");
+		strcat(path, names[author->works[i]]);
+		strcat(path, BIN_FORMAT);
+		output = profile_read(&profiles[i], path);
+		if (output == PROFILE_OK && profiles[i].gram_size != profiles[0].gram_size) {
+			output = PROFILE_FORMAT_ERROR;
+		}
+	}
+
+	/* merge and write */
+	if (output == PROFILE_OK) {
+		output = merge_profiles(profiles, author->count, &merged) ? PROFILE_OUT_OF_MEMORY : PROFILE_OK;
+	}
+	for (int32_t i = 0; profiles != NULL && i < author->count; ++i)
+		profile_free(&profiles[i]);
+	free(profiles);
+	if (output == PROFILE_OK) {
+		strcpy(path, destination_directory);
+		strcat(path, "/");
+		strcat(path, author->name);
+		strcat(path, "/");
+		strcat(path, ORDER_GRAMS);
+		switch (write_profile(&merged, path)) {
+			case 1: output = PROFILE_OUT_OF_MEMORY; break;
+			case 2: output = PROFILE_NOT_FOUND; written = false; break;
+		}
+	}
+	merge_free(&merged);
+
+	if (output != PROFILE_OK) {
+		pthread_mutex_lock(&error_mutex);
+		{
+			fflush(stderr);
+			if (!written) {
+				fprintf(stderr, "\t> %lu: write error: output %s\n", (unsigned long)pthread_self(), path);
+			} else if (output == PROFILE_NOT_FOUND) {
+				fprintf(stderr, "\t> %lu: file not found: input %s\n", (unsigned long)pthread_self(), path);
+			} else if (output == PROFILE_FORMAT_ERROR) {
+				fprintf(stderr, "\t> %lu: synthesis format error: input %s\n", (unsigned long)pthread_self(), path);
+			} else {
+				fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+			}
+		}
+		pthread_mutex_unlock(&error_mutex);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * \brief 	    activation function of the threads
+ * \param[in] 	addr: unused
+ * \return 		'NULL'
+ */
+void*
+activation(void* addr)
+{
+	while (flag) {
+		int32_t index = atomic_fetch_add(&next, 1);
+
+		if (index >= num_of_authors) {
+			break;
+		}
+
+		#if PROGRESS == 1
+		{
+			float prog = 100.*(float)(index+1)/num_of_authors;
+			printf("\033[A\tprogress: %.2f%%\n", prog);
+			fflush(stdout);
+		}
+		#endif /* PROGRESS == 1*/
+
+		if (aggregate(&authors[index])) {
+			flag = false;
+			break;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief 	    read the works of the input file and group them by author
+ * \note 	    the author of a work is its folder.
+ * \param[in] 	fp: input file
+ * \return 		0: any error.
+ *              1: error encountered.
+ */
+int
+read_input(FILE* fp)
+{
+	if (fscanf(fp, "%d ", &count) != 1 || count < 0) {
+		return 1;
+	}
+	names = calloc(count ? count : 1, sizeof (char*));
+	authors = calloc(count ? count : 1, sizeof (author_t));
+	if (names == NULL || authors == NULL) {
+		return 1;
+	}
+	for (int32_t i = 0; i < count; ++i) {
+		char* slash;
+		size_t length;
+		int32_t a = 0;
+
+		names[i] = calloc(FILENAME_MAX, sizeof (char));
+		if (names[i] == NULL || fscanf(fp, "%[^.]%s ", names[i], buffer) != 2) {
+			return 1;
+		}
+		slash = strrchr(names[i], '/');
+		length = slash != NULL ? (size_t)(slash - names[i]) : 0;
+		while (a < num_of_authors && (strlen(authors[a].name) != length || strncmp(authors[a].name, names[i], length) != 0))
+			++a;
+		if (a == num_of_authors) {
+			memcpy(authors[a].name, names[i], length);
+			authors[a].works = malloc(count * sizeof (int32_t));
+			if (authors[a].works == NULL) {
+				return 1;
+			}
+			++num_of_authors;
+		}
+		authors[a].works[authors[a].count++] = i;
+	}
+	return 0;
+}
+
+/**
+ * \brief 	    free the works and the authors
+ */
+void
+free_input(void)
+{
+	for (int32_t i = 0; names != NULL && i < count; ++i)
+		free(names[i]);
+	for (int32_t a = 0; authors != NULL && a < num_of_authors; ++a)
+		free(authors[a].works);
+	free(names);
+	free(authors);
+}
+
+
+/*******************/
+/*!< main function */
+/*******************/
+
+/**
+ * \brief 	    main
+ * \note 	    aggregate the syntheses of the works of each author in the file order_grams.bin
+ *              of the folder of the author, the authors in parallel.
+ *              The input file lists the training synthesis folder, the training analysis folder,
+ *              then the num of training works and their names as author/work.
+ *              The file order_grams.bin holds int32 gram size, int32 num of grams, the packed
+ *              grams and their uint64 recurrences, by increasing recurrence.
+ * \param[in] 	argc: is 2
+ * \param[in] 	argv[0]: current executable name
+ *              argv[1]: input_file name
+ * \return 		'EXIT_SUCCESS': any error
+ *              'EXIT_FAILURE': error encountered
+ */
+int
+main(int argc, char** argv)
+{
+	if(argc != 2) return EXIT_FAILURE;
+
+	/* init authors & flag */
+	{
+		FILE* fp = fopen(input_file, "r");
+
+		if (fp == NULL) {
+			fprintf(stderr, "\t> file not found: input %s\n", input_file);
+			return EXIT_FAILURE;
+		}
+		if (fscanf(fp, "%s ", source_directory) != 1 || fscanf(fp, "%s ", destination_directory) != 1 || read_input(fp)) {
+			fprintf(stderr, "\t> input format error\n");
+			fclose(fp);
+			free_input();
+			return EXIT_FAILURE;
+		}
+		fclose(fp);
+
+		num_of_threads = THREAD_COUNT > 0 ? THREAD_COUNT : pool_cpu_count();
+		if (num_of_threads > num_of_authors) {
+			num_of_threads = num_of_authors > 0 ? num_of_authors : 1;
+		}
+		threads = calloc(num_of_threads, sizeof (pthread_t));
+		if (threads == NULL) {
+			fprintf(stderr, "\t> out of memory\n");
+			free_input();
+			return EXIT_FAILURE;
+		}
+		pthread_mutex_init(&error_mutex, NULL);
+		flag = true;
+
+		#if PROGRESS == 1
+			printf("<Subprocess>\n");
+			printf("\tauthor: %d processes, %d authors, %d works\n\n", num_of_threads, num_of_authors, count);
+		#endif /* PROGRESS == 1 */
+	}
+
+	/* aggregate the authors */
+	atomic_init(&next, 0);
+	for (int32_t i = 0; i < num_of_threads; ++i)
+		pthread_create(&threads[i], NULL, activation, NULL);
+	for (int32_t i = 0; i < num_of_threads; ++i)
+		pthread_join(threads[i], NULL);
+
+	free(threads);
+	free_input();
+	pthread_mutex_destroy(&error_mutex);
+
+	return flag ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,4 +1,401 @@
-int main()
+/**
+ * \file 		main.c
+ * \brief 		Define the main function
+ */
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "../config.h"
+#include "../synthesis/profile.h"
+#include "../synthesis/pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define input_file (argv[1]) /* input_file */
+#define BIN_FORMAT (".bin") /* synthesis format */
+#define BLOCK_SIZE 32 /* side of a block of the similarity matrices */
+#define NUM_OF_METRICS 3 /* cosine, histogram intersection, Jensen-Shannon distance */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		set_t
+ * \note		This structure is used to implement a set of syntheses.
+*/
+typedef struct
 {
+	char 	        directory[FILENAME_MAX]; 	/*!< directory of the synthesis folder */
+	char** 	        names; 	                    /*!< list of works respect the folder */
+	profile_t* 	    profiles; 	                /*!< profile of each work */
+	double* 	    norms; 	                    /*!< euclidean norm of the recurrences of each work */
+	int32_t 	    count; 	                    /*!< num of works */
+} set_t;
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+set_t 	            test_set; 	                /*!< works to attribute */
+set_t 	            training_set; 	            /*!< works of the authors */
+char 	            result_file[FILENAME_MAX]; 	/*!< file of the similarity matrices */
+float* 	            matrices; 	                /*!< NUM_OF_METRICS matrices test x training */
+atomic_int 	        next; 	                    /*!< next job of the threads */
+int32_t 	        num_of_blocks; 	            /*!< num of blocks of a matrix */
+int32_t 	        blocks_per_row; 	        /*!< num of blocks of a row of blocks */
+pthread_t* 	        threads; 	                /*!< vector of threads */
+int32_t 	        num_of_threads; 	        /*!< num of threads */
+pthread_mutex_t 	error_mutex; 	            /*!< mutex used to coordinate error reporting.  */
+uint8_t 	        flag; 	                    /*!< if flag is 0 the threads stop */
+char 	            buffer[8]; 	                /*!< buffer used to save the format images */
+
+void 	similarity(const profile_t*, double, const profile_t*, double, float*);
+int 	load(set_t*, int32_t);
+void* 	load_activation(void*);
+void* 	compare_activation(void*);
+int 	read_set(FILE*, set_t*);
+void 	free_set(set_t*);
+int 	main(int, char**);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    similarities between two profiles
+ * \note 	    a single merge-join of the sorted grams computes all metrics. The
+ *              recurrences are normalized to frequencies for the intersection and the
+ *              Jensen-Shannon distance, which is in [0, 1] with base 2 logarithms.
+ * \param[in] 	a: first profile
+ * \param[in] 	norm_a: euclidean norm of the recurrences of a
+ * \param[in] 	b: second profile
+ * \param[in] 	norm_b: euclidean norm of the recurrences of b
+ * \param[out] 	metrics: cosine similarity, histogram intersection, Jensen-Shannon distance
+ */
+void
+similarity(const profile_t* a, double norm_a, const profile_t* b, double norm_b, float* metrics)
+{
+	double dot = 0, intersection = 0, divergence = 0;
+	double scale_a = a->total ? 1./a->total : 0, scale_b = b->total ? 1./b->total : 0;
+	size_t i = 0, j = 0;
+
+	while (i < a->size && j < b->size) {
+		if (a->codes[i] == b->codes[j]) {
+			double p = a->counts[i]*scale_a, q = b->counts[j]*scale_b, m = p + q;
+
+			dot += (double)a->counts[i]*b->counts[j];
+			intersection += p < q ? p : q;
+			divergence += p*log2(2*p/m) + q*log2(2*q/m);
+			++i;
+			++j;
+		} else if (a->codes[i] < b->codes[j]) {
+			divergence += a->counts[i++]*scale_a;  // p*log2(2p/p)
+		} else {
+			divergence += b->counts[j++]*scale_b;
+		}
+	}
+	for (; i < a->size; ++i)
+		divergence += a->counts[i]*scale_a;
+	for (; j < b->size; ++j)
+		divergence += b->counts[j]*scale_b;
+
+	metrics[0] = norm_a > 0 && norm_b > 0 ? (float)(dot/(norm_a*norm_b)) : 0;
+	metrics[1] = (float)intersection;
+	metrics[2] = (float)sqrt(divergence > 0 ? divergence/2 : 0);
+}
+
+/**
+ * \brief 	    read the profile of a work
+ * \note 	    In the event of an error, it writes to stderr the communicating thread and error details.
+ * \param[in] 	set: set of the work
+ * \param[in] 	index: index of the work
+ * \return 		0: any error.
+ *              1: error encountered.
+ */
+int
+load(set_t* set, int32_t index)
+{
+	char source_dir[FILENAME_MAX] = {'\0'};
+	profile_t* profile = &set->profiles[index];
+	double norm = 0;
+	int output;
+
+	strcpy(source_dir, set->directory);
+	strcat(source_dir, "/");
+	strcat(source_dir, set->names[index]);
+	strcat(source_dir, BIN_FORMAT);
+	output = profile_read(profile, source_dir);
+	if (output != PROFILE_OK) {
+		pthread_mutex_lock(&error_mutex);
+		{
+			fflush(stderr);
+			if (output == PROFILE_NOT_FOUND) {
+				fprintf(stderr, "\t> %lu: file not found: input %s\n", (unsigned long)pthread_self(), source_dir);
+			} else if (output == PROFILE_FORMAT_ERROR) {
+				fprintf(stderr, "\t> %lu: synthesis format error: input %s\n", (unsigned long)pthread_self(), source_dir);
+			} else {
+				fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+			}
+		}
+		pthread_mutex_unlock(&error_mutex);
+		return 1;
+	}
+	for (size_t i = 0; i < profile->size; ++i)
+		norm += (double)profile->counts[i]*profile->counts[i];
+	set->norms[index] = sqrt(norm);
+	return 0;
+}
+
+/**
+ * \brief 	    activation function of the threads reading the profiles
+ * \note 	    the jobs are the test works followed by the training works.
+ * \param[in] 	addr: unused
+ * \return 		'NULL'
+ */
+void*
+load_activation(void* addr)
+{
+	while (flag) {
+		int32_t index = atomic_fetch_add(&next, 1);
+
+		if (index >= test_set.count + training_set.count) {
+			break;
+		}
+		if (index < test_set.count ? load(&test_set, index) : load(&training_set, index - test_set.count)) {
+			flag = false;
+			break;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief 	    activation function of the threads comparing the profiles
+ * \note 	    the matrices are split in blocks of BLOCK_SIZE x BLOCK_SIZE pairs, so a
+ *              block reads only 2*BLOCK_SIZE profiles while it computes their pairs.
+ * \param[in] 	addr: unused
+ * \return 		'NULL'
+ */
+void*
+compare_activation(void* addr)
+{
+	size_t num_of_pairs = (size_t)test_set.count * (size_t)training_set.count;
+
+	while (flag) {
+		int32_t block = atomic_fetch_add(&next, 1);
+		int32_t first_row, first_col, last_row, last_col;
+
+		if (block >= num_of_blocks) {
+			break;
+		}
+
+		#if PROGRESS == 1
+		{
+			float prog = 100.*(float)(block+1)/num_of_blocks;
+			printf("\033[A\tprogress: %.2f%%\n", prog);
+			fflush(stdout);
+		}
+		#endif /* PROGRESS == 1*/
+
+		first_row = (block / blocks_per_row) * BLOCK_SIZE;
+		first_col = (block % blocks_per_row) * BLOCK_SIZE;
+		last_row = first_row + BLOCK_SIZE < test_set.count ? first_row + BLOCK_SIZE : test_set.count;
+		last_col = first_col + BLOCK_SIZE < training_set.count ? first_col + BLOCK_SIZE : training_set.count;
+		for (int32_t i = first_row; i < last_row; ++i) {
+			for (int32_t j = first_col; j < last_col; ++j) {
+				size_t pair = (size_t)i*training_set.count + j;
+				float metrics[NUM_OF_METRICS];
+
+				similarity(&test_set.profiles[i], test_set.norms[i], &training_set.profiles[j], training_set.norms[j], metrics);
+				for (int32_t m = 0; m < NUM_OF_METRICS; ++m)
+					matrices[m*num_of_pairs + pair] = metrics[m];
+			}
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief 	    read a set of the input file
+ * \param[in] 	fp: input file
+ * \param[out] 	set: set of syntheses
+ * \return 		0: any error.
+ *              1: error encountered.
+ */
+int
+read_set(FILE* fp, set_t* set)
+{
+	if (fscanf(fp, "%d ", &set->count) != 1 || set->count < 0) {
+		return 1;
+	}
+	set->names = calloc(set->count ? set->count : 1, sizeof (char*));
+	set->profiles = calloc(set->count ? set->count : 1, sizeof (profile_t));
+	set->norms = calloc(set->count ? set->count : 1, sizeof (double));
+	if (set->names == NULL || set->profiles == NULL || set->norms == NULL) {
+		return 1;
+	}
+	for (int32_t i = 0; i < set->count; ++i) {
+		set->names[i] = calloc(FILENAME_MAX, sizeof (char));
+		if (set->names[i] == NULL || fscanf(fp, "%[^.]%s ", set->names[i], buffer) != 2) {
+			return 1;
+		}
+	}
 	return 0;
 }
+
+/**
+ * \brief 	    free a set of syntheses
+ * \param[in] 	set: set of syntheses
+ */
+void
+free_set(set_t* set)
+{
+	for (int32_t i = 0; i < set->count; ++i) {
+		if (set->names != NULL) {
+			free(set->names[i]);
+		}
+		if (set->profiles != NULL) {
+			profile_free(&set->profiles[i]);
+		}
+	}
+	free(set->names);
+	free(set->profiles);
+	free(set->norms);
+}
+
+
+/*******************/
+/*!< main function */
+/*******************/
+
+/**
+ * \brief 	    main
+ * \note 	    read the syntheses of the test and training works, compare each test work
+ *              with each training work and write the similarity matrices.
+ *              The input file lists the test synthesis folder, the training synthesis
+ *              folder, the result file, then the num of test works and their names,
+ *              and the num of training works and their names.
+ *              The result file holds int32 num of test works, int32 num of training works,
+ *              int32 num of metrics, then a float matrix test x training for each metric:
+ *              cosine similarity, histogram intersection, Jensen-Shannon distance.
+ * \param[in] 	argc: is 2
+ * \param[in] 	argv[0]: current executable name
+ *              argv[1]: input_file name
+ * \return 		'EXIT_SUCCESS': any error
+ *              'EXIT_FAILURE': error encountered
+ */
+int
+main(int argc, char** argv)
+{
+	if(argc != 2) return EXIT_FAILURE;
+
+	/* init sets & flag */
+	{
+		FILE* fp = fopen(input_file, "r");
+
+		if (fp == NULL) {
+			fprintf(stderr, "\t> file not found: input %s\n", input_file);
+			return EXIT_FAILURE;
+		}
+		if (fscanf(fp, "%s ", test_set.directory) != 1 || fscanf(fp, "%s ", training_set.directory) != 1 ||
+			fscanf(fp, "%s ", result_file) != 1 || read_set(fp, &test_set) || read_set(fp, &training_set)) {
+			fprintf(stderr, "\t> input format error\n");
+			fclose(fp);
+			free_set(&test_set);
+			free_set(&training_set);
+			return EXIT_FAILURE;
+		}
+		fclose(fp);
+
+		num_of_threads = THREAD_COUNT > 0 ? THREAD_COUNT : pool_cpu_count();
+		threads = calloc(num_of_threads, sizeof (pthread_t));
+		blocks_per_row = (training_set.count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		num_of_blocks = (test_set.count + BLOCK_SIZE - 1) / BLOCK_SIZE * blocks_per_row;
+		matrices = calloc(NUM_OF_METRICS * (size_t)test_set.count * (size_t)training_set.count + 1, sizeof (float));
+		if (threads == NULL || matrices == NULL) {
+			fprintf(stderr, "\t> out of memory\n");
+			return EXIT_FAILURE;
+		}
+		pthread_mutex_init(&error_mutex, NULL);
+		flag = true;
+
+		#if PROGRESS == 1
+			printf("<Subprocess>\n");
+			printf("\tcomparison: %d processes, %d test, %d training\n\n", num_of_threads, test_set.count, training_set.count);
+		#endif /* PROGRESS == 1 */
+	}
+
+	/* read the profiles */
+	atomic_init(&next, 0);
+	for (int32_t i = 0; i < num_of_threads; ++i)
+		pthread_create(&threads[i], NULL, load_activation, NULL);
+	for (int32_t i = 0; i < num_of_threads; ++i)
+		pthread_join(threads[i], NULL);
+
+	/* the grams must have the same size */
+	for (int32_t i = 0; flag && i < test_set.count + training_set.count; ++i) {
+		const profile_t* profile = i < test_set.count ? &test_set.profiles[i] : &training_set.profiles[i - test_set.count];
+		const profile_t* first = test_set.count ? &test_set.profiles[0] : &training_set.profiles[0];
+
+		if (profile->gram_size != first->gram_size) {
+			fprintf(stderr, "\t> syntheses with different gram sizes\n");
+			flag = false;
+		}
+	}
+
+	/* compare the profiles by blocks */
+	if (flag) {
+		atomic_init(&next, 0);
+		for (int32_t i = 0; i < num_of_threads; ++i)
+			pthread_create(&threads[i], NULL, compare_activation, NULL);
+		for (int32_t i = 0; i < num_of_threads; ++i)
+			pthread_join(threads[i], NULL);
+	}
+
+	/* write the similarity matrices */
+	if (flag) {
+		FILE* fp = fopen(result_file, "wb");
+		int32_t header[3] = {test_set.count, training_set.count, NUM_OF_METRICS};
+
+		if (fp == NULL) {
+			fprintf(stderr, "\t> file not found: input %s\n", result_file);
+			flag = false;
+		} else {
+			size_t num_of_values = NUM_OF_METRICS * (size_t)test_set.count * (size_t)training_set.count;
+			bool written = fwrite(header, sizeof (int32_t), 3, fp) == 3 &&
+				fwrite(matrices, sizeof (float), num_of_values, fp) == num_of_values;
+
+			if (fclose(fp) != 0 || !written) {
+				fprintf(stderr, "\t> write error: output %s\n", result_file);
+				flag = false;
+			}
+		}
+	}
+
+	free(matrices);
+	free(threads);
+	free_set(&test_set);
+	free_set(&training_set);
+	pthread_mutex_destroy(&error_mutex);
+
+	return flag ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -5,17 +5,29 @@
 
 #define PROGRESS 1  /* See the progress of C programs */
 
-#define MODEL 0  /* Set the model */
+#define MODEL 0  /* Set the default model, 'model=' at runtime */
 
 #if MODEL == 0  /* BW standard model */
-    #define BW_GRAM_SIZE 6
+    #define BW_GRAM_SIZE 6  /* default size of the grams, 'gram_size=' at runtime */
 #elif MODEL == 1  /* Multilayer model */
-	#define N_LAYERS 2
+	#define N_LAYERS 2  /* default num of layers, 2 to 16, 'layers=' at runtime */
 	#define BW_GRAM_SIZE 8
 #elif MODEL == 2  /* Opinion model */
-    #define INTERACTION_AREA 5
-    #define CONFIDENCE 0.5
+    #define INTERACTION_AREA 5  /* default odd side of the interaction area, 'area=' at runtime */
+    #define CONFIDENCE 0.5  /* default confidence, 0 to 1, 'confidence=' at runtime */
     #define GRAM_SIZE 4
 #endif
 
-#define THREAD_COUNT 6  /* Set num of threads*/
+#define ENGINE 1  /* Set the default engine counting the grams: 0 comparison sort, 1 radix sort, 2 hash table, 3 streamed hash table */
+
+#define THREAD_COUNT 0  /* Set the default num of threads, 0 uses the num of online CPUs, 'threads=' at runtime */
+
+#define PARALLEL_PIXELS 16000000  /* Images with at least these pixels are synthesized by bands, one for each thread */
+
+#define MEMORY_BUDGET 0  /* Set max MiB used at once by the synthesis of the images, 0 uses the available RAM */
+
+#define PIPELINE_DEPTH 2  /* Images read ahead of the synthesis and synthesis files queued to be closed, 0 does the I/O in the workers */
+
+#define READER_COUNT 1  /* Set the num of threads reading the images ahead */
+
+#define WRITER_COUNT 1  /* Set the num of threads closing the synthesis files */
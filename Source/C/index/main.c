@@ -0,0 +1,746 @@
+/**
+ * \file 		main.c
+ * \brief 		Define the main function
+ */
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#define _POSIX_C_SOURCE 200809L  // mmap
+#include "../config.h"
+#include "../synthesis/profile.h"
+#include "../synthesis/pool.h"
+#include "../synthesis/radix.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define mode (argv[1]) /* build or query */
+#define input_file (argv[2]) /* input_file */
+#define BIN_FORMAT (".bin") /* synthesis format */
+#define INDEX_VERSION 1 /* version of the index file */
+#define INDEX_CHUNK 4096 /* num of postings written at once */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		header_t
+ * \note		Header of the index file. It is followed by the double norms of the works,
+ *              the double norms of the authors, the uint64 codes, the uint64 offsets of
+ *              their postings (num_of_codes + 1), the int32 author of each work, then the
+ *              uint32 works, authors and counts of the postings and the names of the works,
+ *              one per line. The postings of a code are sorted by work.
+*/
+typedef struct
+{
+	int32_t 	version; 	        /*!< INDEX_VERSION */
+	int32_t 	gram_size; 	        /*!< side of the grams */
+	int32_t 	num_of_works; 	    /*!< num of indexed works */
+	int32_t 	num_of_authors; 	/*!< num of authors */
+	uint64_t 	num_of_codes; 	    /*!< num of distinct grams */
+	uint64_t 	num_of_postings; 	/*!< num of (work, author, count) entries */
+} header_t;
+
+/**
+ * \brief 		index_t
+ * \note		Inverted index mapped in memory, so a query reads only the codes it
+ *              searches and the postings of the codes it finds.
+*/
+typedef struct
+{
+	void* 	        map; 	        /*!< mapping of the index file */
+	size_t 	        map_size; 	    /*!< bytes of the mapping */
+	header_t 	    header; 	    /*!< header of the index */
+	const double* 	work_norms; 	/*!< euclidean norm of the recurrences of each work */
+	const double* 	author_norms; 	/*!< euclidean norm of the recurrences of each author */
+	const uint64_t* codes; 	        /*!< distinct packed grams, ascending */
+	const uint64_t* offsets; 	    /*!< first posting of each code */
+	const int32_t* 	work_authors; 	/*!< author of each work */
+	const uint32_t* works; 	        /*!< work of each posting */
+	const uint32_t* authors; 	    /*!< author of each posting */
+	const uint32_t* counts; 	    /*!< recurrences of each posting */
+} index_t;
+
+/**
+ * \brief 		set_t
+ * \note		This structure is used to implement a set of syntheses.
+*/
+typedef struct
+{
+	char 	        directory[FILENAME_MAX]; 	/*!< directory of the synthesis folder */
+	char** 	        names; 	                    /*!< list of works respect the folder */
+	profile_t* 	    profiles; 	                /*!< profile of each work */
+	double* 	    norms; 	                    /*!< euclidean norm of the recurrences of each work */
+	int32_t 	    count; 	                    /*!< num of works */
+} set_t;
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+set_t 	            set; 	                    /*!< works to index or to query */
+index_t 	        main_index; 	            /*!< index of the query */
+char 	            index_file[FILENAME_MAX]; 	/*!< file of the index */
+char 	            result_file[FILENAME_MAX]; 	/*!< file of the scores of the query */
+float* 	            scores; 	                /*!< scores test x works, then test x authors */
+atomic_int 	        next; 	                    /*!< next job of the threads */
+pthread_t* 	        threads; 	                /*!< vector of threads */
+int32_t 	        num_of_threads; 	        /*!< num of threads */
+pthread_mutex_t 	error_mutex; 	            /*!< mutex used to coordinate error reporting.  */
+uint8_t 	        flag; 	                    /*!< if flag is 0 the threads stop */
+char 	            buffer[8]; 	                /*!< buffer used to save the format images */
+
+int 	load(int32_t);
+void* 	load_activation(void*);
+int 	build(void);
+int 	map_index(index_t*, const char*);
+size_t 	search(const uint64_t*, size_t, size_t, uint64_t);
+int 	query(int32_t, double*, double*);
+void* 	query_activation(void*);
+int 	read_set(FILE*, set_t*);
+void 	free_set(set_t*);
+int 	main(int, char**);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    read the profile of a work
+ * \note 	    In the event of an error, it writes to stderr the communicating thread and error details.
+ * \param[in] 	index: index of the work
+ * \return 		0: any error.
+ *              1: error encountered.
+ */
+int
+load(int32_t index)
+{
+	char source_dir[FILENAME_MAX] = {'\0'};
+	profile_t* profile = &set.profiles[index];
+	double norm = 0;
+	int output;
+
+	strcpy(source_dir, set.directory);
+	strcat(source_dir, "/");
+	strcat(source_dir, set.names[index]);
+	strcat(source_dir, BIN_FORMAT);
+	output = profile_read(profile, source_dir);
+	if (output != PROFILE_OK) {
+		pthread_mutex_lock(&error_mutex);
+		{
+			fflush(stderr);
+			if (output == PROFILE_NOT_FOUND) {
+				fprintf(stderr, "\t> %lu: file not found: input %s\n", (unsigned long)pthread_self(), source_dir);
+			} else if (output == PROFILE_FORMAT_ERROR) {
+				fprintf(stderr, "\t> %lu: synthesis format error: input %s\n", (unsigned long)pthread_self(), source_dir);
+			} else {
+				fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+			}
+		}
+		pthread_mutex_unlock(&error_mutex);
+		return 1;
+	}
+	for (size_t i = 0; i < profile->size; ++i)
+		norm += (double)profile->counts[i]*profile->counts[i];
+	set.norms[index] = sqrt(norm);
+	return 0;
+}
+
+/**
+ * \brief 	    activation function of the threads reading the profiles to index
+ * \param[in] 	addr: unused
+ * \return 		'NULL'
+ */
+void*
+load_activation(void* addr)
+{
+	while (flag) {
+		int32_t index = atomic_fetch_add(&next, 1);
+
+		if (index >= set.count) {
+			break;
+		}
+		if (load(index)) {
+			flag = false;
+			break;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief 	    build the inverted index of the set
+ * \note 	    the entries of all profiles are radix sorted by code, stably, so the
+ *              postings of a code stay sorted by work. The profiles are released
+ *              while their entries are gathered.
+ * \return 		0: any error.
+ *              1: error encountered.
+ */
+int
+build(void)
+{
+	header_t header = {INDEX_VERSION, set.count ? set.profiles[0].gram_size : 0, set.count, 0, 0, 0};
+	char (*authors)[FILENAME_MAX] = calloc(set.count ? set.count : 1, sizeof (*authors));
+	int32_t* work_authors = calloc(set.count ? set.count : 1, sizeof (int32_t));
+	uint64_t *keys = NULL, *offsets = NULL, *sums = NULL;
+	size_t* entries = NULL;
+	uint32_t *entry_works = NULL, *entry_counts = NULL, *touched = NULL;
+	double* author_norms = NULL;
+	FILE* fp = NULL;
+	bool written;
+	int output = 1;
+
+	if (authors == NULL || work_authors == NULL) {
+		fprintf(stderr, "\t> out of memory\n");
+		goto end;
+	}
+
+	/* the author of a work is its folder */
+	for (int32_t i = 0; i < set.count; ++i) {
+		char* slash = strrchr(set.names[i], '/');
+		size_t length = slash != NULL ? (size_t)(slash - set.names[i]) : 0;
+		int32_t a = 0;
+
+		while (a < header.num_of_authors && (strlen(authors[a]) != length || strncmp(authors[a], set.names[i], length) != 0))
+			++a;
+		if (a == header.num_of_authors) {
+			memcpy(authors[a], set.names[i], length);
+			++header.num_of_authors;
+		}
+		work_authors[i] = a;
+	}
+
+	/* gather the entries */
+	for (int32_t i = 0; i < set.count; ++i)
+		header.num_of_postings += set.profiles[i].size;
+	keys = malloc((header.num_of_postings + 1) * sizeof (uint64_t));
+	entries = malloc((header.num_of_postings + 1) * sizeof (size_t));
+	entry_works = malloc((header.num_of_postings + 1) * sizeof (uint32_t));
+	entry_counts = malloc((header.num_of_postings + 1) * sizeof (uint32_t));
+	author_norms = calloc(header.num_of_authors + 1, sizeof (double));
+	sums = calloc(header.num_of_authors + 1, sizeof (uint64_t));
+	touched = malloc((header.num_of_authors + 1) * sizeof (uint32_t));
+	if (keys == NULL || entries == NULL || entry_works == NULL || entry_counts == NULL ||
+		author_norms == NULL || sums == NULL || touched == NULL) {
+		fprintf(stderr, "\t> out of memory\n");
+		goto end;
+	}
+	{
+		size_t k = 0;
+
+		for (int32_t i = 0; i < set.count; ++i) {
+			profile_t* profile = &set.profiles[i];
+
+			memcpy(keys + k, profile->codes, profile->size * sizeof (uint64_t));
+			memcpy(entry_counts + k, profile->counts, profile->size * sizeof (uint32_t));
+			for (size_t j = 0; j < profile->size; ++j, ++k) {
+				entries[k] = k;
+				entry_works[k] = (uint32_t)i;
+			}
+			profile_free(profile);
+		}
+	}
+	if (radix_sort(keys, entries, header.num_of_postings, (uint32_t)(header.gram_size * header.gram_size), NULL, NULL)) {
+		fprintf(stderr, "\t> out of memory\n");
+		goto end;
+	}
+
+	/* distinct codes, their offsets and the norms of the authors */
+	for (size_t k = 0; k < header.num_of_postings; ++k)
+		header.num_of_codes += k == 0 || keys[k] != keys[k-1];
+	offsets = malloc((header.num_of_codes + 1) * sizeof (uint64_t));
+	if (offsets == NULL) {
+		fprintf(stderr, "\t> out of memory\n");
+		goto end;
+	}
+	{
+		size_t c = 0, first = 0;
+
+		for (size_t k = 0; k <= header.num_of_postings; ++k) {
+			if (k == header.num_of_postings || (k > 0 && keys[k] != keys[k-1])) {
+				uint32_t num_of_touched = 0;
+
+				for (size_t p = first; p < k; ++p) {
+					int32_t a = work_authors[entry_works[entries[p]]];
+
+					if (sums[a] == 0) {
+						touched[num_of_touched++] = a;
+					}
+					sums[a] += entry_counts[entries[p]];
+				}
+				for (uint32_t t = 0; t < num_of_touched; ++t) {
+					author_norms[touched[t]] += (double)sums[touched[t]]*sums[touched[t]];
+					sums[touched[t]] = 0;
+				}
+				if (k > first) {
+					keys[c] = keys[first];
+					offsets[c++] = first;
+				}
+				first = k;
+			}
+		}
+		offsets[c] = header.num_of_postings;
+		for (int32_t a = 0; a < header.num_of_authors; ++a)
+			author_norms[a] = sqrt(author_norms[a]);
+	}
+
+	/* write the index */
+	fp = fopen(index_file, "wb");
+	if (fp == NULL) {
+		fprintf(stderr, "\t> file not found: input %s\n", index_file);
+		goto end;
+	}
+	written = fwrite(&header, sizeof (header_t), 1, fp) == 1 &&
+		fwrite(set.norms, sizeof (double), set.count, fp) == (size_t)set.count &&
+		fwrite(author_norms, sizeof (double), header.num_of_authors, fp) == (size_t)header.num_of_authors &&
+		fwrite(keys, sizeof (uint64_t), header.num_of_codes, fp) == header.num_of_codes &&
+		fwrite(offsets, sizeof (uint64_t), header.num_of_codes + 1, fp) == header.num_of_codes + 1 &&
+		fwrite(work_authors, sizeof (int32_t), set.count, fp) == (size_t)set.count;
+	for (int field = 0; field < 3; ++field) {
+		uint32_t chunk[INDEX_CHUNK];
+
+		for (size_t k = 0; written && k < header.num_of_postings; k += INDEX_CHUNK) {
+			size_t len = header.num_of_postings - k < INDEX_CHUNK ? header.num_of_postings - k : INDEX_CHUNK;
+
+			for (size_t p = 0; p < len; ++p) {
+				size_t entry = entries[k + p];
+
+				chunk[p] = field == 0 ? entry_works[entry] :
+						   field == 1 ? (uint32_t)work_authors[entry_works[entry]] : entry_counts[entry];
+			}
+			written = fwrite(chunk, sizeof (uint32_t), len, fp) == len;
+		}
+	}
+	for (int32_t i = 0; written && i < set.count; ++i)
+		written = fprintf(fp, "%s\n", set.names[i]) >= 0;
+	if (fclose(fp) != 0 || !written) {
+		fprintf(stderr, "\t> write error: output %s\n", index_file);
+		goto end;
+	}
+
+	#if PROGRESS == 1
+		printf("\tindex: %d works, %d authors, %llu grams, %llu postings\n", header.num_of_works, header.num_of_authors,
+			(unsigned long long)header.num_of_codes, (unsigned long long)header.num_of_postings);
+	#endif /* PROGRESS == 1 */
+	output = 0;
+
+end:
+	free(authors);
+	free(work_authors);
+	free(keys);
+	free(entries);
+	free(entry_works);
+	free(entry_counts);
+	free(offsets);
+	free(author_norms);
+	free(sums);
+	free(touched);
+	return output;
+}
+
+/**
+ * \brief 	    map an index file in memory
+ * \param[out] 	index: index
+ * \param[in] 	path: index file
+ * \return 		0: any error.
+ *              1: error encountered.
+ */
+int
+map_index(index_t* index, const char* path)
+{
+	int fd = open(path, O_RDONLY);
+	struct stat info;
+	const header_t* header;
+	const uint8_t* cursor;
+	size_t need;
+
+	index->map = NULL;
+	if (fd < 0) {
+		fprintf(stderr, "\t> file not found: input %s\n", path);
+		return 1;
+	}
+	if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof (header_t)) {
+		fprintf(stderr, "\t> index format error: input %s\n", path);
+		close(fd);
+		return 1;
+	}
+	index->map_size = (size_t)info.st_size;
+	index->map = mmap(NULL, index->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (index->map == MAP_FAILED) {
+		index->map = NULL;
+		fprintf(stderr, "\t> out of memory\n");
+		return 1;
+	}
+
+	header = (const header_t*)index->map;
+	index->header = *header;
+	need = sizeof (header_t) + (size_t)header->num_of_works * (sizeof (double) + sizeof (int32_t)) +
+		   (size_t)header->num_of_authors * sizeof (double) + (header->num_of_codes * 2 + 1) * sizeof (uint64_t) +
+		   header->num_of_postings * 3 * sizeof (uint32_t);
+	if (header->version != INDEX_VERSION || header->num_of_works < 0 || header->num_of_authors < 0 || need > index->map_size) {
+		fprintf(stderr, "\t> index format error: input %s\n", path);
+		munmap(index->map, index->map_size);
+		index->map = NULL;
+		return 1;
+	}
+
+	cursor = (const uint8_t*)index->map + sizeof (header_t);
+	index->work_norms = (const double*)cursor;
+	cursor += header->num_of_works * sizeof (double);
+	index->author_norms = (const double*)cursor;
+	cursor += header->num_of_authors * sizeof (double);
+	index->codes = (const uint64_t*)cursor;
+	cursor += header->num_of_codes * sizeof (uint64_t);
+	index->offsets = (const uint64_t*)cursor;
+	cursor += (header->num_of_codes + 1) * sizeof (uint64_t);
+	index->work_authors = (const int32_t*)cursor;
+	cursor += header->num_of_works * sizeof (int32_t);
+	index->works = (const uint32_t*)cursor;
+	cursor += header->num_of_postings * sizeof (uint32_t);
+	index->authors = (const uint32_t*)cursor;
+	cursor += header->num_of_postings * sizeof (uint32_t);
+	index->counts = (const uint32_t*)cursor;
+	return 0;
+}
+
+/**
+ * \brief 	    search a code in the codes of the index
+ * \note 	    galloping search from the position of the previous code, since the codes
+ *              of a query are ascending: the cost grows with the distance skipped.
+ * \param[in] 	codes: codes of the index, ascending
+ * \param[in] 	first: first position to search
+ * \param[in] 	size: num of codes
+ * \param[in] 	code: code to search
+ * \return 		first position whose code is not less than code.
+ */
+size_t
+search(const uint64_t* codes, size_t first, size_t size, uint64_t code)
+{
+	size_t low = first, high = first, step = 1;
+
+	while (high < size && codes[high] < code) {
+		low = high + 1;
+		high += step;
+		step <<= 1;
+	}
+	if (high > size) {
+		high = size;
+	}
+	while (low < high) {
+		size_t middle = low + (high - low) / 2;
+
+		if (codes[middle] < code) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+/**
+ * \brief 	    score a test work against the works and the authors of the index
+ * \note 	    only the postings of the grams of the work are read, so the rare grams
+ *              cost little. In the event of an error, it writes to stderr the
+ *              communicating thread and error details.
+ * \param[in] 	index: index of the test work
+ * \param[in] 	work_dots: buffer of the dot products with the works
+ * \param[in] 	author_dots: buffer of the dot products with the authors
+ * \return 		0: any error.
+ *              1: error encountered.
+ */
+int
+query(int32_t index, double* work_dots, double* author_dots)
+{
+	const header_t* header = &main_index.header;
+	profile_t* profile = &set.profiles[index];
+	float* work_scores = scores + (size_t)index * header->num_of_works;
+	float* author_scores = scores + (size_t)set.count * header->num_of_works + (size_t)index * header->num_of_authors;
+	size_t position = 0;
+
+	if (load(index)) {
+		return 1;
+	}
+	if (profile->gram_size != header->gram_size) {
+		pthread_mutex_lock(&error_mutex);
+		{
+			fflush(stderr);
+			fprintf(stderr, "\t> %lu: gram size differs from the index: input %s\n", (unsigned long)pthread_self(), set.names[index]);
+		}
+		pthread_mutex_unlock(&error_mutex);
+		return 1;
+	}
+
+	memset(work_dots, 0, header->num_of_works * sizeof (double));
+	memset(author_dots, 0, header->num_of_authors * sizeof (double));
+	for (size_t i = 0; i < profile->size && position < header->num_of_codes; ++i) {
+		position = search(main_index.codes, position, header->num_of_codes, profile->codes[i]);
+		if (position < header->num_of_codes && main_index.codes[position] == profile->codes[i]) {
+			double count = profile->counts[i];
+
+			for (uint64_t p = main_index.offsets[position]; p < main_index.offsets[position + 1]; ++p) {
+				work_dots[main_index.works[p]] += count * main_index.counts[p];
+				author_dots[main_index.authors[p]] += count * main_index.counts[p];
+			}
+		}
+	}
+
+	for (int32_t w = 0; w < header->num_of_works; ++w) {
+		double norm = set.norms[index] * main_index.work_norms[w];
+		work_scores[w] = norm > 0 ? (float)(work_dots[w]/norm) : 0;
+	}
+	for (int32_t a = 0; a < header->num_of_authors; ++a) {
+		double norm = set.norms[index] * main_index.author_norms[a];
+		author_scores[a] = norm > 0 ? (float)(author_dots[a]/norm) : 0;
+	}
+	profile_free(profile);
+	return 0;
+}
+
+/**
+ * \brief 	    activation function of the threads querying the index
+ * \param[in] 	addr: unused
+ * \return 		'NULL'
+ */
+void*
+query_activation(void* addr)
+{
+	double* work_dots = malloc((main_index.header.num_of_works + 1) * sizeof (double));
+	double* author_dots = malloc((main_index.header.num_of_authors + 1) * sizeof (double));
+
+	if (work_dots == NULL || author_dots == NULL) {
+		pthread_mutex_lock(&error_mutex);
+		{
+			fflush(stderr);
+			fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+		}
+		pthread_mutex_unlock(&error_mutex);
+		flag = false;
+	}
+
+	while (flag) {
+		int32_t index = atomic_fetch_add(&next, 1);
+
+		if (index >= set.count) {
+			break;
+		}
+
+		#if PROGRESS == 1
+		{
+			float prog = 100.*(float)(index+1)/set.count;
+			printf("\033[A\tprogress: %.2f%%\n", prog);
+			fflush(stdout);
+		}
+		#endif /* PROGRESS == 1*/
+
+		if (query(index, work_dots, author_dots)) {
+			flag = false;
+			break;
+		}
+	}
+
+	free(work_dots);
+	free(author_dots);
+	return NULL;
+}
+
+/**
+ * \brief 	    read a set of the input file
+ * \param[in] 	fp: input file
+ * \param[out] 	set: set of syntheses
+ * \return 		0: any error.
+ *              1: error encountered.
+ */
+int
+read_set(FILE* fp, set_t* set)
+{
+	if (fscanf(fp, "%d ", &set->count) != 1 || set->count < 0) {
+		return 1;
+	}
+	set->names = calloc(set->count ? set->count : 1, sizeof (char*));
+	set->profiles = calloc(set->count ? set->count : 1, sizeof (profile_t));
+	set->norms = calloc(set->count ? set->count : 1, sizeof (double));
+	if (set->names == NULL || set->profiles == NULL || set->norms == NULL) {
+		return 1;
+	}
+	for (int32_t i = 0; i < set->count; ++i) {
+		set->names[i] = calloc(FILENAME_MAX, sizeof (char));
+		if (set->names[i] == NULL || fscanf(fp, "%[^.]%s ", set->names[i], buffer) != 2) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * \brief 	    free a set of syntheses
+ * \param[in] 	set: set of syntheses
+ */
+void
+free_set(set_t* set)
+{
+	for (int32_t i = 0; i < set->count; ++i) {
+		if (set->names != NULL) {
+			free(set->names[i]);
+		}
+		if (set->profiles != NULL) {
+			profile_free(&set->profiles[i]);
+		}
+	}
+	free(set->names);
+	free(set->profiles);
+	free(set->norms);
+}
+
+
+/*******************/
+/*!< main function */
+/*******************/
+
+/**
+ * \brief 	    main
+ * \note 	    build: the input file lists the training synthesis folder, the index file,
+ *              then the num of training works and their names as author/work. The index
+ *              maps each gram to the postings (work, author, count) of the works holding it.
+ *              query: the input file lists the test synthesis folder, the index file, the
+ *              result file, then the num of test works and their names. The result file holds
+ *              int32 num of test works, int32 num of indexed works, int32 num of authors, then
+ *              the float cosine similarities test x works and test x authors, where an author
+ *              is the sum of the recurrences of its works.
+ * \param[in] 	argc: is 3
+ * \param[in] 	argv[0]: current executable name
+ *              argv[1]: build or query
+ *              argv[2]: input_file name
+ * \return 		'EXIT_SUCCESS': any error
+ *              'EXIT_FAILURE': error encountered
+ */
+int
+main(int argc, char** argv)
+{
+	bool building;
+
+	if(argc != 3) return EXIT_FAILURE;
+	building = strcmp(mode, "build") == 0;
+	if (!building && strcmp(mode, "query") != 0) return EXIT_FAILURE;
+
+	/* init set & flag */
+	{
+		FILE* fp = fopen(input_file, "r");
+
+		if (fp == NULL) {
+			fprintf(stderr, "\t> file not found: input %s\n", input_file);
+			return EXIT_FAILURE;
+		}
+		if (fscanf(fp, "%s ", set.directory) != 1 || fscanf(fp, "%s ", index_file) != 1 ||
+			(!building && fscanf(fp, "%s ", result_file) != 1) || read_set(fp, &set)) {
+			fprintf(stderr, "\t> input format error\n");
+			fclose(fp);
+			free_set(&set);
+			return EXIT_FAILURE;
+		}
+		fclose(fp);
+
+		num_of_threads = THREAD_COUNT > 0 ? THREAD_COUNT : pool_cpu_count();
+		threads = calloc(num_of_threads, sizeof (pthread_t));
+		if (threads == NULL) {
+			fprintf(stderr, "\t> out of memory\n");
+			return EXIT_FAILURE;
+		}
+		pthread_mutex_init(&error_mutex, NULL);
+		flag = true;
+
+		#if PROGRESS == 1
+			printf("<Subprocess>\n");
+			printf("\tindex %s: %d processes, %d works\n\n", mode, num_of_threads, set.count);
+		#endif /* PROGRESS == 1 */
+	}
+
+	if (building) {
+		/* read the profiles */
+		atomic_init(&next, 0);
+		for (int32_t i = 0; i < num_of_threads; ++i)
+			pthread_create(&threads[i], NULL, load_activation, NULL);
+		for (int32_t i = 0; i < num_of_threads; ++i)
+			pthread_join(threads[i], NULL);
+
+		/* the grams must have the same size */
+		for (int32_t i = 1; flag && i < set.count; ++i) {
+			if (set.profiles[i].gram_size != set.profiles[0].gram_size) {
+				fprintf(stderr, "\t> syntheses with different gram sizes\n");
+				flag = false;
+			}
+		}
+
+		if (flag && build()) {
+			flag = false;
+		}
+	} else if (map_index(&main_index, index_file)) {
+		flag = false;
+	} else {
+		scores = calloc((size_t)set.count * (main_index.header.num_of_works + main_index.header.num_of_authors) + 1, sizeof (float));
+		if (scores == NULL) {
+			fprintf(stderr, "\t> out of memory\n");
+			flag = false;
+		}
+
+		/* query the index */
+		if (flag) {
+			atomic_init(&next, 0);
+			for (int32_t i = 0; i < num_of_threads; ++i)
+				pthread_create(&threads[i], NULL, query_activation, NULL);
+			for (int32_t i = 0; i < num_of_threads; ++i)
+				pthread_join(threads[i], NULL);
+		}
+
+		/* write the scores */
+		if (flag) {
+			FILE* fp = fopen(result_file, "wb");
+			int32_t header[3] = {set.count, main_index.header.num_of_works, main_index.header.num_of_authors};
+
+			if (fp == NULL) {
+				fprintf(stderr, "\t> file not found: input %s\n", result_file);
+				flag = false;
+			} else {
+				size_t num_of_scores = (size_t)set.count * (header[1] + header[2]);
+				bool written = fwrite(header, sizeof (int32_t), 3, fp) == 3 &&
+					fwrite(scores, sizeof (float), num_of_scores, fp) == num_of_scores;
+
+				if (fclose(fp) != 0 || !written) {
+					fprintf(stderr, "\t> write error: output %s\n", result_file);
+					flag = false;
+				}
+			}
+		}
+		munmap(main_index.map, main_index.map_size);
+	}
+
+	free(scores);
+	free(threads);
+	free_set(&set);
+	pthread_mutex_destroy(&error_mutex);
+
+	return flag ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,131 @@
+/**
+ * \file 		arena.c
+ * \brief 		define arena_alloc, arena_calloc, arena_size, arena_reset, arena_free
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of arena.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "arena.h"
+#include "trace.h"
+#include <string.h>
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    buffer of the arena
+ * \note 	    the content is not preserved when the buffer grows.
+ * \param[in] 	arena: arena of the worker
+ * \param[in] 	buffer: index of the buffer, ARENA_*
+ * \param[in] 	size: num of bytes
+ * \return 		reference to at least size bytes, NULL if out of memory.
+ */
+void*
+arena_alloc(arena_t* arena, int32_t buffer, size_t size)
+{
+	if (size == 0) {
+		size = 1;
+	}
+	if (size > arena->capacities[buffer]) {
+		free(arena->buffers[buffer]);
+		arena->buffers[buffer] = malloc(size);
+		TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+		arena->capacities[buffer] = arena->buffers[buffer] == NULL ? 0 : size;
+	}
+	return arena->buffers[buffer];
+}
+
+/**
+ * \brief 	    zeroed buffer of the arena
+ * \param[in] 	arena: arena of the worker
+ * \param[in] 	buffer: index of the buffer, ARENA_*
+ * \param[in] 	size: num of bytes
+ * \return 		reference to size zeroed bytes, NULL if out of memory.
+ */
+void*
+arena_calloc(arena_t* arena, int32_t buffer, size_t size)
+{
+	void* data = arena_alloc(arena, buffer, size);
+
+	if (data != NULL) {
+		memset(data, 0, size);
+	}
+	return data;
+}
+
+/**
+ * \brief 	    bytes held by the arena
+ * \param[in] 	arena: arena of the worker
+ * \return 		num of allocated bytes of the buffers and of the list.
+ */
+size_t
+arena_size(const arena_t* arena)
+{
+	size_t size = arena->list.capacity;
+
+	for (int32_t i = 0; i < ARENA_BUFFERS; ++i)
+		size += arena->capacities[i];
+	return size;
+}
+
+/**
+ * \brief 	    reset the arena for the next image
+ * \note 	    the buffers are kept, the list of grams is emptied.
+ * \param[in] 	arena: arena of the worker
+ */
+void
+arena_reset(arena_t* arena)
+{
+	arena->list.size = 0;
+}
+
+/**
+ * \brief 	    free the arena
+ * \param[in] 	arena: arena of the worker
+ */
+void
+arena_free(arena_t* arena)
+{
+	for (int32_t i = 0; i < ARENA_BUFFERS; ++i) {
+		free(arena->buffers[i]);
+		arena->buffers[i] = NULL;
+		arena->capacities[i] = 0;
+	}
+	darr_free(arena->list);
+	arena->list = empty_vec;
+}
@@ -0,0 +1,98 @@
+/**
+ * \file            arena.h
+ * \brief           Buffers of a worker reused across the images
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of arena.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "darr.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define ARENA_BITBOARD 0 /* words of the bitboard */
+#define ARENA_INDEX 1 /* index matrix */
+#define ARENA_CODES 2 /* packed grams */
+#define ARENA_RECURRENCE 3 /* recurrences of the grams */
+#define ARENA_MAP 4 /* recurrence map */
+#define ARENA_KEYS 5 /* distinct packed grams */
+#define ARENA_SLOTS 6 /* slots of the distinct packed grams */
+#define ARENA_ROW 7 /* a row of the output */
+#define ARENA_TABLE 8 /* slots of the hash table */
+#define ARENA_REHASH 9 /* slots of the hash table while it grows, then swapped with ARENA_TABLE */
+#define ARENA_SORT_KEYS 10 /* keys of a radix pass */
+#define ARENA_SORT_VALUES 11 /* values of a radix pass */
+#define ARENA_BUFFERS 12 /* num of buffers */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		arena_t
+ * \note		Grow-only buffers of a worker: a buffer is reallocated only when an
+ *              image needs more bytes than all the previous ones, so the pages
+ *              are faulted once for each worker instead of once for each image.
+*/
+typedef struct
+{
+	void* 	buffers[ARENA_BUFFERS]; 	/*!< reference to data */
+	size_t 	capacities[ARENA_BUFFERS]; 	/*!< num of allocated bytes */
+	darr_t 	list; 						/*!< list of the grams */
+} arena_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+void* 	arena_alloc(arena_t*, int32_t, size_t);
+void* 	arena_calloc(arena_t*, int32_t, size_t);
+size_t 	arena_size(const arena_t*);
+void 	arena_reset(arena_t*);
+void 	arena_free(arena_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,265 @@
+/**
+ * \file 		band.c
+ * \brief 		define band_count, band_map
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of band.
+ *
+ * Author: 		Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "band.h"
+#include "gram.h"
+#include "trace.h"
+#include <pthread.h>
+
+
+/***********************/
+/*!< types definitions */
+/***********************/
+
+/**
+ * \brief 		band_t
+ * \note		A band of rows of grams, processed by a thread.
+ *              It reads kernel->size-1 rows of pixels of the next band.
+*/
+typedef struct
+{
+	const gram_kernel_t* 	kernel; 	/*!< kernel of the grams */
+	bitboard_t 		board; 		/*!< view of the rows of pixels of the band */
+	int32_t 		first_row; 	/*!< first row of grams */
+	uint64_t* 		codes; 		/*!< packed grams of the image */
+	hash_t 			table; 		/*!< partial recurrences */
+	const hash_t* 	merged; 	/*!< recurrences of the image */
+	float* 			map; 		/*!< recurrence map */
+	int 			error; 		/*!< 1 if the thread is out of memory */
+} band_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	band_split(const gram_kernel_t*, const bitboard_t*, band_t*, int32_t);
+void* 	band_count_activation(void*);
+void* 	band_map_activation(void*);
+int 	band_run(band_t*, int32_t, void* (*)(void*));
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    split the rows of grams in bands
+ * \param[in] 	kernel: kernel of the grams
+ * \param[in] 	board: bitboard
+ * \param[out] 	bands: num_of_bands bands
+ * \param[in] 	num_of_bands: num of bands
+ * \return 		num of non-empty bands.
+ */
+int
+band_split(const gram_kernel_t* kernel, const bitboard_t* board, band_t* bands, int32_t num_of_bands)
+{
+	int32_t num_of_rows = board->height - kernel->size + 1, first_row = 0, count = 0;
+
+	if (gram_count(kernel, board->width, board->height) == 0) {
+		return 0;
+	}
+	for (int32_t i = 0; i < num_of_bands; ++i) {
+		int32_t rows = num_of_rows / num_of_bands + (i < num_of_rows % num_of_bands);
+
+		if (rows == 0) {
+			continue;
+		}
+		bands[count].kernel = kernel;
+		bands[count].board = *board;
+		bands[count].board.words = BITBOARD_ROW(board, first_row);
+		bands[count].board.height = rows + kernel->size - 1;
+		bands[count].first_row = first_row;
+		bands[count].error = 0;
+		first_row += rows;
+		++count;
+	}
+	return count;
+}
+
+/**
+ * \brief 	    activation function of a band counting its grams
+ * \param[in] 	addr: reference to band_t
+ * \return 		'NULL'
+ */
+void*
+band_count_activation(void* addr)
+{
+	band_t* band = addr;
+	size_t num_of_cols = (size_t)(band->board.width - band->kernel->size + 1);
+	uint64_t* curr_code = band->codes + (size_t)band->first_row*num_of_cols;
+
+	TRACE_BEGIN("band count", NULL);
+	if (hash_alloc(&band->table, 0, NULL)) {
+		band->error = 1;
+		TRACE_END("band count");
+		return NULL;
+	}
+	gram_encode(band->kernel, &band->board, curr_code, NULL);
+	for (int32_t raw = band->first_row; raw + band->kernel->size <= band->first_row + band->board.height; ++raw)
+		for (size_t col = 0; col < num_of_cols; ++col)
+			if (hash_insert(&band->table, *(curr_code++), (size_t)raw*band->board.width + col)) {
+				band->error = 1;
+				TRACE_END("band count");
+				return NULL;
+			}
+	TRACE_END("band count");
+	return NULL;
+}
+
+/**
+ * \brief 	    activation function of a band filling its recurrence map
+ * \param[in] 	addr: reference to band_t
+ * \return 		'NULL'
+ */
+void*
+band_map_activation(void* addr)
+{
+	band_t* band = addr;
+	size_t num_of_cols = (size_t)(band->board.width - band->kernel->size + 1);
+	const uint64_t* curr_code = band->codes + (size_t)band->first_row*num_of_cols;
+
+	TRACE_BEGIN("band map", NULL);
+	for (int32_t raw = band->first_row; raw + band->kernel->size <= band->first_row + band->board.height; ++raw)
+		for (size_t col = 0; col < num_of_cols; ++col)
+			band->map[(size_t)raw*band->board.width + col] = 1./hash_find(band->merged, *(curr_code++));
+	TRACE_END("band map");
+	return NULL;
+}
+
+/**
+ * \brief 	    run a function on each band, a thread per band
+ * \note 	    the last band is processed by the calling thread.
+ * \param[in] 	bands: bands
+ * \param[in] 	num_of_bands: num of bands
+ * \param[in] 	activation: function of the threads
+ * \return 		0: any error.
+ *              1: a thread could not start.
+ */
+int
+band_run(band_t* bands, int32_t num_of_bands, void* (*activation)(void*))
+{
+	pthread_t threads[num_of_bands > 0 ? num_of_bands : 1];
+	int32_t started = 0, error = 0;
+
+	for (; started < num_of_bands - 1; ++started)
+		if (pthread_create(&threads[started], NULL, activation, &bands[started])) {
+			error = 1;
+			break;
+		}
+	if (num_of_bands > 0 && !error) {
+		activation(&bands[num_of_bands - 1]);
+	}
+	for (int32_t i = 0; i < started; ++i)
+		pthread_join(threads[i], NULL);
+	return error;
+}
+
+/**
+ * \brief 	    count the grams of an image, a thread per band of rows
+ * \note 	    each band counts its grams in its own hash table, then the
+ *              tables are merged. Grams are listed as gram_encode does.
+ * \param[in] 	kernel: kernel of the grams
+ * \param[in] 	board: bitboard
+ * \param[out] 	codes: gram_count(kernel, width, height) packed grams
+ * \param[out] 	table: allocated hash table receiving the recurrences
+ * \param[in] 	num_of_bands: num of threads
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+band_count(const gram_kernel_t* kernel, const bitboard_t* board, uint64_t* codes, hash_t* table, int32_t num_of_bands)
+{
+	band_t* bands = calloc(num_of_bands > 0 ? num_of_bands : 1, sizeof (band_t));
+	int32_t count;
+	int error = 0;
+
+	TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+	if (bands == NULL) {
+		return 1;
+	}
+	count = band_split(kernel, board, bands, num_of_bands);
+	for (int32_t i = 0; i < count; ++i)
+		bands[i].codes = codes;
+
+	error = band_run(bands, count, band_count_activation);
+	for (int32_t i = 0; i < count; ++i) {
+		error |= bands[i].error;
+		if (!error) {
+			error = hash_merge(table, &bands[i].table);
+		}
+		hash_free(&bands[i].table);
+	}
+	free(bands);
+	return error;
+}
+
+/**
+ * \brief 	    fill the recurrence map of an image, a thread per band of rows
+ * \param[in] 	kernel: kernel of the grams
+ * \param[in] 	board: bitboard
+ * \param[in] 	codes: packed grams listed by band_count
+ * \param[in] 	table: recurrences of the grams
+ * \param[out] 	map: recurrence map, a float per pixel
+ * \param[in] 	num_of_bands: num of threads
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+band_map(const gram_kernel_t* kernel, const bitboard_t* board, const uint64_t* codes, const hash_t* table, float* map, int32_t num_of_bands)
+{
+	band_t* bands = calloc(num_of_bands > 0 ? num_of_bands : 1, sizeof (band_t));
+	int32_t count;
+	int error;
+
+	TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+	if (bands == NULL) {
+		return 1;
+	}
+	count = band_split(kernel, board, bands, num_of_bands);
+	for (int32_t i = 0; i < count; ++i) {
+		bands[i].codes = (uint64_t*)codes;
+		bands[i].merged = table;
+		bands[i].map = map;
+	}
+	error = band_run(bands, count, band_map_activation);
+	free(bands);
+	return error;
+}
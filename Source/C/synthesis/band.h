@@ -0,0 +1,60 @@
+/**
+ * \file            band.h
+ * \brief           Synthesis of an image split in bands of rows
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of band.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+#ifndef BAND_H
+#define BAND_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "bitboard.h"
+#include "gram.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	band_count(const gram_kernel_t*, const bitboard_t*, uint64_t*, hash_t*, int32_t);
+int 	band_map(const gram_kernel_t*, const bitboard_t*, const uint64_t*, const hash_t*, float*, int32_t);
+
+
+#endif /* guard */
@@ -0,0 +1,250 @@
+/**
+ * \file 		bench.c
+ * \brief 		define bench_start, bench_stage, bench_end, bench_report
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of bench.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include "bench.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+
+/***********************/
+/*!< types definitions */
+/***********************/
+
+/**
+ * \brief 		bench_record_t
+ * \note		Stage timings of the synthesis of an image.
+*/
+typedef struct
+{
+	char* 		image; 					/*!< image file path respect its set */
+	size_t 		num_of_pixels; 			/*!< num of pixels */
+	double 		seconds[BENCH_STAGES]; 	/*!< seconds of each stage */
+} bench_record_t;
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+static const char* const 	bench_names[BENCH_STAGES] = {"read", "median", "binarize", "count", "map", "write"};
+static _Thread_local double 	bench_last; 					/*!< end of the last stage of the thread */
+static _Thread_local double 	bench_seconds[BENCH_STAGES]; 	/*!< stages of the image of the thread */
+static bench_record_t* 		bench_records; 					/*!< synthesized images */
+static size_t 				bench_size, bench_capacity; 	/*!< num of records and capacity */
+static pthread_mutex_t 		bench_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+double 	bench_now(void);
+void 	bench_string(FILE*, const char*);
+void 	bench_rate(FILE*, size_t, double);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    monotonic time
+ * \return 		seconds
+ */
+double
+bench_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + 1e-9*now.tv_nsec;
+}
+
+/**
+ * \brief 	    start the timings of an image of the thread
+ */
+void
+bench_start(void)
+{
+	memset(bench_seconds, 0, sizeof (bench_seconds));
+	bench_last = bench_now();
+}
+
+/**
+ * \brief 	    end a stage, the time since the end of the last one is added to it
+ * \param[in] 	stage: BENCH_READ, BENCH_MEDIAN, BENCH_BINARIZE, BENCH_COUNT, BENCH_MAP or BENCH_WRITE
+ */
+void
+bench_stage(int32_t stage)
+{
+	double now = bench_now();
+
+	bench_seconds[stage] += now - bench_last;
+	bench_last = now;
+}
+
+/**
+ * \brief 	    record the timings of the image of the thread
+ * \note 	    a record that does not fit in memory is lost.
+ * \param[in] 	image: image file path respect its set
+ * \param[in] 	num_of_pixels: num of pixels
+ */
+void
+bench_end(const char* image, size_t num_of_pixels)
+{
+	pthread_mutex_lock(&bench_mutex);
+	if (bench_size == bench_capacity) {
+		size_t capacity = bench_capacity ? 2*bench_capacity : 16;
+		bench_record_t* records = realloc(bench_records, capacity * sizeof (bench_record_t));
+
+		if (records != NULL) {
+			bench_records = records;
+			bench_capacity = capacity;
+		}
+	}
+	if (bench_size < bench_capacity) {
+		bench_record_t* record = &bench_records[bench_size];
+
+		record->image = malloc(strlen(image) + 1);
+		if (record->image != NULL) {
+			strcpy(record->image, image);
+			record->num_of_pixels = num_of_pixels;
+			memcpy(record->seconds, bench_seconds, sizeof (bench_seconds));
+			++bench_size;
+		}
+	}
+	pthread_mutex_unlock(&bench_mutex);
+}
+
+/**
+ * \brief 	    write a JSON string
+ * \param[in] 	fp: file
+ * \param[in] 	string: string
+ */
+void
+bench_string(FILE* fp, const char* string)
+{
+	fputc('"', fp);
+	for (; *string != '\0'; ++string) {
+		if (*string == '"' || *string == '\\') {
+			fputc('\\', fp);
+		}
+		fputc(*string, fp);
+	}
+	fputc('"', fp);
+}
+
+/**
+ * \brief 	    write a throughput in megapixels per second
+ * \param[in] 	fp: file
+ * \param[in] 	num_of_pixels: num of pixels
+ * \param[in] 	seconds: seconds, null if 0
+ */
+void
+bench_rate(FILE* fp, size_t num_of_pixels, double seconds)
+{
+	if (seconds > 0) {
+		fprintf(fp, "%.3f", 1e-6*num_of_pixels/seconds);
+	} else {
+		fprintf(fp, "null");
+	}
+}
+
+/**
+ * \brief 	    write the report of the run and free the records
+ * \note 	    the report is BENCH_FILE in the synthesis folder. The peak RSS is the one
+ *              of the process, the pages of the mapped images included.
+ * \param[in] 	directory: synthesis folder
+ * \param[in] 	model: model of the synthesis
+ * \param[in] 	gram_size: side of the grams
+ * \param[in] 	engine: engine counting the grams
+ * \param[in] 	num_of_threads: num of threads
+ * \return 		0: any error.
+ *              1: write error.
+ */
+int
+bench_report(const char* directory, int32_t model, int32_t gram_size, int32_t engine, int32_t num_of_threads)
+{
+	char path[FILENAME_MAX];
+	FILE* fp;
+	struct rusage usage;
+	int output;
+
+	snprintf(path, FILENAME_MAX, "%s/%s", directory, BENCH_FILE);
+	fp = fopen(path, "w");
+	getrusage(RUSAGE_SELF, &usage);
+	if (fp != NULL) {
+		fprintf(fp, "{\"model\": %d, \"gram_size\": %d, \"engine\": %d, \"threads\": %d, \"peak_rss_kib\": %ld, \"images\": [",
+			model, gram_size, engine, num_of_threads, usage.ru_maxrss);
+		for (size_t i = 0; i < bench_size; ++i) {
+			const bench_record_t* record = &bench_records[i];
+			double total = 0;
+
+			fprintf(fp, "%s\n  {\"image\": ", i ? "," : "");
+			bench_string(fp, record->image);
+			fprintf(fp, ", \"pixels\": %zu, \"seconds\": {", record->num_of_pixels);
+			for (int32_t stage = 0; stage < BENCH_STAGES; ++stage) {
+				fprintf(fp, "\"%s\": %.6f, ", bench_names[stage], record->seconds[stage]);
+				total += record->seconds[stage];
+			}
+			fprintf(fp, "\"total\": %.6f}, \"mp_per_s\": {", total);
+			for (int32_t stage = 0; stage < BENCH_STAGES; ++stage) {
+				fprintf(fp, "\"%s\": ", bench_names[stage]);
+				bench_rate(fp, record->num_of_pixels, record->seconds[stage]);
+				fprintf(fp, ", ");
+			}
+			fprintf(fp, "\"total\": ");
+			bench_rate(fp, record->num_of_pixels, total);
+			fprintf(fp, "}}");
+		}
+		fprintf(fp, "\n]}\n");
+	}
+	output = fp == NULL || ferror(fp);
+	if (fp != NULL && fclose(fp) != 0) {
+		output = 1;
+	}
+
+	for (size_t i = 0; i < bench_size; ++i)
+		free(bench_records[i].image);
+	free(bench_records);
+	bench_records = NULL;
+	bench_size = bench_capacity = 0;
+	return output;
+}
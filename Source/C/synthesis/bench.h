@@ -0,0 +1,87 @@
+/**
+ * \file            bench.h
+ * \brief           Stage timings of the synthesis, compiled in by SYNTHESIS_BENCH
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of bench.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+#ifndef BENCH_H
+#define BENCH_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define BENCH_READ 0 /* open and map the image */
+#define BENCH_MEDIAN 1 /* histogram and median of the brightness */
+#define BENCH_BINARIZE 2 /* threshold into the bitboard, or the opinions of the opinion model */
+#define BENCH_COUNT 3 /* count of the grams, all the synthesis for the streamed and multilayer ones */
+#define BENCH_MAP 4 /* recurrence map */
+#define BENCH_WRITE 5 /* synthesis file */
+#define BENCH_STAGES 6 /* num of stages */
+#define BENCH_FILE "bench.json" /* report in the synthesis folder */
+
+#ifdef SYNTHESIS_BENCH
+	#define BENCH_START() bench_start()
+	#define BENCH_STAGE(stage) bench_stage(stage)
+	#define BENCH_END(image, num_of_pixels) bench_end(image, num_of_pixels)
+	#define BENCH_REPORT(directory, model, gram_size, engine, num_of_threads) \
+		bench_report(directory, model, gram_size, engine, num_of_threads)
+#else
+	#define BENCH_START() ((void)0)
+	#define BENCH_STAGE(stage) ((void)0)
+	#define BENCH_END(image, num_of_pixels) ((void)0)
+	#define BENCH_REPORT(directory, model, gram_size, engine, num_of_threads) 0
+#endif /* SYNTHESIS_BENCH */
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+void 	bench_start(void);
+void 	bench_stage(int32_t);
+void 	bench_end(const char*, size_t);
+int 	bench_report(const char*, int32_t, int32_t, int32_t, int32_t);
+
+
+#endif /* guard */
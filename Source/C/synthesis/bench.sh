@@ -0,0 +1,38 @@
+#!/bin/sh
+# Stage-level bench of the synthesis: synthetic images of each kind and size are
+# synthesized one per run by each engine, each run writes its bench.json and the
+# results are gathered in $WORK/results.json.
+#
+# Usage: sh bench.sh [model=...] [gram_size=...] [threads=...]
+# Environment: WORK (work folder), KINDS, SIZES (megapixels, up to 100), ENGINES.
+
+WORK=${WORK:-/tmp/synthesis_bench}
+KINDS=${KINDS:-"noise flat stripes painting"}
+SIZES=${SIZES:-"1 4 16"}
+ENGINES=${ENGINES:-"0 1 2 3"}
+HERE=$(cd "$(dirname "$0")" && pwd)
+
+mkdir -p "$WORK/Set/A" || exit 1
+results="$WORK/results.json"
+printf '[' > "$results"
+separator=''
+for size in $SIZES; do
+	for kind in $KINDS; do
+		image="$kind-$size"
+		if [ ! -f "$WORK/Set/A/$image.ppm" ]; then
+			"$HERE/ppmgen" "$kind" "$size" "$WORK/Set/A/$image.ppm" || exit 1
+		fi
+		for engine in $ENGINES; do
+			# a fresh destination, no manifest, so that every run synthesizes its image
+			rm -rf "$WORK/Out" && mkdir -p "$WORK/Out/A" || exit 1
+			printf '%s\n%s\n1\nA/%s.ppm\n' "$WORK/Set" "$WORK/Out" "$image" > "$WORK/input.txt"
+			"$HERE/Bench" "$WORK/input.txt" "engine=$engine" "$@" > /dev/null || exit 1
+			printf '%s' "$separator" >> "$results"
+			cat "$WORK/Out/bench.json" >> "$results"
+			separator=','
+			echo "$image engine=$engine done"
+		done
+	done
+done
+printf ']\n' >> "$results"
+echo "results in $results"
@@ -0,0 +1,622 @@
+/**
+ * \file 		binarize.c
+ * \brief 		define binarize_histogram, binarize_median, binarize_quantiles, binarize_row, binarize,
+ *              binarize_ppm_histogram, binarize_ppm_median, binarize_ppm_row, binarize_ppm_codes,
+ *              binarize_ppm_threshold, binarize_ppm, binarize_ppm_levels
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of binarize.
+ *
+ * Author: 		Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "binarize.h"
+#include "trace.h"
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+#endif
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define BINARIZE_BLOCK 64 /* num of pixels of a block, a word of the bitboard */
+#define BINARIZE_CHUNK 65536 /* num of pixels converted at once from a mapped image */
+
+#if defined(__SSE2__)
+	#define BINARIZE_SSE2 /* SSE2 kernels */
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define BINARIZE_AVX2 /* AVX2 kernels, selected at runtime */
+#endif
+
+/**
+ * \brief 			brightness code of a pixel
+ * \param[in]       px: reference to the RGB channels
+ * \hideinitializer
+ */
+#define CODE(px) 																		\
+	((uint32_t)((px)[0] < (px)[1] ? ((px)[0] < (px)[2] ? (px)[0] : (px)[2]) : ((px)[1] < (px)[2] ? (px)[1] : (px)[2])) + \
+	 (uint32_t)((px)[0] >= (px)[1] ? ((px)[0] >= (px)[2] ? (px)[0] : (px)[2]) : ((px)[1] >= (px)[2] ? (px)[1] : (px)[2])))
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+uint64_t 	binarize_reverse(uint64_t);
+void 		binarize_codes_scalar(const uint8_t*, uint16_t*);
+uint64_t 	binarize_mask_scalar(const uint8_t*, uint32_t);
+#ifdef BINARIZE_SSE2
+void 		binarize_codes_sse2(const uint8_t*, uint16_t*);
+uint64_t 	binarize_mask_sse2(const uint8_t*, uint32_t);
+#endif /* BINARIZE_SSE2 */
+#ifdef BINARIZE_AVX2
+void 		binarize_codes_avx2(const uint8_t*, uint16_t*);
+uint64_t 	binarize_mask_avx2(const uint8_t*, uint32_t);
+#endif /* BINARIZE_AVX2 */
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    reverse the order of the bits of a word
+ * \param[in] 	word: word to reverse
+ * \return 		the reversed word.
+ */
+uint64_t
+binarize_reverse(uint64_t word)
+{
+	word = ((word >> 1) & UINT64_C(0x5555555555555555)) | ((word & UINT64_C(0x5555555555555555)) << 1);
+	word = ((word >> 2) & UINT64_C(0x3333333333333333)) | ((word & UINT64_C(0x3333333333333333)) << 2);
+	word = ((word >> 4) & UINT64_C(0x0F0F0F0F0F0F0F0F)) | ((word & UINT64_C(0x0F0F0F0F0F0F0F0F)) << 4);
+	return __builtin_bswap64(word);
+}
+
+/**
+ * \brief 	    brightness codes of a block
+ * \param[in] 	src: BINARIZE_BLOCK RGB pixels
+ * \param[out] 	codes: BINARIZE_BLOCK codes, in any order
+ */
+void
+binarize_codes_scalar(const uint8_t* src, uint16_t* codes)
+{
+	for (int32_t i = 0; i < BINARIZE_BLOCK; ++i)
+		codes[i] = (uint16_t)CODE(src + 3*i);
+}
+
+/**
+ * \brief 	    threshold of a block
+ * \param[in] 	src: BINARIZE_BLOCK RGB pixels
+ * \param[in] 	median: brightness code of the threshold
+ * \return 		a bit per pixel, the first pixel is the least significant bit.
+ */
+uint64_t
+binarize_mask_scalar(const uint8_t* src, uint32_t median)
+{
+	uint64_t mask = 0;
+
+	for (int32_t i = 0; i < BINARIZE_BLOCK; ++i)
+		mask |= (uint64_t)(CODE(src + 3*i) >= median) << i;
+	return mask;
+}
+
+#ifdef BINARIZE_SSE2
+/**
+ * \brief 	    min and max channels of 32 pixels
+ * \note 	    five rounds of unpack split the RGB channels of 32 pixels.
+ * \param[in] 	src: 32 RGB pixels
+ * \param[out] 	min: min channel of the pixels 0-15 and 16-31
+ * \param[out] 	max: max channel of the pixels 0-15 and 16-31
+ */
+static inline void
+binarize_minmax_sse2(const uint8_t* src, __m128i* min, __m128i* max)
+{
+	__m128i c[6];
+
+	for (int32_t i = 0; i < 6; ++i)
+		c[i] = _mm_loadu_si128((const __m128i*)src + i);
+	for (int32_t round = 0; round < 5; ++round) {
+		__m128i n[6];
+		for (int32_t i = 0; i < 3; ++i) {
+			n[2*i] = _mm_unpacklo_epi8(c[i], c[i + 3]);
+			n[2*i + 1] = _mm_unpackhi_epi8(c[i], c[i + 3]);
+		}
+		memcpy(c, n, sizeof (c));
+	}
+	min[0] = _mm_min_epu8(_mm_min_epu8(c[0], c[2]), c[4]);
+	min[1] = _mm_min_epu8(_mm_min_epu8(c[1], c[3]), c[5]);
+	max[0] = _mm_max_epu8(_mm_max_epu8(c[0], c[2]), c[4]);
+	max[1] = _mm_max_epu8(_mm_max_epu8(c[1], c[3]), c[5]);
+}
+
+/**
+ * \brief 	    brightness codes of a block, SSE2 kernel
+ * \param[in] 	src: BINARIZE_BLOCK RGB pixels
+ * \param[out] 	codes: BINARIZE_BLOCK codes, in any order
+ */
+void
+binarize_codes_sse2(const uint8_t* src, uint16_t* codes)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int32_t half = 0; half < 2; ++half) {
+		__m128i min[2], max[2];
+
+		binarize_minmax_sse2(src + 96*half, min, max);
+		for (int32_t i = 0; i < 2; ++i) {
+			_mm_storeu_si128((__m128i*)codes, _mm_add_epi16(_mm_unpacklo_epi8(min[i], zero), _mm_unpacklo_epi8(max[i], zero)));
+			_mm_storeu_si128((__m128i*)codes + 1, _mm_add_epi16(_mm_unpackhi_epi8(min[i], zero), _mm_unpackhi_epi8(max[i], zero)));
+			codes += 16;
+		}
+	}
+}
+
+/**
+ * \brief 	    threshold of a block, SSE2 kernel
+ * \param[in] 	src: BINARIZE_BLOCK RGB pixels
+ * \param[in] 	median: brightness code of the threshold
+ * \return 		a bit per pixel, the first pixel is the least significant bit.
+ */
+uint64_t
+binarize_mask_sse2(const uint8_t* src, uint32_t median)
+{
+	const __m128i zero = _mm_setzero_si128(), limit = _mm_set1_epi16((int16_t)median - 1);
+	uint64_t mask = 0;
+
+	for (int32_t half = 0; half < 2; ++half) {
+		__m128i min[2], max[2];
+
+		binarize_minmax_sse2(src + 96*half, min, max);
+		for (int32_t i = 0; i < 2; ++i) {
+			__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(min[i], zero), _mm_unpacklo_epi8(max[i], zero));
+			__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(min[i], zero), _mm_unpackhi_epi8(max[i], zero));
+			__m128i bits = _mm_packs_epi16(_mm_cmpgt_epi16(lo, limit), _mm_cmpgt_epi16(hi, limit));
+
+			mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(bits) << (32*half + 16*i);
+		}
+	}
+	return mask;
+}
+#endif /* BINARIZE_SSE2 */
+
+#ifdef BINARIZE_AVX2
+/**
+ * \brief 	    min and max channels of 64 pixels
+ * \note 	    the low lanes hold the pixels 0-31 and the high lanes the pixels 32-63,
+ *              five rounds of unpack split the RGB channels.
+ * \param[in] 	src: 64 RGB pixels
+ * \param[out] 	min: min channel of the pixels 0-15|32-47 and 16-31|48-63
+ * \param[out] 	max: max channel of the pixels 0-15|32-47 and 16-31|48-63
+ */
+__attribute__((target("avx2"))) static inline void
+binarize_minmax_avx2(const uint8_t* src, __m256i* min, __m256i* max)
+{
+	__m256i c[6];
+
+	for (int32_t i = 0; i < 6; ++i)
+		c[i] = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)src + i)),
+			_mm_loadu_si128((const __m128i*)src + i + 6), 1);
+	for (int32_t round = 0; round < 5; ++round) {
+		__m256i n[6];
+		for (int32_t i = 0; i < 3; ++i) {
+			n[2*i] = _mm256_unpacklo_epi8(c[i], c[i + 3]);
+			n[2*i + 1] = _mm256_unpackhi_epi8(c[i], c[i + 3]);
+		}
+		memcpy(c, n, sizeof (c));
+	}
+	min[0] = _mm256_min_epu8(_mm256_min_epu8(c[0], c[2]), c[4]);
+	min[1] = _mm256_min_epu8(_mm256_min_epu8(c[1], c[3]), c[5]);
+	max[0] = _mm256_max_epu8(_mm256_max_epu8(c[0], c[2]), c[4]);
+	max[1] = _mm256_max_epu8(_mm256_max_epu8(c[1], c[3]), c[5]);
+}
+
+/**
+ * \brief 	    brightness codes of a block, AVX2 kernel
+ * \param[in] 	src: BINARIZE_BLOCK RGB pixels
+ * \param[out] 	codes: BINARIZE_BLOCK codes, in any order
+ */
+__attribute__((target("avx2"))) void
+binarize_codes_avx2(const uint8_t* src, uint16_t* codes)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i min[2], max[2];
+
+	binarize_minmax_avx2(src, min, max);
+	for (int32_t i = 0; i < 2; ++i) {
+		_mm256_storeu_si256((__m256i*)codes, _mm256_add_epi16(_mm256_unpacklo_epi8(min[i], zero), _mm256_unpacklo_epi8(max[i], zero)));
+		_mm256_storeu_si256((__m256i*)codes + 1, _mm256_add_epi16(_mm256_unpackhi_epi8(min[i], zero), _mm256_unpackhi_epi8(max[i], zero)));
+		codes += 32;
+	}
+}
+
+/**
+ * \brief 	    threshold of a block, AVX2 kernel
+ * \param[in] 	src: BINARIZE_BLOCK RGB pixels
+ * \param[in] 	median: brightness code of the threshold
+ * \return 		a bit per pixel, the first pixel is the least significant bit.
+ */
+__attribute__((target("avx2"))) uint64_t
+binarize_mask_avx2(const uint8_t* src, uint32_t median)
+{
+	const __m256i zero = _mm256_setzero_si256(), limit = _mm256_set1_epi16((int16_t)median - 1);
+	__m256i min[2], max[2];
+	uint32_t bits[2];
+
+	binarize_minmax_avx2(src, min, max);
+	for (int32_t i = 0; i < 2; ++i) {
+		__m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(min[i], zero), _mm256_unpacklo_epi8(max[i], zero));
+		__m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(min[i], zero), _mm256_unpackhi_epi8(max[i], zero));
+		bits[i] = (uint32_t)_mm256_movemask_epi8(_mm256_packs_epi16(_mm256_cmpgt_epi16(lo, limit), _mm256_cmpgt_epi16(hi, limit)));
+	}
+	return (uint64_t)(bits[0] & 0xFFFF) | (uint64_t)(bits[1] & 0xFFFF) << 16 |
+		(uint64_t)(bits[0] >> 16) << 32 | (uint64_t)(bits[1] >> 16) << 48;
+}
+#endif /* BINARIZE_AVX2 */
+
+/**
+ * \brief 	    add the brightness codes of the pixels to a histogram
+ * \note 	    four histograms are filled in turn, so consecutive equal codes do not stall.
+ * \param[in] 	pixels: RGB pixels
+ * \param[in] 	num_of_pixels: num of pixels
+ * \param[in] 	histogram: BINARIZE_LEVELS counters
+ */
+void
+binarize_histogram(const uint8_t* pixels, size_t num_of_pixels, size_t* histogram)
+{
+	void (*codes_kernel)(const uint8_t*, uint16_t*) = binarize_codes_scalar;
+	size_t partial[4][BINARIZE_LEVELS] = {{0}};
+	uint16_t codes[BINARIZE_BLOCK];
+	size_t i = 0;
+
+#ifdef BINARIZE_SSE2
+	codes_kernel = binarize_codes_sse2;
+#endif /* BINARIZE_SSE2 */
+#ifdef BINARIZE_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		codes_kernel = binarize_codes_avx2;
+	}
+#endif /* BINARIZE_AVX2 */
+
+	for (; i + BINARIZE_BLOCK <= num_of_pixels; i += BINARIZE_BLOCK) {
+		codes_kernel(pixels + 3*i, codes);
+		for (int32_t j = 0; j < BINARIZE_BLOCK; j += 4) {
+			++partial[0][codes[j]];
+			++partial[1][codes[j + 1]];
+			++partial[2][codes[j + 2]];
+			++partial[3][codes[j + 3]];
+		}
+	}
+	for (; i < num_of_pixels; ++i)
+		++partial[0][CODE(pixels + 3*i)];
+
+	for (int32_t level = 0; level < BINARIZE_LEVELS; ++level)
+		histogram[level] += partial[0][level] + partial[1][level] + partial[2][level] + partial[3][level];
+}
+
+/**
+ * \brief 	    median of a histogram
+ * \note 	    it is the (num_of_pixels/2)-th smallest code, as 'select'.
+ * \param[in] 	histogram: BINARIZE_LEVELS counters
+ * \param[in] 	num_of_pixels: num of counted pixels
+ * \return 		brightness code of the median.
+ */
+uint32_t
+binarize_median(const size_t* histogram, size_t num_of_pixels)
+{
+	size_t k = num_of_pixels / 2 ? num_of_pixels / 2 : 1, cumulative = 0;
+
+	for (uint32_t level = 0; level < BINARIZE_LEVELS; ++level) {
+		cumulative += histogram[level];
+		if (cumulative >= k) {
+			return level;
+		}
+	}
+	return 0;
+}
+
+/**
+ * \brief 	    quantiles of a histogram
+ * \note 	    the k-th threshold is the (k*num_of_pixels/layers)-th smallest code, so
+ *              with two layers the threshold is the median. A pixel is in the layer of
+ *              the num of thresholds not greater than its code.
+ * \param[in] 	histogram: BINARIZE_LEVELS counters
+ * \param[in] 	num_of_pixels: num of counted pixels
+ * \param[in] 	layers: num of layers, from 2 to BINARIZE_MAX_LAYERS
+ * \param[out] 	thresholds: layers-1 brightness codes, not decreasing
+ */
+void
+binarize_quantiles(const size_t* histogram, size_t num_of_pixels, int32_t layers, uint32_t* thresholds)
+{
+	size_t cumulative = 0;
+	uint32_t level = 0;
+
+	for (int32_t k = 1; k < layers; ++k) {
+		size_t rank = num_of_pixels * (size_t)k / (size_t)layers;
+
+		rank = rank ? rank : 1;
+		while (level < BINARIZE_LEVELS - 1 && cumulative + histogram[level] < rank)
+			cumulative += histogram[level++];
+		thresholds[k - 1] = level;
+	}
+}
+
+/**
+ * \brief 	    threshold a row of pixels into a row of the bitboard
+ * \note 	    a pixel is 1 iff its brightness code is at least the median.
+ * \param[in] 	pixels: width RGB pixels
+ * \param[in] 	width: num of pixels
+ * \param[in] 	median: brightness code of the threshold
+ * \param[out] 	row: row of the bitboard
+ */
+void
+binarize_row(const uint8_t* pixels, int32_t width, uint32_t median, uint64_t* row)
+{
+	uint64_t (*mask_kernel)(const uint8_t*, uint32_t) = binarize_mask_scalar;
+	int32_t col = 0;
+
+#ifdef BINARIZE_SSE2
+	mask_kernel = binarize_mask_sse2;
+#endif /* BINARIZE_SSE2 */
+#ifdef BINARIZE_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		mask_kernel = binarize_mask_avx2;
+	}
+#endif /* BINARIZE_AVX2 */
+
+	for (; col + BINARIZE_BLOCK <= width; col += BINARIZE_BLOCK)
+		row[col / BINARIZE_BLOCK] = binarize_reverse(mask_kernel(pixels + 3*(size_t)col, median));
+	if (col < width) {
+		uint64_t word = 0;
+
+		for (int32_t c = col; c < width; ++c)
+			word |= (uint64_t)(CODE(pixels + 3*(size_t)c) >= median) << (63 - (c & 63));
+		row[col / BINARIZE_BLOCK] = word;
+	}
+}
+
+/**
+ * \brief 	    binarize an image around the median brightness
+ * \note 	    the brightness code of a pixel is min+max of its channels, so the
+ *              median is found by a histogram of BINARIZE_LEVELS counters.
+ * \param[in] 	pixels: RGB pixels
+ * \param[out] 	board: allocated bitboard with the shape of the image
+ * \return 		brightness code of the median.
+ */
+uint32_t
+binarize(const uint8_t* pixels, bitboard_t* board)
+{
+	size_t histogram[BINARIZE_LEVELS] = {0};
+	size_t num_of_pixels = (size_t)board->width * (size_t)board->height;
+	uint32_t median;
+
+	binarize_histogram(pixels, num_of_pixels, histogram);
+	median = binarize_median(histogram, num_of_pixels);
+	for (int32_t raw = 0; raw < board->height; ++raw)
+		binarize_row(pixels + 3*(size_t)raw*board->width, board->width, median, BITBOARD_ROW(board, raw));
+	return median;
+}
+
+/**
+ * \brief 	    histogram of the brightness codes of a mapped image
+ * \note 	    8-bit RGB pixels are read in place from the mapping, the other
+ *              formats are converted to RGB by chunks of rows.
+ * \param[in] 	image: mapped image
+ * \param[out] 	histogram: BINARIZE_LEVELS counters, set to 0 by the caller
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+binarize_ppm_histogram(const ppm_t* image, size_t* histogram)
+{
+	size_t num_of_pixels = (size_t)image->width * (size_t)image->height, row_size = 3*(size_t)image->width;
+	int32_t rows = 1 + BINARIZE_CHUNK / image->width;
+	uint8_t* chunk;
+
+	if (ppm_is_rgb(image)) {
+		binarize_histogram(image->pixels, num_of_pixels, histogram);
+		return 0;
+	}
+
+	if (rows > image->height) {
+		rows = image->height;
+	}
+	chunk = malloc(rows*row_size);
+	TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+	if (chunk == NULL) {
+		return 1;
+	}
+	for (int32_t first = 0; first < image->height; first += rows) {
+		int32_t last = first + rows < image->height ? first + rows : image->height;
+
+		for (int32_t raw = first; raw < last; ++raw)
+			ppm_row(image, raw, chunk + (raw - first)*row_size);
+		binarize_histogram(chunk, (size_t)(last - first)*image->width, histogram);
+	}
+
+	free(chunk);
+	return 0;
+}
+
+/**
+ * \brief 	    median brightness of a mapped image
+ * \param[in] 	image: mapped image
+ * \param[out] 	median: brightness code of the median
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+binarize_ppm_median(const ppm_t* image, uint32_t* median)
+{
+	size_t histogram[BINARIZE_LEVELS] = {0};
+
+	if (binarize_ppm_histogram(image, histogram)) {
+		return 1;
+	}
+	*median = binarize_median(histogram, (size_t)image->width * (size_t)image->height);
+	return 0;
+}
+
+/**
+ * \brief 	    threshold a row of a mapped image into a row of the bitboard
+ * \param[in] 	image: mapped image
+ * \param[in] 	raw: row of the image
+ * \param[in] 	median: brightness code of the threshold
+ * \param[in] 	buffer: 3*width bytes, unused for 8-bit RGB pixels
+ * \param[out] 	row: row of the bitboard
+ */
+void
+binarize_ppm_row(const ppm_t* image, int32_t raw, uint32_t median, uint8_t* buffer, uint64_t* row)
+{
+	if (ppm_is_rgb(image)) {
+		binarize_row(image->pixels + (size_t)raw*image->stride, image->width, median, row);
+	} else {
+		ppm_row(image, raw, buffer);
+		binarize_row(buffer, image->width, median, row);
+	}
+}
+
+/**
+ * \brief 	    brightness codes of a row of a mapped image
+ * \param[in] 	image: mapped image
+ * \param[in] 	raw: row of the image
+ * \param[in] 	buffer: 3*width bytes, unused for 8-bit RGB pixels
+ * \param[out] 	codes: width brightness codes, in order
+ */
+void
+binarize_ppm_codes(const ppm_t* image, int32_t raw, uint8_t* buffer, uint16_t* codes)
+{
+	const uint8_t* pixels = buffer;
+
+	if (ppm_is_rgb(image)) {
+		pixels = image->pixels + (size_t)raw*image->stride;
+	} else {
+		ppm_row(image, raw, buffer);
+	}
+	for (int32_t col = 0; col < image->width; ++col)
+		codes[col] = (uint16_t)CODE(pixels + 3*(size_t)col);
+}
+
+/**
+ * \brief 	    threshold a mapped image into a bitboard
+ * \param[in] 	image: mapped image
+ * \param[in] 	median: brightness code of the threshold
+ * \param[out] 	board: allocated bitboard with the shape of the image
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+binarize_ppm_threshold(const ppm_t* image, uint32_t median, bitboard_t* board)
+{
+	uint8_t* buffer = NULL;
+
+	if (!ppm_is_rgb(image)) {
+		buffer = malloc(3*(size_t)board->width);
+		TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+		if (buffer == NULL) {
+			return 1;
+		}
+	}
+	for (int32_t raw = 0; raw < board->height; ++raw)
+		binarize_ppm_row(image, raw, median, buffer, BITBOARD_ROW(board, raw));
+
+	free(buffer);
+	return 0;
+}
+
+/**
+ * \brief 	    binarize a mapped image around the median brightness
+ * \param[in] 	image: mapped image
+ * \param[out] 	board: allocated bitboard with the shape of the image
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+binarize_ppm(const ppm_t* image, bitboard_t* board)
+{
+	uint32_t median;
+
+	return binarize_ppm_median(image, &median) || binarize_ppm_threshold(image, median, board);
+}
+
+/**
+ * \brief 	    quantize a mapped image in layers of brightness
+ * \note 	    one pass for the histogram, then each pixel takes its layer from a table
+ *              of the BINARIZE_LEVELS brightness codes.
+ * \param[in] 	image: mapped image
+ * \param[in] 	layers: num of layers, from 2 to BINARIZE_MAX_LAYERS
+ * \param[out] 	levels: width*height layers, from 0 (darkest) to layers-1
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+binarize_ppm_levels(const ppm_t* image, int32_t layers, uint8_t* levels)
+{
+	size_t histogram[BINARIZE_LEVELS] = {0};
+	uint32_t thresholds[BINARIZE_MAX_LAYERS];
+	uint8_t table[BINARIZE_LEVELS];
+	uint8_t* buffer = malloc(3*(size_t)image->width);
+
+	TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+	if (buffer == NULL || binarize_ppm_histogram(image, histogram)) {
+		free(buffer);
+		return 1;
+	}
+	binarize_quantiles(histogram, (size_t)image->width * (size_t)image->height, layers, thresholds);
+	for (uint32_t code = 0, layer = 0; code < BINARIZE_LEVELS; ++code) {
+		while ((int32_t)layer < layers - 1 && thresholds[layer] <= code)
+			++layer;
+		table[code] = (uint8_t)layer;
+	}
+
+	for (int32_t raw = 0; raw < image->height; ++raw) {
+		const uint8_t* pixels = buffer;
+		uint8_t* dest = levels + (size_t)raw*image->width;
+
+		if (ppm_is_rgb(image)) {
+			pixels = image->pixels + (size_t)raw*image->stride;
+		} else {
+			ppm_row(image, raw, buffer);
+		}
+		for (int32_t col = 0; col < image->width; ++col)
+			dest[col] = table[CODE(pixels + 3*(size_t)col)];
+	}
+
+	free(buffer);
+	return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * \file            binarize.h
+ * \brief           Binarization of the images
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of binarize.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+#ifndef BINARIZE_H
+#define BINARIZE_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "bitboard.h"
+#include "ppm.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define BINARIZE_LEVELS 511 /* num of brightness codes, min+max of the channels */
+#define BINARIZE_METHOD 1 /* threshold at the median brightness, changed when the binarization changes */
+#define BINARIZE_MAX_LAYERS 16 /* max num of levels of the multilayer model */
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+void 		binarize_histogram(const uint8_t*, size_t, size_t*);
+uint32_t 	binarize_median(const size_t*, size_t);
+void 		binarize_quantiles(const size_t*, size_t, int32_t, uint32_t*);
+void 		binarize_row(const uint8_t*, int32_t, uint32_t, uint64_t*);
+uint32_t 	binarize(const uint8_t*, bitboard_t*);
+int 		binarize_ppm_histogram(const ppm_t*, size_t*);
+int 		binarize_ppm_median(const ppm_t*, uint32_t*);
+void 		binarize_ppm_row(const ppm_t*, int32_t, uint32_t, uint8_t*, uint64_t*);
+void 		binarize_ppm_codes(const ppm_t*, int32_t, uint8_t*, uint16_t*);
+int 		binarize_ppm_threshold(const ppm_t*, uint32_t, bitboard_t*);
+int 		binarize_ppm(const ppm_t*, bitboard_t*);
+int 		binarize_ppm_levels(const ppm_t*, int32_t, uint8_t*);
+
+
+#endif /* guard */
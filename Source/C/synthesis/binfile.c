@@ -0,0 +1,376 @@
+/**
+ * \file 		binfile.c
+ * \brief 		define binfile_create, binfile_begin, binfile_write, binfile_write_grams, binfile_write_wide_grams,
+ *              binfile_finish, binfile_open, binfile_section, binfile_decode_grams, binfile_close
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of binfile.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#define _POSIX_C_SOURCE 200809L  // mmap
+#include "binfile.h"
+#include "trace.h"
+#include "../config.h"
+#include <fcntl.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define BINFILE_CHUNK 4096 /* num of grams encoded at once */
+#define BINFILE_VARINT_MAX 10 /* max bytes of a 64 bits varint */
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    start a synthesis file
+ * \note 	    the header and the table are written at the end by binfile_finish.
+ * \param[out] 	file: synthesis file
+ * \param[in] 	fp: file open for writing, at its beginning
+ * \param[in] 	model: model of the synthesis
+ * \param[in] 	gram_size: side of the grams
+ * \param[in] 	width: width of the image
+ * \param[in] 	height: height of the image
+ * \return 		0: any error.
+ *              1: write error.
+ */
+int
+binfile_create(binfile_t* file, FILE* fp, int32_t model, int32_t gram_size, int32_t width, int32_t height)
+{
+	memset(file, 0, sizeof (binfile_t));
+	memcpy(file->header.magic, BINFILE_MAGIC, 4);
+	file->header.version = BINFILE_VERSION;
+	file->header.endianness = BINFILE_ENDIANNESS;
+	file->header.model = model;
+	file->header.gram_size = gram_size;
+	file->header.width = width;
+	file->header.height = height;
+	file->fp = fp;
+
+	/* room for the header and the table */
+	if (fwrite(&file->header, sizeof (binfile_header_t), 1, fp) != 1 ||
+		fwrite(file->sections, sizeof (binfile_section_t), BINFILE_SECTIONS, fp) != BINFILE_SECTIONS) {
+		return 1;
+	}
+	file->position = sizeof (binfile_header_t) + BINFILE_SECTIONS * sizeof (binfile_section_t);
+	TRACE_COUNT(TRACE_BYTES_WRITTEN, file->position);
+	return 0;
+}
+
+/**
+ * \brief 	    start a section, at the next aligned byte
+ * \param[in] 	file: synthesis file
+ * \param[in] 	id: id of the section
+ * \param[in] 	encoding: encoding of the section
+ * \return 		0: any error.
+ *              1: write error or too many sections.
+ */
+int
+binfile_begin(binfile_t* file, uint32_t id, uint32_t encoding)
+{
+	static const uint8_t padding[BINFILE_ALIGNMENT] = {0};
+	size_t pad = (BINFILE_ALIGNMENT - file->position % BINFILE_ALIGNMENT) % BINFILE_ALIGNMENT;
+	binfile_section_t* section;
+
+	if (file->header.num_of_sections == BINFILE_SECTIONS || fwrite(padding, 1, pad, file->fp) != pad) {
+		return 1;
+	}
+	file->position += pad;
+	TRACE_COUNT(TRACE_BYTES_WRITTEN, pad);
+	section = &file->sections[file->header.num_of_sections++];
+	section->id = id;
+	section->encoding = encoding;
+	section->offset = file->position;
+	section->size = 0;
+	return 0;
+}
+
+/**
+ * \brief 	    append bytes to the current section
+ * \param[in] 	file: synthesis file
+ * \param[in] 	data: bytes
+ * \param[in] 	size: num of bytes
+ * \return 		0: any error.
+ *              1: write error.
+ */
+int
+binfile_write(binfile_t* file, const void* data, size_t size)
+{
+	if (fwrite(data, 1, size, file->fp) != size) {
+		return 1;
+	}
+	file->position += size;
+	file->sections[file->header.num_of_sections - 1].size += size;
+	TRACE_COUNT(TRACE_BYTES_WRITTEN, size);
+	return 0;
+}
+
+/**
+ * \brief 	    write the section of the grams
+ * \note 	    a code is written as its difference from the previous one, 7 bits a byte
+ *              from the least significant, the high bit set on all bytes but the last.
+ * \param[in] 	file: synthesis file
+ * \param[in] 	codes: distinct packed grams, ascending
+ * \param[in] 	size: num of grams
+ * \return 		0: any error.
+ *              1: write error.
+ */
+int
+binfile_write_grams(binfile_t* file, const uint64_t* codes, size_t size)
+{
+	uint8_t chunk[BINFILE_CHUNK * BINFILE_VARINT_MAX];
+	uint64_t previous = 0;
+
+	if (binfile_begin(file, BINFILE_GRAMS, BINFILE_VARINT_DELTA)) {
+		return 1;
+	}
+	for (size_t first = 0; first < size; first += BINFILE_CHUNK) {
+		size_t len = size - first < BINFILE_CHUNK ? size - first : BINFILE_CHUNK, bytes = 0;
+
+		for (size_t i = first; i < first + len; ++i) {
+			uint64_t delta = codes[i] - previous;
+
+			while (delta >= 0x80) {
+				chunk[bytes++] = (uint8_t)(delta | 0x80);
+				delta >>= 7;
+			}
+			chunk[bytes++] = (uint8_t)delta;
+			previous = codes[i];
+		}
+		if (binfile_write(file, chunk, bytes)) {
+			return 1;
+		}
+	}
+	file->header.num_of_grams = size;
+	return 0;
+}
+
+/**
+ * \brief 	    write the section of the grams of more than 64 bits
+ * \note 	    the codes are written raw, as pairs of high and low words.
+ * \param[in] 	file: synthesis file
+ * \param[in] 	codes: 2*size words, distinct packed grams, ascending
+ * \param[in] 	size: num of grams
+ * \return 		0: any error.
+ *              1: write error.
+ */
+int
+binfile_write_wide_grams(binfile_t* file, const uint64_t* codes, size_t size)
+{
+	if (binfile_begin(file, BINFILE_GRAMS_WIDE, BINFILE_RAW) ||
+		binfile_write(file, codes, 2 * size * sizeof (uint64_t))) {
+		return 1;
+	}
+	file->header.num_of_grams = size;
+	return 0;
+}
+
+/**
+ * \brief 	    write the header and the table of the sections
+ * \param[in] 	file: synthesis file
+ * \param[in] 	total: num of grams of the image
+ * \return 		0: any error.
+ *              1: write error.
+ */
+int
+binfile_finish(binfile_t* file, uint64_t total)
+{
+	file->header.total = total;
+	if (fflush(file->fp) != 0 || fseek(file->fp, 0, SEEK_SET) != 0 ||
+		fwrite(&file->header, sizeof (binfile_header_t), 1, file->fp) != 1 ||
+		fwrite(file->sections, sizeof (binfile_section_t), BINFILE_SECTIONS, file->fp) != BINFILE_SECTIONS ||
+		fseek(file->fp, 0, SEEK_END) != 0) {
+		return 1;
+	}
+	TRACE_COUNT(TRACE_BYTES_WRITTEN, sizeof (binfile_header_t) + BINFILE_SECTIONS * sizeof (binfile_section_t));
+	return 0;
+}
+
+/**
+ * \brief 	    map a synthesis file for reading
+ * \note 	    the sections are not copied: binfile_section points in the mapping.
+ * \param[out] 	file: synthesis file
+ * \param[in] 	path: synthesis file path
+ * \return 		BINFILE_OK: any error.
+ *              BINFILE_NOT_FOUND: the file can not be opened.
+ *              BINFILE_FORMAT_ERROR: wrong or truncated file.
+ *              BINFILE_VERSION_1: the file has no magic.
+ */
+int
+binfile_open(binfile_t* file, const char* path)
+{
+	int fd = open(path, O_RDONLY);
+	struct stat info;
+	const size_t table_end = sizeof (binfile_header_t) + BINFILE_SECTIONS * sizeof (binfile_section_t);
+
+	memset(file, 0, sizeof (binfile_t));
+	if (fd < 0) {
+		return BINFILE_NOT_FOUND;
+	}
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return BINFILE_NOT_FOUND;
+	}
+	if ((size_t)info.st_size < table_end) {
+		char magic[4] = {0};
+		bool v2 = pread(fd, magic, 4, 0) == 4 && memcmp(magic, BINFILE_MAGIC, 4) == 0;
+
+		close(fd);
+		return v2 ? BINFILE_FORMAT_ERROR : BINFILE_VERSION_1;
+	}
+	file->map_size = (size_t)info.st_size;
+	file->map = mmap(NULL, file->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (file->map == MAP_FAILED) {
+		file->map = NULL;
+		return BINFILE_NOT_FOUND;
+	}
+
+	memcpy(&file->header, file->map, sizeof (binfile_header_t));
+	memcpy(file->sections, (const uint8_t*)file->map + sizeof (binfile_header_t), sizeof (file->sections));
+	if (memcmp(file->header.magic, BINFILE_MAGIC, 4) != 0) {
+		binfile_close(file);
+		return BINFILE_VERSION_1;
+	}
+	if (file->header.version != BINFILE_VERSION || file->header.endianness != BINFILE_ENDIANNESS ||
+		file->header.num_of_sections > BINFILE_SECTIONS) {
+		binfile_close(file);
+		return BINFILE_FORMAT_ERROR;
+	}
+	for (uint32_t i = 0; i < file->header.num_of_sections; ++i) {
+		const binfile_section_t* section = &file->sections[i];
+
+		if (section->offset % BINFILE_ALIGNMENT != 0 || section->offset < table_end ||
+			section->offset > file->map_size || section->size > file->map_size - section->offset) {
+			binfile_close(file);
+			return BINFILE_FORMAT_ERROR;
+		}
+	}
+	return BINFILE_OK;
+}
+
+/**
+ * \brief 	    find a section of a mapped synthesis file
+ * \param[in] 	file: synthesis file
+ * \param[in] 	id: id of the section
+ * \param[out] 	size: bytes of the section, can be NULL
+ * \return 		first byte of the section in the mapping, NULL if it is missing.
+ */
+const void*
+binfile_section(const binfile_t* file, uint32_t id, uint64_t* size)
+{
+	for (uint32_t i = 0; i < file->header.num_of_sections; ++i) {
+		if (file->sections[i].id == id) {
+			if (size != NULL) {
+				*size = file->sections[i].size;
+			}
+			return (const uint8_t*)file->map + file->sections[i].offset;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief 	    decode the grams of a mapped synthesis file
+ * \param[in] 	file: synthesis file
+ * \param[out] 	codes: packed grams, ascending
+ * \param[in] 	capacity: max num of grams
+ * \return 		num of decoded grams, less than num_of_grams if the section is wrong.
+ */
+size_t
+binfile_decode_grams(const binfile_t* file, uint64_t* codes, size_t capacity)
+{
+	uint64_t size = 0, previous = 0, position = 0;
+	const uint8_t* bytes = binfile_section(file, BINFILE_GRAMS, &size);
+	size_t count = 0;
+
+	for (uint32_t i = 0; i < file->header.num_of_sections; ++i) {
+		if (file->sections[i].id == BINFILE_GRAMS && file->sections[i].encoding != BINFILE_VARINT_DELTA) {
+			return 0;
+		}
+	}
+	if (bytes == NULL) {
+		return 0;
+	}
+	while (count < capacity && count < file->header.num_of_grams && position < size) {
+		uint64_t delta = 0;
+		uint32_t shift = 0;
+
+		for (;;) {
+			uint8_t byte;
+
+			if (position == size || shift > 63) {
+				return count;
+			}
+			byte = bytes[position++];
+			delta |= (uint64_t)(byte & 0x7f) << shift;
+			shift += 7;
+			if (!(byte & 0x80)) {
+				break;
+			}
+		}
+		/* the grams are distinct and ascending */
+		if ((count > 0 && delta == 0) || previous + delta < previous) {
+			return count;
+		}
+		previous += delta;
+		codes[count++] = previous;
+	}
+	return count;
+}
+
+/**
+ * \brief 	    unmap a synthesis file
+ * \param[in] 	file: synthesis file
+ */
+void
+binfile_close(binfile_t* file)
+{
+	if (file->map != NULL) {
+		munmap(file->map, file->map_size);
+	}
+	file->map = NULL;
+	file->map_size = 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * \file            binfile.h
+ * \brief           Synthesis file, version 2
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of binfile.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+#ifndef BINFILE_H
+#define BINFILE_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define BINFILE_MAGIC ("SYNB") /* first bytes of a synthesis file */
+#define BINFILE_VERSION 2 /* version of the format */
+#define BINFILE_ENDIANNESS 0x0102 /* written in the byte order of the writer */
+#define BINFILE_ALIGNMENT 8 /* alignment of the sections */
+
+#define BINFILE_GRAMS 1 /* section of the packed grams, ascending, varint-delta encoded */
+#define BINFILE_COUNTS 2 /* section of the uint32 recurrences of the grams */
+#define BINFILE_MAP 3 /* section of the float recurrence map, optional */
+#define BINFILE_BITBOARD 4 /* section of the uint8 bitboard, or the layers of the pixels, optional */
+#define BINFILE_GRAMS_WIDE 5 /* section of the 128 bits packed grams, ascending, high and low uint64 words */
+#define BINFILE_SECTIONS 4 /* max num of sections */
+
+#define BINFILE_RAW 0 /* encoding of an array in the byte order of the writer */
+#define BINFILE_VARINT_DELTA 1 /* encoding of the differences of an ascending array in LEB128 */
+
+#define BINFILE_OK 0 /* synthesis file read */
+#define BINFILE_NOT_FOUND 1 /* the file can not be opened */
+#define BINFILE_FORMAT_ERROR 2 /* wrong or truncated synthesis file */
+#define BINFILE_VERSION_1 3 /* the file has no magic, as the synthesis files of version 1 */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		binfile_header_t
+ * \note		First bytes of a synthesis file, followed by the table of the sections.
+ *              The first pixel of a gram is the most significant bit of its code.
+*/
+typedef struct
+{
+	char 		magic[4]; 		    /*!< BINFILE_MAGIC */
+	uint16_t 	version; 		    /*!< BINFILE_VERSION */
+	uint16_t 	endianness; 	    /*!< BINFILE_ENDIANNESS */
+	int32_t 	model; 			    /*!< model of the synthesis */
+	int32_t 	gram_size; 		    /*!< side of the grams */
+	int32_t 	parameters[2]; 	    /*!< other parameters of the model, 0 if unused: the num of layers of the model 1 */
+	int32_t 	width; 			    /*!< width of the image */
+	int32_t 	height; 		    /*!< height of the image */
+	uint64_t 	num_of_grams; 	    /*!< num of distinct grams */
+	uint64_t 	total; 			    /*!< num of grams of the image */
+	uint32_t 	num_of_sections; 	/*!< num of entries of the table */
+	uint32_t 	reserved; 		    /*!< 0 */
+} binfile_header_t;
+
+/**
+ * \brief 		binfile_section_t
+ * \note		Entry of the table of the sections. A reader skips the sections it does
+ *              not know, every section starts at a multiple of BINFILE_ALIGNMENT.
+*/
+typedef struct
+{
+	uint32_t 	id; 		/*!< BINFILE_GRAMS, BINFILE_COUNTS, BINFILE_MAP, BINFILE_BITBOARD or BINFILE_GRAMS_WIDE */
+	uint32_t 	encoding; 	/*!< BINFILE_RAW or BINFILE_VARINT_DELTA */
+	uint64_t 	offset; 	/*!< first byte of the section in the file */
+	uint64_t 	size; 		/*!< bytes of the section */
+} binfile_section_t;
+
+/**
+ * \brief 		binfile_t
+ * \note		Synthesis file open for writing or mapped for reading.
+*/
+typedef struct
+{
+	FILE* 				fp; 		                    /*!< file being written */
+	uint64_t 			position; 	                    /*!< bytes written */
+	void* 				map; 		                    /*!< mapping of the file being read */
+	size_t 				map_size; 	                    /*!< bytes of the mapping */
+	binfile_header_t 	header; 	                    /*!< header */
+	binfile_section_t 	sections[BINFILE_SECTIONS]; 	/*!< table of the sections */
+} binfile_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 		binfile_create(binfile_t*, FILE*, int32_t, int32_t, int32_t, int32_t);
+int 		binfile_begin(binfile_t*, uint32_t, uint32_t);
+int 		binfile_write(binfile_t*, const void*, size_t);
+int 		binfile_write_grams(binfile_t*, const uint64_t*, size_t);
+int 		binfile_write_wide_grams(binfile_t*, const uint64_t*, size_t);
+int 		binfile_finish(binfile_t*, uint64_t);
+int 		binfile_open(binfile_t*, const char*);
+const void* binfile_section(const binfile_t*, uint32_t, uint64_t*);
+size_t 		binfile_decode_grams(const binfile_t*, uint64_t*, size_t);
+void 		binfile_close(binfile_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,105 @@
+/**
+ * \file 		bitboard.c
+ * \brief 		define bitboard_shape, bitboard_alloc, bitboard_unpack, bitboard_free
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of bitboard.
+ *
+ * Author: 		Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "bitboard.h"
+#include "trace.h"
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    set the shape of a bitboard_t, without allocating its words
+ * \param[in] 	board: bitboard
+ * \param[in] 	width: width of the image
+ * \param[in] 	height: height of the image
+ * \return 		num of words of the bitboard.
+ */
+size_t
+bitboard_shape(bitboard_t* board, int32_t width, int32_t height)
+{
+	board->width = width;
+	board->height = height;
+	board->stride = ((size_t)width + 63) / 64 + 1;
+	return board->stride * (size_t)(height > 0 ? height : 1);
+}
+
+/**
+ * \brief 	    allocation of a bitboard_t, all pixels are 0
+ * \param[in] 	board: bitboard to allocate
+ * \param[in] 	width: width of the image
+ * \param[in] 	height: height of the image
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+bitboard_alloc(bitboard_t* board, int32_t width, int32_t height)
+{
+	board->words = calloc(bitboard_shape(board, width, height), sizeof (uint64_t));
+	TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+	return board->words == NULL;
+}
+
+/**
+ * \brief 	    unpack a row of the bitboard
+ * \param[in] 	board: bitboard
+ * \param[in] 	raw: index of the row
+ * \param[out] 	dest: width bytes, one (0 or 1) per pixel
+ */
+void
+bitboard_unpack(const bitboard_t* board, int32_t raw, uint8_t* dest)
+{
+	const uint64_t* row = BITBOARD_ROW(board, raw);
+
+	for (int32_t col = 0; col < board->width; ++col)
+		dest[col] = BITBOARD_GET(row, col);
+}
+
+/**
+ * \brief 	    free bitboard
+ * \param[in] 	board: bitboard to free
+ */
+void
+bitboard_free(bitboard_t* board)
+{
+	free(board->words);
+	board->words = NULL;
+}
@@ -0,0 +1,110 @@
+/**
+ * \file            bitboard.h
+ * \brief           Packed black and white images
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of bitboard.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+/**
+ * \brief 			row of a bitboard
+ * \param[in]       board: reference to bitboard_t
+ * \param[in]       raw: index of the row
+ * \hideinitializer
+ */
+#define BITBOARD_ROW(board, raw) ((board)->words + (size_t)(raw)*(board)->stride)
+
+/**
+ * \brief 			pixel of a row
+ * \param[in]       row: row of a bitboard
+ * \param[in]       col: index of the column
+ * \hideinitializer
+ */
+#define BITBOARD_GET(row, col) ((uint8_t)(((row)[(col) >> 6] >> (63 - ((col) & 63))) & 1))
+
+/**
+ * \brief 			64 pixels of a row, the first one is the most significant bit
+ * \note 			the padding of the rows allows reading after the last pixel.
+ * \param[in]       row: row of a bitboard
+ * \param[in]       col: index of the first column
+ * \hideinitializer
+ */
+#define BITBOARD_WORD(row, col) 												\
+	(((col) & 63) ? 															\
+		((row)[(col) >> 6] << ((col) & 63)) | ((row)[((col) >> 6) + 1] >> (64 - ((col) & 63))) : 	\
+		(row)[(col) >> 6])
+
+
+/***********************/
+/*!< types definitions */
+/***********************/
+
+/**
+ * \brief 		bitboard_t
+ * \note		Black and white image, 64 pixels per word in row-major order.
+ *              In a word the first pixel is the most significant bit.
+ *              Each row has a word of padding after the last pixel.
+*/
+typedef struct
+{
+	uint64_t* 	words; 			/*!< pixels */
+	size_t 		stride; 		/*!< num of words of a row */
+	int32_t 	width, height; 	/*!< image shape */
+} bitboard_t;
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+size_t 	bitboard_shape(bitboard_t*, int32_t, int32_t);
+int 	bitboard_alloc(bitboard_t*, int32_t, int32_t);
+void 	bitboard_unpack(const bitboard_t*, int32_t, uint8_t*);
+void 	bitboard_free(bitboard_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,565 @@
+/**
+ * \file 		cache.c
+ * \brief 		define cache_parameters, cache_hash, cache_load, cache_current, cache_match, cache_lookup,
+ *              cache_record, cache_save, cache_free
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of cache.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#define _POSIX_C_SOURCE 200809L  // st_mtim, posix_fadvise
+#include "cache.h"
+#include "binarize.h"
+#include "binfile.h"
+#include "trace.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define CACHE_CHUNK 65536 /* bytes read at once */
+#define CACHE_LINE (FILENAME_MAX + 128) /* max length of a line of the manifest */
+#define CACHE_MIN_SLOTS 64 /* initial num of slots of the index */
+#define CACHE_PRIME_1 UINT64_C(0x9E3779B185EBCA87) /* multipliers of the content hash */
+#define CACHE_PRIME_2 UINT64_C(0xC2B2AE3D27D4EB4F)
+#define CACHE_PRIME_3 UINT64_C(0x165667B19E3779F9)
+#define rotl(x, r) (((x) << (r)) | ((x) >> (64 - (r)))) /* rotation to the left */
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 		cache_copy(const char*, const char*, uint64_t);
+uint64_t 	cache_path_hash(const char*);
+int64_t 	cache_find(const cache_t*, const char*);
+int 		cache_index(cache_t*, size_t);
+int 		cache_insert(cache_t*, const char*);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    signature of the parameters of the synthesis
+ * \note 	    a synthesis file is current only if it was made with the same parameters:
+ *              version of the file, model, other parameters of the model, method of the
+ *              binarization and side of the grams.
+ * \param[in] 	model: model of the synthesis
+ * \param[in] 	gram_size: side of the grams
+ * \param[in] 	parameters: 2 other parameters of the model, as in the header of the synthesis
+ *              file, up to 1023 and 16383; NULL if unused
+ * \return 		the signature.
+ */
+uint64_t
+cache_parameters(int32_t model, int32_t gram_size, const int32_t* parameters)
+{
+	uint64_t signature = (uint64_t)BINFILE_VERSION << 48 | (uint64_t)model << 44 |
+						 (uint64_t)BINARIZE_METHOD << 16 | (uint64_t)gram_size;
+
+	if (parameters != NULL) {
+		signature |= (uint64_t)(parameters[0] & 0x3ff) << 34 | (uint64_t)(parameters[1] & 0x3fff) << 20;
+	}
+	return signature;
+}
+
+/**
+ * \brief 	    hash of the content of a file
+ * \note 	    the words of the file are mixed in four lanes, as xxHash64 does, so the
+ *              hash runs at the speed of the reads. The words are read in the byte order of
+ *              the host, so the manifest is not shared between hosts of different endianness.
+ *              The file is read whole: the kernel is asked to read it ahead at once.
+ * \param[in] 	path: path of the file
+ * \param[out] 	key: hash of the content
+ * \return 		0: any error.
+ *              1: the file can not be read.
+ */
+int
+cache_hash(const char* path, uint64_t* key)
+{
+	uint64_t lanes[4] = {CACHE_PRIME_1 + CACHE_PRIME_2, CACHE_PRIME_2, 0, -CACHE_PRIME_1};
+	uint64_t words[CACHE_CHUNK / sizeof (uint64_t)];
+	uint64_t length = 0, hash;
+	FILE* fp = fopen(path, "rb");
+	size_t read;
+
+	if (fp == NULL) {
+		return 1;
+	}
+	posix_fadvise(fileno(fp), 0, 0, POSIX_FADV_WILLNEED);
+	do {
+		read = fread(words, 1, CACHE_CHUNK, fp);
+		length += read;
+		TRACE_COUNT(TRACE_BYTES_READ, read);
+
+		/* the last chunk is padded with zeros to a multiple of the four lanes */
+		if (read % (4 * sizeof (uint64_t))) {
+			size_t padded = read + 4 * sizeof (uint64_t) - read % (4 * sizeof (uint64_t));
+			memset((uint8_t*)words + read, 0, padded - read);
+			read = padded;
+		}
+		for (size_t i = 0; i < read / sizeof (uint64_t); i += 4) {
+			for (int lane = 0; lane < 4; ++lane) {
+				lanes[lane] += words[i + lane] * CACHE_PRIME_2;
+				lanes[lane] = rotl(lanes[lane], 31) * CACHE_PRIME_1;
+			}
+		}
+	} while (read == CACHE_CHUNK);
+	if (ferror(fp)) {
+		fclose(fp);
+		return 1;
+	}
+	fclose(fp);
+
+	/* the length tells apart the files ending with zeros */
+	hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+	hash ^= length * CACHE_PRIME_1;
+	hash ^= hash >> 33;
+	hash *= CACHE_PRIME_2;
+	hash ^= hash >> 29;
+	hash *= CACHE_PRIME_3;
+	hash ^= hash >> 32;
+	*key = hash;
+	return 0;
+}
+
+/**
+ * \brief 	    copy a synthesis file
+ * \param[in] 	source: path of the synthesis file
+ * \param[in] 	destination: path of the copy
+ * \param[in] 	size: bytes of the synthesis file
+ * \return 		0: any error.
+ *              1: the file is not of the expected size or can not be copied.
+ */
+int
+cache_copy(const char* source, const char* destination, uint64_t size)
+{
+	uint8_t buffer[CACHE_CHUNK];
+	FILE *in = fopen(source, "rb"), *out;
+	uint64_t copied = 0;
+	size_t read;
+	int output;
+
+	if (in == NULL) {
+		return 1;
+	}
+	out = fopen(destination, "wb");
+	if (out == NULL) {
+		fclose(in);
+		return 1;
+	}
+	while ((read = fread(buffer, 1, CACHE_CHUNK, in)) > 0 && fwrite(buffer, 1, read, out) == read)
+		copied += read;
+	TRACE_COUNT(TRACE_BYTES_READ, copied);
+	TRACE_COUNT(TRACE_BYTES_WRITTEN, copied);
+	output = ferror(in) || ferror(out) || copied != size;
+	fclose(in);
+	return fclose(out) != 0 || output;
+}
+
+/**
+ * \brief 	    hash of the path of a synthesis file (FNV-1a)
+ * \param[in] 	path: path of the synthesis file
+ * \return 		the hash.
+ */
+uint64_t
+cache_path_hash(const char* path)
+{
+	uint64_t hash = UINT64_C(0xCBF29CE484222325);
+
+	for (; *path; ++path)
+		hash = (hash ^ (uint8_t)*path) * UINT64_C(0x100000001B3);
+	return hash;
+}
+
+/**
+ * \brief 	    entry of a synthesis file
+ * \note 	    the slots are probed linearly from the hash of the path, so a lookup
+ *              compares a few paths whatever the num of entries.
+ * \param[in] 	cache: cache
+ * \param[in] 	output: path of the synthesis file
+ * \return 		index of the entry, -1 if missing.
+ */
+int64_t
+cache_find(const cache_t* cache, const char* output)
+{
+	size_t slot;
+
+	if (cache->num_of_slots == 0) {
+		return -1;
+	}
+	slot = cache_path_hash(output) & (cache->num_of_slots - 1);
+	while (cache->slots[slot] >= 0) {
+		if (strcmp(cache->entries[cache->slots[slot]].output, output) == 0) {
+			return cache->slots[slot];
+		}
+		slot = (slot + 1) & (cache->num_of_slots - 1);
+	}
+	return -1;
+}
+
+/**
+ * \brief 	    rebuild the index of the entries
+ * \param[in] 	cache: cache
+ * \param[in] 	num_of_slots: num of slots, power of 2 greater than the num of entries
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+cache_index(cache_t* cache, size_t num_of_slots)
+{
+	int64_t* slots = malloc(num_of_slots * sizeof (int64_t));
+
+	if (slots == NULL) {
+		return 1;
+	}
+	for (size_t slot = 0; slot < num_of_slots; ++slot)
+		slots[slot] = -1;
+	for (size_t i = 0; i < cache->size; ++i) {
+		size_t slot = cache_path_hash(cache->entries[i].output) & (num_of_slots - 1);
+
+		while (slots[slot] >= 0)
+			slot = (slot + 1) & (num_of_slots - 1);
+		slots[slot] = (int64_t)i;
+	}
+	free(cache->slots);
+	cache->slots = slots;
+	cache->num_of_slots = num_of_slots;
+	return 0;
+}
+
+/**
+ * \brief 	    append an entry
+ * \note 	    the index doubles its slots when it is half full.
+ * \param[in] 	cache: cache
+ * \param[in] 	output: path of the synthesis file, not in the cache
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+cache_insert(cache_t* cache, const char* output)
+{
+	cache_entry_t* entry;
+	size_t slot;
+
+	if (cache->size == cache->capacity) {
+		size_t capacity = cache->capacity ? 2 * cache->capacity : 64;
+		cache_entry_t* entries = realloc(cache->entries, capacity * sizeof (cache_entry_t));
+
+		if (entries == NULL) {
+			return 1;
+		}
+		cache->entries = entries;
+		cache->capacity = capacity;
+	}
+	if (2*(cache->size + 1) > cache->num_of_slots &&
+		cache_index(cache, cache->num_of_slots ? 2 * cache->num_of_slots : CACHE_MIN_SLOTS)) {
+		return 1;
+	}
+	entry = &cache->entries[cache->size];
+	memset(entry, 0, sizeof (cache_entry_t));
+	entry->output = malloc(strlen(output) + 1);
+	if (entry->output == NULL) {
+		return 1;
+	}
+	strcpy(entry->output, output);
+	slot = cache_path_hash(output) & (cache->num_of_slots - 1);
+	while (cache->slots[slot] >= 0)
+		slot = (slot + 1) & (cache->num_of_slots - 1);
+	cache->slots[slot] = (int64_t)cache->size;
+	++cache->size;
+	return 0;
+}
+
+/**
+ * \brief 	    load a manifest
+ * \note 	    each line of the manifest is an entry: hexadecimal key and parameters,
+ *              size and modification time of the image, size and path of the synthesis file.
+ *              A missing manifest is an empty cache, the malformed lines are ignored.
+ * \param[out] 	cache: cache, to free with cache_free
+ * \param[in] 	path: path of the manifest
+ * \param[in] 	parameters: signature of the parameters of this run, by cache_parameters
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+cache_load(cache_t* cache, const char* path, uint64_t parameters)
+{
+	char line[CACHE_LINE], output[CACHE_LINE];
+	cache_entry_t entry;
+	FILE* fp;
+	int64_t i;
+
+	memset(cache, 0, sizeof (cache_t));
+	pthread_mutex_init(&cache->mutex, NULL);
+	cache->parameters = parameters;
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		return 0;
+	}
+	while (fgets(line, CACHE_LINE, fp) != NULL) {
+		if (sscanf(line, "%" SCNx64 " %" SCNx64 " %" SCNu64 " %" SCNd64 " %" SCNu64 " %s",
+			&entry.key, &entry.parameters, &entry.size, &entry.mtime, &entry.output_size, output) != 6) {
+			continue;
+		}
+		i = cache_find(cache, output);
+		if (i < 0) {
+			if (cache_insert(cache, output)) {
+				fclose(fp);
+				return 1;
+			}
+			i = (int64_t)cache->size - 1;
+		}
+		entry.output = cache->entries[i].output;
+		entry.used = false;
+		cache->entries[i] = entry;
+	}
+	fclose(fp);
+	return 0;
+}
+
+/**
+ * \brief 	    check that a synthesis file is current, without reading the image
+ * \note 	    the synthesis file is current if the image has the size and the modification
+ *              time of the entry, and the synthesis file the size of the entry.
+ * \param[in] 	cache: cache
+ * \param[in] 	input: path of the image
+ * \param[in] 	output: path of the synthesis file
+ * \return 		CACHE_HIT or CACHE_MISS.
+ */
+int
+cache_current(cache_t* cache, const char* input, const char* output)
+{
+	struct stat image, synthesis;
+	int64_t i;
+	int current = CACHE_MISS;
+
+	if (stat(input, &image) != 0 || stat(output, &synthesis) != 0) {
+		return CACHE_MISS;
+	}
+	pthread_mutex_lock(&cache->mutex);
+	i = cache_find(cache, output);
+	if (i >= 0) {
+		cache_entry_t* entry = &cache->entries[i];
+
+		if (entry->parameters == cache->parameters && entry->size == (uint64_t)image.st_size &&
+			entry->mtime == (int64_t)image.st_mtim.tv_sec * 1000000000 + image.st_mtim.tv_nsec &&
+			entry->output_size == (uint64_t)synthesis.st_size) {
+			entry->used = true;
+			current = CACHE_HIT;
+		}
+	}
+	pthread_mutex_unlock(&cache->mutex);
+	return current;
+}
+
+/**
+ * \brief 	    check that a synthesis file is current by the hash of the image
+ * \note 	    if the entry of the synthesis file has the hash of the image, the synthesis
+ *              file is current; else if a synthesis file of this run has it, it is copied.
+ *              A synthesis file found is recorded.
+ * \param[in] 	cache: cache
+ * \param[in] 	input: path of the image
+ * \param[in] 	output: path of the synthesis file
+ * \param[in] 	key: hash of the image, by cache_hash
+ * \return 		CACHE_HIT or CACHE_MISS.
+ */
+int
+cache_match(cache_t* cache, const char* input, const char* output, uint64_t key)
+{
+	struct stat synthesis;
+	char* source = NULL;
+	uint64_t parameters = cache->parameters, size = 0;
+	int found = CACHE_MISS;
+
+	pthread_mutex_lock(&cache->mutex);
+	{
+		int64_t i = cache_find(cache, output);
+
+		if (i >= 0 && cache->entries[i].key == key && cache->entries[i].parameters == parameters &&
+			stat(output, &synthesis) == 0 && (uint64_t)synthesis.st_size == cache->entries[i].output_size) {
+			found = CACHE_HIT;
+		}
+		for (size_t j = 0; found == CACHE_MISS && source == NULL && j < cache->size; ++j) {
+			const cache_entry_t* entry = &cache->entries[j];
+
+			/* only the entries of this run are sure to be current */
+			if (entry->used && entry->key == key && entry->parameters == parameters &&
+				strcmp(entry->output, output) != 0) {
+				source = malloc(strlen(entry->output) + 1);
+				if (source != NULL) {
+					strcpy(source, entry->output);
+					size = entry->output_size;
+				}
+			}
+		}
+	}
+	pthread_mutex_unlock(&cache->mutex);
+
+	if (source != NULL) {
+		found = cache_copy(source, output, size) ? CACHE_MISS : CACHE_HIT;
+		free(source);
+	}
+	if (found == CACHE_HIT && cache_record(cache, input, output, key)) {
+		found = CACHE_MISS;
+	}
+	return found;
+}
+
+/**
+ * \brief 	    check that a synthesis file is current by the content of the image
+ * \note 	    the image is hashed, then matched as cache_match does.
+ * \param[in] 	cache: cache
+ * \param[in] 	input: path of the image
+ * \param[in] 	output: path of the synthesis file
+ * \param[out] 	key: hash of the image, to record the synthesis file on a miss
+ * \return 		CACHE_HIT or CACHE_MISS.
+ */
+int
+cache_lookup(cache_t* cache, const char* input, const char* output, uint64_t* key)
+{
+	if (cache_hash(input, key)) {
+		*key = 0;
+		return CACHE_MISS;
+	}
+	return cache_match(cache, input, output, *key);
+}
+
+/**
+ * \brief 	    record a synthesis file
+ * \param[in] 	cache: cache
+ * \param[in] 	input: path of the image
+ * \param[in] 	output: path of the synthesis file
+ * \param[in] 	key: hash of the image
+ * \return 		0: any error.
+ *              1: out of memory, or the files can not be read.
+ */
+int
+cache_record(cache_t* cache, const char* input, const char* output, uint64_t key)
+{
+	struct stat image, synthesis;
+	int64_t i;
+	int output_code = 0;
+
+	if (stat(input, &image) != 0 || stat(output, &synthesis) != 0) {
+		return 1;
+	}
+	pthread_mutex_lock(&cache->mutex);
+	i = cache_find(cache, output);
+	if (i < 0 && cache_insert(cache, output) == 0) {
+		i = (int64_t)cache->size - 1;
+	}
+	if (i >= 0) {
+		cache_entry_t* entry = &cache->entries[i];
+
+		entry->key = key;
+		entry->parameters = cache->parameters;
+		entry->size = (uint64_t)image.st_size;
+		entry->mtime = (int64_t)image.st_mtim.tv_sec * 1000000000 + image.st_mtim.tv_nsec;
+		entry->output_size = (uint64_t)synthesis.st_size;
+		entry->used = true;
+	} else {
+		output_code = 1;
+	}
+	pthread_mutex_unlock(&cache->mutex);
+	return output_code;
+}
+
+/**
+ * \brief 	    save the manifest
+ * \note 	    only the entries of this run are saved, so the works removed from the set
+ *              leave the manifest. The manifest is written aside and renamed, so an
+ *              interrupted run leaves the previous one.
+ * \param[in] 	cache: cache
+ * \param[in] 	path: path of the manifest
+ * \return 		0: any error.
+ *              1: the manifest can not be written.
+ */
+int
+cache_save(cache_t* cache, const char* path)
+{
+	char temporary[FILENAME_MAX];
+	FILE* fp;
+	int output = 0;
+
+	if (strlen(path) + 5 > FILENAME_MAX) {
+		return 1;
+	}
+	strcpy(temporary, path);
+	strcat(temporary, ".tmp");
+	fp = fopen(temporary, "w");
+	if (fp == NULL) {
+		return 1;
+	}
+	pthread_mutex_lock(&cache->mutex);
+	for (size_t i = 0; i < cache->size && !output; ++i) {
+		const cache_entry_t* entry = &cache->entries[i];
+
+		if (entry->used) {
+			output = fprintf(fp, "%016" PRIx64 " %016" PRIx64 " %" PRIu64 " %" PRId64 " %" PRIu64 " %s\n",
+				entry->key, entry->parameters, entry->size, entry->mtime, entry->output_size, entry->output) < 0;
+		}
+	}
+	pthread_mutex_unlock(&cache->mutex);
+	if (fclose(fp) != 0 || output || rename(temporary, path) != 0) {
+		remove(temporary);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * \brief 	    free a cache
+ * \param[in] 	cache: cache
+ */
+void
+cache_free(cache_t* cache)
+{
+	for (size_t i = 0; i < cache->size; ++i)
+		free(cache->entries[i].output);
+	free(cache->entries);
+	free(cache->slots);
+	pthread_mutex_destroy(&cache->mutex);
+	memset(cache, 0, sizeof (cache_t));
+}
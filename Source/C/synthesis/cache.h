@@ -0,0 +1,112 @@
+/**
+ * \file            cache.h
+ * \brief           Content-addressed cache of the syntheses
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of cache.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+#ifndef CACHE_H
+#define CACHE_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define CACHE_MANIFEST ("manifest.txt") /* manifest in the synthesis folder */
+#define CACHE_MISS 0 /* the synthesis has to be done */
+#define CACHE_HIT 1 /* the synthesis file is current */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		cache_entry_t
+ * \note		A synthesis file and the image it was made from.
+*/
+typedef struct
+{
+	char* 		output; 		/*!< path of the synthesis file */
+	uint64_t 	key; 			/*!< hash of the content of the image */
+	uint64_t 	parameters; 	/*!< signature of the parameters of the synthesis */
+	uint64_t 	size; 			/*!< bytes of the image */
+	int64_t 	mtime; 			/*!< modification time of the image, in ns */
+	uint64_t 	output_size; 	/*!< bytes of the synthesis file */
+	bool 		used; 			/*!< recorded by this run, so saved in the manifest */
+} cache_entry_t;
+
+/**
+ * \brief 		cache_t
+ * \note		Entries of a manifest, shared by the workers. The entries are found by
+ *              the path of their synthesis file in an open addressing table.
+*/
+typedef struct
+{
+	cache_entry_t* 	    entries; 	/*!< entries */
+	size_t 			    size; 		/*!< num of entries */
+	size_t 			    capacity; 	/*!< allocated entries */
+	int64_t* 		    slots; 		/*!< index of the entries by path of the synthesis file, -1 if empty */
+	size_t 			    num_of_slots; /*!< num of slots, power of 2 */
+	uint64_t 		    parameters; /*!< signature of the parameters of this run */
+	pthread_mutex_t 	mutex; 		/*!< mutex of the entries */
+} cache_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+uint64_t 	cache_parameters(int32_t, int32_t, const int32_t*);
+int 		cache_hash(const char*, uint64_t*);
+int 		cache_load(cache_t*, const char*, uint64_t);
+int 		cache_current(cache_t*, const char*, const char*);
+int 		cache_match(cache_t*, const char*, const char*, uint64_t);
+int 		cache_lookup(cache_t*, const char*, const char*, uint64_t*);
+int 		cache_record(cache_t*, const char*, const char*, uint64_t);
+int 		cache_save(cache_t*, const char*);
+void 		cache_free(cache_t*);
+
+
+#endif /* guard */
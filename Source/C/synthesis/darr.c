@@ -1,6 +1,6 @@
 /**
  * \file 		darr.c
- * \brief 		define darr_alloc, darr_write, darr_free
+ * \brief 		define darr_alloc, darr_reserve, darr_write, darr_free
  */
 
 /*
@@ -38,28 +38,9 @@
 /**********************/
 
 #include "darr.h"
+#include "trace.h"
 #include <stdio.h>
-
-
-/***********************/
-/*!< MACRO definitions */
-/***********************/
-
-/**
- * \brief 			copy data
- * \param[in]       dest: destination reference
- * \param[in]       src: source reference
- * \param[in] 		size: num of byte
- * \hideinitializer
- */
-#define CPY(dest, src, size) 							\
-do { 													\
-	size_t __size = (size); 							\
-	char *__dest = (dest), *__src = (src); 				\
-	do { 												\
-		*__dest++ = *__src++; 							\
-	} while (--__size > 0); 							\
-} while (0)
+#include <string.h>
 
 
 /***************/
@@ -69,6 +50,7 @@ do { 													\
 const darr_t empty_vec = {
 	.array = NULL,
 	.size = 0,
+	.capacity = 0,
 };
 
 
@@ -78,22 +60,45 @@ const darr_t empty_vec = {
 
 /**
  * \brief 	    allocation of a darr_t.
- * \param[in] 	len: initial size
+ * \param[in] 	len: initial capacity
  * \param[out] 	dv: allocated darr_t
  */
 darr_t
 darr_alloc(size_t len)
 {
-	if (len == 0) {
-		return empty_vec;
-	} else {
-		register size_t size = ((len-(size_t)1) & (~(size_t)7)) + (size_t)8;
-		darr_t dv = {
-			.array = malloc(size*sizeof(char)),
-			.size = size,
-		};
-		return dv;
+	darr_t dv = empty_vec;
+
+	darr_reserve(&dv, len);
+	return dv;
+}
+
+/**
+ * \brief 	    reserve bytes in the darr_t
+ * \note 	    the capacity is at least doubled, so the cost of the writes is amortized.
+ * \param[in] 	dv: darr_t
+ * \param[in] 	len: min num of allocated bytes
+ * \return 		0: any error.
+ *              1: out of memory, the darr_t is unchanged.
+ */
+int
+darr_reserve(darr_t* dv, size_t len)
+{
+	size_t capacity = dv->capacity ? dv->capacity : 8;
+	void* array;
+
+	if (len <= dv->capacity) {
+		return 0;
 	}
+	while (capacity < len)
+		capacity <<= 1;
+	array = realloc(dv->array, capacity);
+	TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+	if (array == NULL) {
+		return 1;
+	}
+	dv->array = array;
+	dv->capacity = capacity;
+	return 0;
 }
 
 /**
@@ -102,23 +107,21 @@ darr_alloc(size_t len)
  * \param[in] 	data_len: num of bytes
  * \param[in] 	index: destination index
  * \param[in] 	dv: darr_t
+ * \return 		0: any error.
+ *              1: out of memory.
  */
 int
 darr_write(void* const data, size_t data_len, size_t index, darr_t * dv)
 {
 	size_t new_len = index + data_len;
 
-	while (dv->size && new_len > dv->size) {
-		dv->size <<= 2;
+	if (darr_reserve(dv, new_len)) {
+		return 1;
 	}
-	if (!(dv->size)) {
-		if (dv->array) {
-			return 1;
-		}
-		*dv = darr_alloc(new_len);
+	memcpy((char*)dv->array + index, data, data_len);
+	if (new_len > dv->size) {
+		dv->size = new_len;
 	}
-	dv->array = realloc(dv->array, dv->size);
-	CPY(dv->array + index, data, data_len);
 	return 0;
 }
 
@@ -54,8 +54,9 @@
 */
 typedef struct
 {
-	void* array; 	/*!< reference to data */
-	size_t size; 	/*!< num of allocated bytes */
+	void* array; 		/*!< reference to data */
+	size_t size; 		/*!< num of written bytes */
+	size_t capacity; 	/*!< num of allocated bytes */
 } darr_t;
 
 
@@ -66,6 +67,7 @@ typedef struct
 extern const darr_t empty_vec; 	/*!< empty darr_t */
 
 darr_t 	darr_alloc(size_t);
+int 	darr_reserve(darr_t*, size_t);
 int 	darr_write(void* const, size_t, size_t, darr_t*);
 void 	darr_free(darr_t);
 
@@ -0,0 +1,255 @@
+/**
+ * \file 		gram.c
+ * \brief 		define gram_kernel, gram_count, gram_encode, gram_decode
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of gram.
+ *
+ * Author: 		Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "gram.h"
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+/**
+ * \brief 			bits of a packed gram
+ * \param[in]       bits: num of bits of the gram
+ * \hideinitializer
+ */
+#define GRAM_MASK(bits) ((bits) == 64 ? ~UINT64_C(0) : (UINT64_C(1) << ((bits) % 64)) - 1)
+
+/**
+ * \brief 			define the kernel of a side
+ * \note 			the side is a constant, so the compiler unrolls the rows of the gram
+ *                  and folds the shifts and the mask.
+ * \param[in]       size: side of the grams
+ * \hideinitializer
+ */
+#define GRAM_DEFINE(size) 															\
+static uint64_t 																	\
+gram_at_##size(const gram_kernel_t* kernel, const bitboard_t* board, int32_t raw, int32_t col) 	\
+{ 																					\
+	(void)kernel; 																	\
+	return gram_at_size(board, raw, col, size); 									\
+} 																					\
+																					\
+static void 																		\
+gram_roll_##size(const gram_kernel_t* kernel, const uint64_t* row, const uint64_t* above, 	\
+	uint64_t* dest, size_t num_of_cols) 											\
+{ 																					\
+	(void)kernel; 																	\
+	gram_roll_size(row, above, dest, num_of_cols, size, GRAM_MASK(size*size)); 		\
+}
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+uint64_t 	gram_at_any(const gram_kernel_t*, const bitboard_t*, int32_t, int32_t);
+void 		gram_roll_any(const gram_kernel_t*, const uint64_t*, const uint64_t*, uint64_t*, size_t);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    packed gram of a position
+ * \param[in] 	board: bitboard
+ * \param[in] 	raw: row of the top left pixel
+ * \param[in] 	col: column of the top left pixel
+ * \param[in] 	size: side of the grams
+ * \return 		packed gram, the first pixel is the most significant bit.
+ */
+static inline uint64_t
+gram_at_size(const bitboard_t* board, int32_t raw, int32_t col, int32_t size)
+{
+	uint64_t code = 0;
+
+	for (int32_t r = 0; r < size; ++r)
+		code = (code << size) | (BITBOARD_WORD(BITBOARD_ROW(board, raw + r), col) >> (64 - size));
+	return code;
+}
+
+/**
+ * \brief 	    roll the codes of a row of grams by a row of pixels
+ * \note 	    the strip of 'size' bits of the row is read from the words of the
+ *              bitboard with a shift, then the code of a gram is the code of the gram
+ *              above shifted by a strip. 'dest' can be 'above'.
+ * \param[in] 	row: row of pixels
+ * \param[in] 	above: codes of the row of grams above
+ * \param[out] 	dest: codes of the row of grams
+ * \param[in] 	num_of_cols: num of grams of a row
+ * \param[in] 	size: side of the grams
+ * \param[in] 	mask: bits of a packed gram
+ */
+static inline void
+gram_roll_size(const uint64_t* row, const uint64_t* above, uint64_t* dest, size_t num_of_cols,
+	int32_t size, uint64_t mask)
+{
+	for (size_t col = 0; col < num_of_cols; ++col) {
+		uint64_t strip = BITBOARD_WORD(row, col) >> (64 - size);
+		dest[col] = ((above[col] << size) | strip) & mask;
+	}
+}
+
+GRAM_DEFINE(3)
+GRAM_DEFINE(4)
+GRAM_DEFINE(5)
+GRAM_DEFINE(6)
+GRAM_DEFINE(7)
+GRAM_DEFINE(8)
+
+/**
+ * \brief 	    packed gram of a position, generic side
+ * \param[in] 	kernel: kernel
+ * \param[in] 	board: bitboard
+ * \param[in] 	raw: row of the top left pixel
+ * \param[in] 	col: column of the top left pixel
+ * \return 		packed gram, the first pixel is the most significant bit.
+ */
+uint64_t
+gram_at_any(const gram_kernel_t* kernel, const bitboard_t* board, int32_t raw, int32_t col)
+{
+	return gram_at_size(board, raw, col, kernel->size);
+}
+
+/**
+ * \brief 	    roll the codes of a row of grams, generic side
+ * \param[in] 	kernel: kernel
+ * \param[in] 	row: row of pixels
+ * \param[in] 	above: codes of the row of grams above
+ * \param[out] 	dest: codes of the row of grams
+ * \param[in] 	num_of_cols: num of grams of a row
+ */
+void
+gram_roll_any(const gram_kernel_t* kernel, const uint64_t* row, const uint64_t* above, uint64_t* dest,
+	size_t num_of_cols)
+{
+	gram_roll_size(row, above, dest, num_of_cols, kernel->size, kernel->mask);
+}
+
+/**
+ * \brief 	    kernel of a side
+ * \note 	    dispatch table of the kernels, chosen once at startup.
+ * \param[in] 	size: side of the grams
+ * \return 		the kernel, NULL if the side is not in 1..GRAM_MAX_SIZE.
+ */
+const gram_kernel_t*
+gram_kernel(int32_t size)
+{
+	static const gram_kernel_t kernels[GRAM_MAX_SIZE] = {
+		{1, 1, GRAM_MASK(1), gram_at_any, gram_roll_any},
+		{2, 4, GRAM_MASK(4), gram_at_any, gram_roll_any},
+		{3, 9, GRAM_MASK(9), gram_at_3, gram_roll_3},
+		{4, 16, GRAM_MASK(16), gram_at_4, gram_roll_4},
+		{5, 25, GRAM_MASK(25), gram_at_5, gram_roll_5},
+		{6, 36, GRAM_MASK(36), gram_at_6, gram_roll_6},
+		{7, 49, GRAM_MASK(49), gram_at_7, gram_roll_7},
+		{8, 64, GRAM_MASK(64), gram_at_8, gram_roll_8}};
+
+	return size >= 1 && size <= GRAM_MAX_SIZE ? &kernels[size - 1] : NULL;
+}
+
+/**
+ * \brief 	    num of grams of an image
+ * \param[in] 	kernel: kernel
+ * \param[in] 	width: width of the image
+ * \param[in] 	height: height of the image
+ * \return 		num of positions where a gram fits inside the image.
+ */
+size_t
+gram_count(const gram_kernel_t* kernel, int32_t width, int32_t height)
+{
+	if (width < kernel->size || height < kernel->size) {
+		return 0;
+	}
+	return (size_t)(width - kernel->size + 1) * (size_t)(height - kernel->size + 1);
+}
+
+/**
+ * \brief 	    encode every gram of a bitboard
+ * \note 	    the first pixel of the gram is the most significant bit, so the
+ *              order of the codes is the same of the comparison function 'cmp'.
+ *              Grams are listed by rows, skipping the positions close the margin.
+ *              The codes are rolling, so the cost does not depend on the size of the grams.
+ * \param[in] 	kernel: kernel
+ * \param[in] 	board: bitboard
+ * \param[out] 	codes: gram_count(kernel, width, height) packed grams
+ * \param[out] 	positions: index of the top left pixel of each gram, can be NULL
+ */
+void
+gram_encode(const gram_kernel_t* kernel, const bitboard_t* board, uint64_t* codes, size_t* positions)
+{
+	int32_t size = kernel->size;
+	size_t num_of_cols = (size_t)(board->width - size + 1);
+
+	if (gram_count(kernel, board->width, board->height) == 0) {
+		return;
+	}
+
+	for (int32_t raw = 0; raw < board->height; ++raw) {
+		uint64_t* dest = codes + (raw < size ? 0 : (size_t)(raw - size + 1)*num_of_cols);
+		const uint64_t* above = dest - (raw < size ? 0 : num_of_cols);
+
+		/* the first rows are accumulated in the codes of the first grams */
+		if (raw == 0) {
+			for (size_t col = 0; col < num_of_cols; ++col)
+				dest[col] = 0;
+		}
+		kernel->roll(kernel, BITBOARD_ROW(board, raw), above, dest, num_of_cols);
+	}
+
+	if (positions != NULL) {
+		for (int32_t raw = 0; raw + size <= board->height; ++raw)
+			for (size_t col = 0; col < num_of_cols; ++col)
+				*positions++ = (size_t)raw*board->width + col;
+	}
+}
+
+/**
+ * \brief 	    decode a packed gram
+ * \param[in] 	kernel: kernel
+ * \param[in] 	code: packed gram
+ * \param[out] 	gram: kernel->bits bytes (0 or 1), by rows
+ */
+void
+gram_decode(const gram_kernel_t* kernel, uint64_t code, uint8_t* gram)
+{
+	for (int32_t i = 0; i < kernel->bits; ++i)
+		gram[i] = (uint8_t)((code >> (kernel->bits - 1 - i)) & 1);
+}
@@ -0,0 +1,86 @@
+/**
+ * \file            gram.h
+ * \brief           Packed codes of the grams
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of gram.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+#ifndef GRAM_H
+#define GRAM_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "bitboard.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define GRAM_MAX_SIZE 8 /* max side of a packed gram of 64 bits */
+
+
+/***********************/
+/*!< types definitions */
+/***********************/
+
+/**
+ * \brief 		gram_kernel_t
+ * \note		Packed grams of a side. The functions are specialized for the
+ *              sides from 3 to GRAM_MAX_SIZE, so the loops on the rows of a gram
+ *              are unrolled; the other sides use the generic ones.
+*/
+typedef struct gram_kernel
+{
+	int32_t 	size; 	/*!< side of the grams */
+	int32_t 	bits; 	/*!< num of bits of a packed gram, size*size */
+	uint64_t 	mask; 	/*!< bits of a packed gram */
+	uint64_t 	(*at)(const struct gram_kernel*, const bitboard_t*, int32_t, int32_t); 	/*!< packed gram of a position */
+	void 		(*roll)(const struct gram_kernel*, const uint64_t*, const uint64_t*, uint64_t*, size_t); 	/*!< codes of a row */
+} gram_kernel_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+const gram_kernel_t* 	gram_kernel(int32_t);
+size_t 					gram_count(const gram_kernel_t*, int32_t, int32_t);
+void 					gram_encode(const gram_kernel_t*, const bitboard_t*, uint64_t*, size_t*);
+void 					gram_decode(const gram_kernel_t*, uint64_t, uint8_t*);
+
+
+#endif /* guard */
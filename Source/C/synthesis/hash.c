@@ -0,0 +1,300 @@
+/**
+ * \file 		hash.c
+ * \brief 		define hash_alloc, hash_add, hash_insert, hash_merge, hash_find, hash_sorted, hash_free
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of hash.
+ *
+ * Author: 		Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "hash.h"
+#include "radix.h"
+#include "trace.h"
+#include <string.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define HASH_MIN_CAPACITY 1024 /* initial num of slots */
+
+/**
+ * \brief 			slot of a key (Fibonacci hashing)
+ * \param[in]       key: packed gram
+ * \param[in]       capacity: num of slots, power of 2
+ * \hideinitializer
+ */
+#define SLOT(key, capacity) ((size_t)(((key) * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & ((capacity) - 1))
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	hash_slots(hash_t*, size_t, arena_t*, int32_t);
+int 	hash_grow(hash_t*);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    allocation of the slots of a hash_t
+ * \note 	    keys, first positions and counts are laid out in one block.
+ * \param[in] 	table: table to allocate
+ * \param[in] 	capacity: num of slots, power of 2
+ * \param[in] 	arena: arena of the worker, NULL for the heap
+ * \param[in] 	buffer: buffer of the arena, ARENA_TABLE or ARENA_REHASH
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+hash_slots(hash_t* table, size_t capacity, arena_t* arena, int32_t buffer)
+{
+	size_t bytes = capacity * (sizeof (uint64_t) + sizeof (size_t) + sizeof (uint32_t));
+	uint8_t* block;
+
+	if (arena != NULL) {
+		block = arena_alloc(arena, buffer, bytes);
+	} else {
+		block = malloc(bytes);
+		TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+	}
+	table->arena = arena;
+	table->buffer = buffer;
+	table->capacity = capacity;
+	table->size = 0;
+	if (block == NULL) {
+		table->keys = NULL;
+		table->first = NULL;
+		table->counts = NULL;
+		table->capacity = 0;
+		return 1;
+	}
+	table->keys = (uint64_t*)block;
+	table->first = (size_t*)(block + capacity*sizeof (uint64_t));
+	table->counts = (uint32_t*)(block + capacity*(sizeof (uint64_t) + sizeof (size_t)));
+	memset(table->counts, 0, capacity * sizeof (uint32_t));
+	return 0;
+}
+
+/**
+ * \brief 	    allocation of a hash_t.
+ * \param[in] 	table: table to allocate
+ * \param[in] 	len: expected num of keys
+ * \param[in] 	arena: arena of the worker, reused from an image to the next,
+ *              NULL for the heap
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+hash_alloc(hash_t* table, size_t len, arena_t* arena)
+{
+	size_t capacity = HASH_MIN_CAPACITY;
+
+	while (capacity < 2*len)
+		capacity <<= 1;
+	return hash_slots(table, capacity, arena, ARENA_TABLE);
+}
+
+/**
+ * \brief 	    double the num of slots
+ * \note 	    in an arena, the grown slots take the other buffer and the
+ *              two buffers swap their roles.
+ * \param[in] 	table: table to grow
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+hash_grow(hash_t* table)
+{
+	hash_t grown;
+
+	if (hash_slots(&grown, 2*table->capacity, table->arena, table->buffer == ARENA_TABLE ? ARENA_REHASH : ARENA_TABLE)) {
+		return 1;
+	}
+	for (size_t i = 0; i < table->capacity; ++i) {
+		if (table->counts[i]) {
+			size_t slot = SLOT(table->keys[i], grown.capacity);
+			while (grown.counts[slot])
+				slot = (slot + 1) & (grown.capacity - 1);
+			grown.keys[slot] = table->keys[i];
+			grown.counts[slot] = table->counts[i];
+			grown.first[slot] = table->first[i];
+		}
+	}
+	grown.size = table->size;
+	hash_free(table);
+	*table = grown;
+	return 0;
+}
+
+/**
+ * \brief 	    count occurrences of a gram
+ * \note 	    the table grows when it is half full.
+ * \param[in] 	table: hash table
+ * \param[in] 	key: packed gram
+ * \param[in] 	count: num of occurrences
+ * \param[in] 	position: position of the first occurrence
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+hash_add(hash_t* table, uint64_t key, uint32_t count, size_t position)
+{
+	size_t slot = SLOT(key, table->capacity);
+
+	while (table->counts[slot]) {
+		TRACE_COUNT(TRACE_COMPARISONS, 1);
+		if (table->keys[slot] == key) {
+			table->counts[slot] += count;
+			if (position < table->first[slot]) {
+				table->first[slot] = position;
+			}
+			return 0;
+		}
+		slot = (slot + 1) & (table->capacity - 1);
+	}
+	if (2*(table->size + 1) > table->capacity) {
+		if (hash_grow(table)) {
+			return 1;
+		}
+		return hash_add(table, key, count, position);
+	}
+	table->keys[slot] = key;
+	table->counts[slot] = count;
+	table->first[slot] = position;
+	++table->size;
+	return 0;
+}
+
+/**
+ * \brief 	    count an occurrence of a gram
+ * \param[in] 	table: hash table
+ * \param[in] 	key: packed gram
+ * \param[in] 	position: position of the occurrence
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+hash_insert(hash_t* table, uint64_t key, size_t position)
+{
+	return hash_add(table, key, 1, position);
+}
+
+/**
+ * \brief 	    add the recurrences of a table to another one
+ * \param[in] 	dest: hash table receiving the grams
+ * \param[in] 	src: hash table to add
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+hash_merge(hash_t* dest, const hash_t* src)
+{
+	for (size_t slot = 0; slot < src->capacity; ++slot)
+		if (src->counts[slot] && hash_add(dest, src->keys[slot], src->counts[slot], src->first[slot])) {
+			return 1;
+		}
+	return 0;
+}
+
+/**
+ * \brief 	    recurrence of a gram
+ * \param[in] 	table: hash table
+ * \param[in] 	key: packed gram
+ * \return 		num of occurrences of the gram, 0 if it is not in the table.
+ */
+uint32_t
+hash_find(const hash_t* table, uint64_t key)
+{
+	size_t slot = SLOT(key, table->capacity);
+
+	while (table->counts[slot]) {
+		TRACE_COUNT(TRACE_COMPARISONS, 1);
+		if (table->keys[slot] == key) {
+			return table->counts[slot];
+		}
+		slot = (slot + 1) & (table->capacity - 1);
+	}
+	return 0;
+}
+
+/**
+ * \brief 	    list the keys of a table in ascending order
+ * \param[in] 	table: hash table
+ * \param[out] 	keys: table->size keys
+ * \param[out] 	slots: slot of each key, to read its count and first position
+ * \param[in] 	bits: num of significant bits of the keys
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+hash_sorted(const hash_t* table, uint64_t* keys, size_t* slots, uint32_t bits)
+{
+	size_t k = 0;
+
+	for (size_t slot = 0; slot < table->capacity; ++slot) {
+		if (table->counts[slot]) {
+			keys[k] = table->keys[slot];
+			slots[k++] = slot;
+		}
+	}
+	if (table->arena != NULL) {
+		return radix_sort(keys, slots, table->size, bits,
+			arena_alloc(table->arena, ARENA_SORT_KEYS, table->size * sizeof (uint64_t)),
+			arena_alloc(table->arena, ARENA_SORT_VALUES, table->size * sizeof (size_t)));
+	}
+	return radix_sort(keys, slots, table->size, bits, NULL, NULL);
+}
+
+/**
+ * \brief 	    free hash table
+ * \note 	    the slots of an arena stay in the arena for the next image.
+ * \param[in] 	table: hash table to free
+ */
+void
+hash_free(hash_t* table)
+{
+	if (table->arena == NULL) {
+		free(table->keys);
+	}
+	table->keys = NULL;
+	table->counts = NULL;
+	table->first = NULL;
+	table->capacity = 0;
+	table->size = 0;
+}
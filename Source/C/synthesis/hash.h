@@ -0,0 +1,85 @@
+/**
+ * \file            hash.h
+ * \brief           Hash table of the grams
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of hash.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+#ifndef HASH_H
+#define HASH_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "arena.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< types definitions */
+/***********************/
+
+/**
+ * \brief 		hash_t
+ * \note		Open addressing hash table with linear probing, from packed grams to recurrences.
+ *              A slot is empty iff its count is 0. The slots are a single block,
+ *              taken from the arena of a worker or from the heap.
+*/
+typedef struct
+{
+	uint64_t* 	keys; 		/*!< packed grams */
+	uint32_t* 	counts; 	/*!< recurrences of the grams */
+	size_t* 	first; 		/*!< position of the first occurrence */
+	size_t 		capacity; 	/*!< num of slots, power of 2 */
+	size_t 		size; 		/*!< num of used slots */
+	arena_t* 	arena; 		/*!< arena of the slots, NULL for the heap */
+	int32_t 	buffer; 	/*!< buffer of the arena holding the slots */
+} hash_t;
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+int 		hash_alloc(hash_t*, size_t, arena_t*);
+int 		hash_add(hash_t*, uint64_t, uint32_t, size_t);
+int 		hash_insert(hash_t*, uint64_t, size_t);
+int 		hash_merge(hash_t*, const hash_t*);
+uint32_t 	hash_find(const hash_t*, uint64_t);
+int 		hash_sorted(const hash_t*, uint64_t*, size_t*, uint32_t);
+void 		hash_free(hash_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,152 @@
+/**
+ * \file 		kernels.c
+ * \brief 		Define the main function of the check of the vector kernels of the binarization
+ */
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "binarize.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define KERNELS_BLOCK 64 /* num of pixels of a block, as BINARIZE_BLOCK */
+#define KERNELS_CHECKS 100000 /* random blocks checked for each kernel */
+
+#if defined(__SSE2__)
+	#define KERNELS_SSE2 /* SSE2 kernels, as BINARIZE_SSE2 */
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define KERNELS_AVX2 /* AVX2 kernels, as BINARIZE_AVX2 */
+#endif
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+uint64_t 	kernels_state = UINT64_C(0x9E3779B97F4A7C15); 	/*!< state of the random generator */
+
+void 		binarize_codes_scalar(const uint8_t*, uint16_t*);
+uint64_t 	binarize_mask_scalar(const uint8_t*, uint32_t);
+#ifdef KERNELS_SSE2
+void 		binarize_codes_sse2(const uint8_t*, uint16_t*);
+uint64_t 	binarize_mask_sse2(const uint8_t*, uint32_t);
+#endif /* KERNELS_SSE2 */
+#ifdef KERNELS_AVX2
+void 		binarize_codes_avx2(const uint8_t*, uint16_t*);
+uint64_t 	binarize_mask_avx2(const uint8_t*, uint32_t);
+#endif /* KERNELS_AVX2 */
+
+uint8_t 	kernels_random(void);
+int 		kernels_cmp(const void*, const void*);
+int32_t 	kernels_check(const char*, void (*)(const uint8_t*, uint16_t*), uint64_t (*)(const uint8_t*, uint32_t));
+int 		main(void);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    next random channel, xorshift64*
+ * \note 	    a channel out of four is 0 or 255, so the blocks have extreme codes.
+ * \return 		random channel
+ */
+uint8_t
+kernels_random(void)
+{
+	uint64_t word;
+
+	kernels_state ^= kernels_state >> 12;
+	kernels_state ^= kernels_state << 25;
+	kernels_state ^= kernels_state >> 27;
+	word = kernels_state * UINT64_C(0x2545F4914F6CDD1D);
+	if ((word & 3) == 0) {
+		return (word & 4) ? 255 : 0;
+	}
+	return (uint8_t)(word >> 56);
+}
+
+/**
+ * \brief 	    order of two brightness codes
+ * \param[in] 	a: first code
+ * \param[in] 	b: second code
+ * \return 		negative, 0 or positive as a is less, equal or greater than b.
+ */
+int
+kernels_cmp(const void* a, const void* b)
+{
+	return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+/**
+ * \brief 	    check the kernels of an instruction set against the scalar ones
+ * \note 	    the codes of a block may be in any order, so they are compared sorted.
+ *              The thresholds run over all the brightness codes.
+ * \param[in] 	name: name of the instruction set
+ * \param[in] 	codes_kernel: brightness codes of a block
+ * \param[in] 	mask_kernel: threshold of a block
+ * \return 		num of blocks on which a kernel differs.
+ */
+int32_t
+kernels_check(const char* name, void (*codes_kernel)(const uint8_t*, uint16_t*), uint64_t (*mask_kernel)(const uint8_t*, uint32_t))
+{
+	uint8_t block[3*KERNELS_BLOCK];
+	uint16_t codes[KERNELS_BLOCK], expected[KERNELS_BLOCK];
+	int32_t mismatches = 0;
+
+	for (int32_t check = 0; check < KERNELS_CHECKS; ++check) {
+		uint32_t median = (uint32_t)check % (BINARIZE_LEVELS + 1);
+
+		for (int32_t i = 0; i < 3*KERNELS_BLOCK; ++i)
+			block[i] = kernels_random();
+		codes_kernel(block, codes);
+		binarize_codes_scalar(block, expected);
+		qsort(codes, KERNELS_BLOCK, sizeof (uint16_t), kernels_cmp);
+		qsort(expected, KERNELS_BLOCK, sizeof (uint16_t), kernels_cmp);
+		if (memcmp(codes, expected, sizeof (codes)) != 0 ||
+			mask_kernel(block, median) != binarize_mask_scalar(block, median)) {
+			++mismatches;
+		}
+	}
+	printf("\t%s: %d mismatches on %d blocks\n", name, mismatches, KERNELS_CHECKS);
+	return mismatches;
+}
+
+/**
+ * \brief 	    main
+ * \note 	    check the SSE2 and AVX2 kernels of the binarization, the ones the CPU
+ *              supports, against the scalar kernels on random blocks.
+ * \return 		'EXIT_SUCCESS': any error
+ *              'EXIT_FAILURE': a kernel differs from the scalar one
+ */
+int
+main(void)
+{
+	int32_t mismatches = 0;
+
+#ifdef KERNELS_SSE2
+	mismatches += kernels_check("sse2", binarize_codes_sse2, binarize_mask_sse2);
+#endif /* KERNELS_SSE2 */
+#ifdef KERNELS_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		mismatches += kernels_check("avx2", binarize_codes_avx2, binarize_mask_avx2);
+	}
+#endif /* KERNELS_AVX2 */
+	if (mismatches > 0) {
+		fprintf(stderr, "\t> the vector kernels differ from the scalar ones\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
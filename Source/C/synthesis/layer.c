@@ -0,0 +1,351 @@
+/**
+ * \file 		layer.c
+ * \brief 		define layer_bits, layer_footprint, layer_synth
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of layer.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "layer.h"
+#include "binarize.h"
+#include "binfile.h"
+#include "radix.h"
+#include <string.h>
+
+
+/***********************/
+/*!< types definitions */
+/***********************/
+
+__extension__ typedef unsigned __int128 layer_wide_t; /* packed gram of more than 64 bits */
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int32_t 	layer_depth(int32_t);
+void 		layer_roll(const uint8_t*, int32_t, int32_t, const uint64_t*, uint64_t*, size_t);
+void 		layer_roll_wide(const uint8_t*, int32_t, int32_t, const layer_wide_t*, layer_wide_t*, size_t);
+int 		layer_write(binfile_t*, const uint32_t*, size_t, const float*, const uint8_t*, size_t, size_t);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    num of bits of a layer
+ * \param[in] 	layers: num of layers
+ * \return 		ceil(log2(layers))
+ */
+int32_t
+layer_depth(int32_t layers)
+{
+	int32_t depth = 0;
+
+	while ((INT32_C(1) << depth) < layers)
+		++depth;
+	return depth;
+}
+
+/**
+ * \brief 	    num of bits of a packed gram
+ * \param[in] 	gram_size: size of the grams
+ * \param[in] 	layers: num of layers
+ * \return 		gram_size*gram_size*ceil(log2(layers))
+ */
+int32_t
+layer_bits(int32_t gram_size, int32_t layers)
+{
+	return gram_size * gram_size * layer_depth(layers);
+}
+
+/**
+ * \brief 	    estimate the memory of a synthesis
+ * \note 	    the bytes of the buffers that layer_synth takes from the arena.
+ * \param[in] 	width: width of the image
+ * \param[in] 	height: height of the image
+ * \param[in] 	gram_size: size of the grams
+ * \param[in] 	layers: num of layers
+ * \return 		bytes
+ */
+size_t
+layer_footprint(int32_t width, int32_t height, int32_t gram_size, int32_t layers)
+{
+	size_t num_of_pixels = (size_t)width * (size_t)height, num_of_cols = 0, num_of_grams = 0, row = 0;
+	size_t per_gram = 2*sizeof (uint64_t) + 2*sizeof (size_t) + sizeof (uint32_t);
+
+	if (width >= gram_size && height >= gram_size) {
+		num_of_cols = (size_t)(width - gram_size + 1);
+		num_of_grams = num_of_cols * (size_t)(height - gram_size + 1);
+	}
+	/* pairs of words and their sort keys, and the row of rolling codes */
+	if (layer_bits(gram_size, layers) > 64) {
+		per_gram += 2*sizeof (uint64_t);
+		row = num_of_cols*sizeof (layer_wide_t);
+	}
+	/* layers, recurrence map and grams with the buffers of the radix sort, all held by the arena */
+	return num_of_pixels*(sizeof (uint8_t) + sizeof (float)) + num_of_grams*per_gram + row;
+}
+
+/**
+ * \brief 	    roll the codes of a row of grams by a row of layers
+ * \note 	    a row of a gram is a strip of gram_size*depth bits, the first pixel
+ *              is the most significant one. The strip is rolled along the row.
+ * \param[in] 	levels: row of layers
+ * \param[in] 	gram_size: size of the grams
+ * \param[in] 	depth: num of bits of a layer
+ * \param[in] 	above: codes of the grams of the row above
+ * \param[out] 	dest: codes of the grams, can be 'above'
+ * \param[in] 	num_of_cols: num of grams of a row
+ */
+void
+layer_roll(const uint8_t* levels, int32_t gram_size, int32_t depth, const uint64_t* above, uint64_t* dest,
+	size_t num_of_cols)
+{
+	int32_t width = gram_size * depth, bits = gram_size * width;
+	uint64_t strip_mask = (UINT64_C(1) << width) - 1;
+	uint64_t mask = bits == 64 ? ~UINT64_C(0) : (UINT64_C(1) << bits) - 1;
+	uint64_t strip = 0;
+
+	for (int32_t k = 0; k < gram_size - 1; ++k)
+		strip = (strip << depth) | levels[k];
+	for (size_t col = 0; col < num_of_cols; ++col) {
+		strip = ((strip << depth) | levels[col + gram_size - 1]) & strip_mask;
+		dest[col] = ((above[col] << width) | strip) & mask;
+	}
+}
+
+/**
+ * \brief 	    roll the codes of a row of grams of more than 64 bits
+ * \param[in] 	levels: row of layers
+ * \param[in] 	gram_size: size of the grams
+ * \param[in] 	depth: num of bits of a layer
+ * \param[in] 	above: codes of the grams of the row above
+ * \param[out] 	dest: codes of the grams, can be 'above'
+ * \param[in] 	num_of_cols: num of grams of a row
+ */
+void
+layer_roll_wide(const uint8_t* levels, int32_t gram_size, int32_t depth, const layer_wide_t* above,
+	layer_wide_t* dest, size_t num_of_cols)
+{
+	int32_t width = gram_size * depth, bits = gram_size * width;
+	uint64_t strip_mask = (UINT64_C(1) << width) - 1;
+	layer_wide_t mask = bits == 128 ? ~(layer_wide_t)0 : ((layer_wide_t)1 << bits) - 1;
+	uint64_t strip = 0;
+
+	for (int32_t k = 0; k < gram_size - 1; ++k)
+		strip = (strip << depth) | levels[k];
+	for (size_t col = 0; col < num_of_cols; ++col) {
+		strip = ((strip << depth) | levels[col + gram_size - 1]) & strip_mask;
+		dest[col] = ((above[col] << width) | strip) & mask;
+	}
+}
+
+/**
+ * \brief 	    write the sections after the grams
+ * \param[in] 	file: synthesis file
+ * \param[in] 	counts: recurrences of the grams
+ * \param[in] 	size: num of distinct grams
+ * \param[in] 	map: recurrence map
+ * \param[in] 	levels: layers of the pixels
+ * \param[in] 	num_of_pixels: num of pixels
+ * \param[in] 	total: num of grams of the image
+ * \return 		0: any error.
+ *              1: write error.
+ */
+int
+layer_write(binfile_t* file, const uint32_t* counts, size_t size, const float* map, const uint8_t* levels,
+	size_t num_of_pixels, size_t total)
+{
+	return binfile_begin(file, BINFILE_COUNTS, BINFILE_RAW) ||
+		binfile_write(file, counts, size * sizeof (uint32_t)) ||
+		binfile_begin(file, BINFILE_MAP, BINFILE_RAW) ||
+		binfile_write(file, map, num_of_pixels * sizeof (float)) ||
+		binfile_begin(file, BINFILE_BITBOARD, BINFILE_RAW) ||
+		binfile_write(file, levels, num_of_pixels * sizeof (uint8_t)) ||
+		binfile_finish(file, total);
+}
+
+/**
+ * \brief 	    synthesize an image by the multilayer model
+ * \note 	    the pixels are split in layers of brightness by the quantiles of one
+ *              histogram, and a gram is packed in gram_size*gram_size*ceil(log2(layers))
+ *              bits, the first pixel being the most significant. The packed grams are
+ *              counted by a radix sort: up to 64 bits as words, up to 128 bits as pairs
+ *              of words sorted by the low word and then, stably, by the high word.
+ *              With 2 layers the synthesis is the one of the BW model.
+ *              The bitboard section holds the layer of each pixel. The buffers are
+ *              taken from the arena of the worker.
+ * \param[in] 	gram_size: size of the grams
+ * \param[in] 	layers: num of layers, 2 to BINARIZE_MAX_LAYERS
+ * \param[in] 	image: mapped image
+ * \param[in] 	fp: synthesis file
+ * \param[in] 	arena: buffers of the worker
+ * \return 		0: any error.
+ *              1: out of memory.
+ *              2: write error.
+ */
+int
+layer_synth(int32_t gram_size, int32_t layers, const ppm_t* image, FILE* fp, arena_t* arena)
+{
+	int32_t width = image->width, height = image->height, depth = layer_depth(layers);
+	int32_t bits = layer_bits(gram_size, layers);
+	size_t num_of_pixels = (size_t)width * (size_t)height, num_of_cols = 0, num_of_grams = 0, size = 0;
+	uint8_t* levels = arena_alloc(arena, ARENA_BITBOARD, num_of_pixels * sizeof (uint8_t));
+	float* map = arena_calloc(arena, ARENA_MAP, num_of_pixels * sizeof (float));
+	uint32_t* counts = NULL;
+	size_t* index = NULL;
+	uint64_t* scratch_keys = NULL;
+	size_t* scratch_values = NULL;
+	binfile_t file;
+	int output = 0;
+
+	if (width >= gram_size && height >= gram_size) {
+		num_of_cols = (size_t)(width - gram_size + 1);
+		num_of_grams = num_of_cols * (size_t)(height - gram_size + 1);
+	}
+	counts = arena_alloc(arena, ARENA_RECURRENCE, num_of_grams * sizeof (uint32_t));
+	index = arena_alloc(arena, ARENA_INDEX, num_of_grams * sizeof (size_t));
+	scratch_keys = arena_alloc(arena, ARENA_SORT_KEYS, num_of_grams * sizeof (uint64_t));
+	scratch_values = arena_alloc(arena, ARENA_SORT_VALUES, num_of_grams * sizeof (size_t));
+	if (levels == NULL || map == NULL || counts == NULL || index == NULL || scratch_keys == NULL ||
+		scratch_values == NULL || binarize_ppm_levels(image, layers, levels)) {
+		return 1;
+	}
+	if (binfile_create(&file, fp, 1, gram_size, width, height)) {
+		return 2;
+	}
+	file.header.parameters[0] = layers;
+
+	if (bits <= 64) {
+		uint64_t* codes = arena_calloc(arena, ARENA_CODES, num_of_grams * sizeof (uint64_t));
+
+		/* encode the grams, the first rows are accumulated in the codes of the first grams */
+		for (int32_t raw = 0; codes != NULL && num_of_grams && raw < height; ++raw) {
+			uint64_t* dest = codes + (raw < gram_size ? 0 : (size_t)(raw - gram_size + 1)*num_of_cols);
+			const uint64_t* above = dest - (raw < gram_size ? 0 : num_of_cols);
+
+			layer_roll(levels + (size_t)raw*width, gram_size, depth, above, dest, num_of_cols);
+		}
+		for (size_t i = 0; i < num_of_grams; ++i)
+			index[i] = (i / num_of_cols)*width + i % num_of_cols;
+
+		/* radix sort used to group the equal grams */
+		if (codes == NULL || radix_sort(codes, index, num_of_grams, (uint32_t)bits, scratch_keys, scratch_values)) {
+			return 1;
+		}
+		for (size_t i = 0; i < num_of_grams; ++size) {
+			size_t j = i + 1;
+
+			while (j < num_of_grams && codes[j] == codes[i])
+				++j;
+			counts[size] = (uint32_t)(j - i);
+			for (size_t k = i; k < j; ++k)
+				map[index[k]] = 1./(j - i);
+
+			/* the distinct grams are compacted at the head of the codes */
+			codes[size] = codes[i];
+			i = j;
+		}
+		output = binfile_write_grams(&file, codes, size);
+	} else {
+		uint64_t* words = arena_alloc(arena, ARENA_CODES, 2*num_of_grams * sizeof (uint64_t));
+		uint64_t* keys = arena_alloc(arena, ARENA_KEYS, num_of_grams * sizeof (uint64_t));
+		layer_wide_t* row = arena_calloc(arena, ARENA_ROW, num_of_cols * sizeof (layer_wide_t));
+		uint64_t *high = words, *low = words + num_of_grams;
+
+		if (words == NULL || keys == NULL || row == NULL) {
+			return 1;
+		}
+
+		/* encode the grams, a row of rolling codes at a time */
+		for (int32_t raw = 0; num_of_grams && raw < height; ++raw) {
+			layer_roll_wide(levels + (size_t)raw*width, gram_size, depth, row, row, num_of_cols);
+			if (raw + 1 >= gram_size) {
+				size_t first = (size_t)(raw + 1 - gram_size)*num_of_cols;
+
+				for (size_t col = 0; col < num_of_cols; ++col) {
+					high[first + col] = (uint64_t)(row[col] >> 64);
+					low[first + col] = (uint64_t)row[col];
+				}
+			}
+		}
+
+		/* sort by the low words, then stably by the high words */
+		for (size_t i = 0; i < num_of_grams; ++i) {
+			keys[i] = low[i];
+			index[i] = i;
+		}
+		if (radix_sort(keys, index, num_of_grams, 64, scratch_keys, scratch_values)) {
+			return 1;
+		}
+		for (size_t i = 0; i < num_of_grams; ++i)
+			keys[i] = high[index[i]];
+		if (radix_sort(keys, index, num_of_grams, (uint32_t)(bits - 64), scratch_keys, scratch_values)) {
+			return 1;
+		}
+		for (size_t i = 0; i < num_of_grams; ++i) {
+			high[i] = keys[i];
+			keys[i] = low[index[i]];
+		}
+
+		/* the distinct grams are compacted at the head of high and keys */
+		for (size_t i = 0; i < num_of_grams; ++size) {
+			size_t j = i + 1;
+
+			while (j < num_of_grams && high[j] == high[i] && keys[j] == keys[i])
+				++j;
+			counts[size] = (uint32_t)(j - i);
+			for (size_t k = i; k < j; ++k)
+				map[(index[k] / num_of_cols)*width + index[k] % num_of_cols] = 1./(j - i);
+			high[size] = high[i];
+			keys[size] = keys[i];
+			i = j;
+		}
+
+		/* interleave the pairs backwards, the pair d overwrites high from d on */
+		for (size_t d = size; d-- > 0;) {
+			words[2*d + 1] = keys[d];
+			words[2*d] = high[d];
+		}
+		output = binfile_write_wide_grams(&file, words, size);
+	}
+
+	output = output || layer_write(&file, counts, size, map, levels, num_of_pixels, num_of_grams);
+	return output ? 2 : 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * \file            layer.h
+ * \brief           Multilayer model: grams of the layers of brightness
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of layer.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+#ifndef LAYER_H
+#define LAYER_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "arena.h"
+#include "ppm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define LAYER_MAX_BITS 128 /* max num of bits of a packed gram */
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int32_t 	layer_bits(int32_t, int32_t);
+size_t 		layer_footprint(int32_t, int32_t, int32_t, int32_t);
+int 		layer_synth(int32_t, int32_t, const ppm_t*, FILE*, arena_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,541 @@
+/**
+ * \file 		libsynthesis.c
+ * \brief 		define synthesis_abi_version, synthesis_gram_size, synthesis_set_gram_size, synthesis_from_path, synthesis_from_buffer,
+ *              synthesis_write, synthesis_batch, synthesis_update, synthesis_release, synthesis_error
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of libsynthesis.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#define _POSIX_C_SOURCE 200809L  // stat
+#include "libsynthesis.h"
+#include "../config.h"
+#include "band.h"
+#include "binarize.h"
+#include "binfile.h"
+#include "bitboard.h"
+#include "cache.h"
+#include "gram.h"
+#include "hash.h"
+#include "param.h"
+#include "pool.h"
+#include "ppm.h"
+#include "radix.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		batch_t
+ * \note		State shared by the workers of a batch.
+*/
+typedef struct
+{
+	pool_t 				pool; 		        /*!< images of the batch */
+	const char* const* 	inputs; 	        /*!< paths of the images */
+	const char* const* 	outputs; 	        /*!< paths of the synthesis files, can be NULL */
+	synthesis_t* 		results; 	        /*!< syntheses, can be NULL */
+	cache_t* 			cache; 		        /*!< synthesis files of the previous runs, can be NULL */
+	int* 				statuses; 	        /*!< status of each image */
+	int32_t 			num_of_threads; 	/*!< num of workers */
+	int32_t 			next_worker; 	    /*!< index of the next worker to start */
+	pthread_mutex_t 	mutex; 		        /*!< mutex of next_worker */
+} batch_t;
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+int32_t 	library_gram_size = PARAM_GRAM_SIZE; 	/*!< side of the grams of the syntheses */
+
+int 	synthesis_run(const ppm_t*, int32_t, synthesis_t*);
+void* 	synthesis_activation(void*);
+int 	synthesis_pool(batch_t*, int32_t, int32_t, int32_t*);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    version of the API
+ * \return 		SYNTHESIS_ABI_VERSION of the library.
+ */
+int
+synthesis_abi_version(void)
+{
+	return SYNTHESIS_ABI_VERSION;
+}
+
+/**
+ * \brief 	    side of the grams
+ * \return 		side of the grams of the syntheses, by default the one of config.h.
+ */
+int32_t
+synthesis_gram_size(void)
+{
+	return library_gram_size;
+}
+
+/**
+ * \brief 	    set the side of the grams
+ * \note 	    the kernel of the side is chosen by each synthesis, so the side is set
+ *              before the syntheses, not while they run.
+ * \param[in] 	gram_size: side of the grams, from 1 to GRAM_MAX_SIZE
+ * \return 		SYNTHESIS_OK or SYNTHESIS_INVALID_ARGUMENT.
+ */
+int
+synthesis_set_gram_size(int32_t gram_size)
+{
+	if (gram_kernel(gram_size) == NULL) {
+		return SYNTHESIS_INVALID_ARGUMENT;
+	}
+	library_gram_size = gram_size;
+	return SYNTHESIS_OK;
+}
+
+/**
+ * \brief 	    synthesize an image
+ * \note 	    the grams of a small image are counted by a radix sort, the grams of a
+ *              large image by a hash table per band of rows, as in the synthesis program.
+ * \param[in] 	image: image
+ * \param[in] 	num_of_threads: threads of a large image
+ * \param[out] 	result: synthesis
+ * \return 		SYNTHESIS_OK: any error.
+ *              SYNTHESIS_OUT_OF_MEMORY: out of memory.
+ */
+int
+synthesis_run(const ppm_t* image, int32_t num_of_threads, synthesis_t* result)
+{
+	const gram_kernel_t* kernel = gram_kernel(library_gram_size);
+	size_t num_of_pixels = (size_t)image->width * (size_t)image->height;
+	size_t num_of_grams = gram_count(kernel, image->width, image->height);
+	bitboard_t board = {0};
+	uint64_t* codes = malloc((num_of_grams ? num_of_grams : 1) * sizeof (uint64_t));
+	int output = SYNTHESIS_OUT_OF_MEMORY;
+
+	memset(result, 0, sizeof (synthesis_t));
+	result->gram_size = kernel->size;
+	result->width = image->width;
+	result->height = image->height;
+	result->total = num_of_grams;
+	result->map = calloc(num_of_pixels, sizeof (float));
+	result->bitboard = malloc(num_of_pixels * sizeof (uint8_t));
+	if (codes == NULL || result->map == NULL || result->bitboard == NULL ||
+		bitboard_alloc(&board, image->width, image->height) || binarize_ppm(image, &board)) {
+		goto end;
+	}
+	for (int32_t raw = 0; raw < image->height; ++raw)
+		bitboard_unpack(&board, raw, result->bitboard + (size_t)raw*image->width);
+
+	if (num_of_pixels >= PARALLEL_PIXELS && num_of_threads > 1) {
+		/* large image: a hash table per band of rows */
+		hash_t table = {0};
+		size_t* slots = NULL;
+
+		if (hash_alloc(&table, 0, NULL) || band_count(kernel, &board, codes, &table, num_of_threads) ||
+			band_map(kernel, &board, codes, &table, result->map, num_of_threads)) {
+			hash_free(&table);
+			goto end;
+		}
+		result->size = table.size;
+		result->codes = malloc((table.size ? table.size : 1) * sizeof (uint64_t));
+		result->counts = malloc((table.size ? table.size : 1) * sizeof (uint32_t));
+		slots = malloc((table.size ? table.size : 1) * sizeof (size_t));
+		if (result->codes == NULL || result->counts == NULL || slots == NULL ||
+			hash_sorted(&table, result->codes, slots, kernel->bits)) {
+			free(slots);
+			hash_free(&table);
+			goto end;
+		}
+		for (size_t i = 0; i < table.size; ++i)
+			result->counts[i] = table.counts[slots[i]];
+		free(slots);
+		hash_free(&table);
+	} else {
+		/* radix sort used to group the equal grams */
+		size_t* positions = malloc((num_of_grams ? num_of_grams : 1) * sizeof (size_t));
+		size_t size = 0;
+
+		if (positions == NULL) {
+			goto end;
+		}
+		gram_encode(kernel, &board, codes, positions);
+		if (radix_sort(codes, positions, num_of_grams, kernel->bits, NULL, NULL)) {
+			free(positions);
+			goto end;
+		}
+		result->counts = malloc((num_of_grams ? num_of_grams : 1) * sizeof (uint32_t));
+		if (result->counts == NULL) {
+			free(positions);
+			goto end;
+		}
+		for (size_t i = 0; i < num_of_grams; ++size) {
+			size_t j = i + 1;
+
+			while (j < num_of_grams && codes[j] == codes[i])
+				++j;
+			result->counts[size] = (uint32_t)(j - i);
+			for (size_t k = i; k < j; ++k)
+				result->map[positions[k]] = 1./(j - i);
+
+			/* the distinct grams are compacted at the head of the codes */
+			codes[size] = codes[i];
+			i = j;
+		}
+		free(positions);
+		result->size = size;
+		/* the codes of the grams are trimmed to the distinct ones */
+		result->codes = malloc((size ? size : 1) * sizeof (uint64_t));
+		if (result->codes == NULL) {
+			goto end;
+		}
+		memcpy(result->codes, codes, size * sizeof (uint64_t));
+	}
+	output = SYNTHESIS_OK;
+
+end:
+	free(codes);
+	bitboard_free(&board);
+	if (output != SYNTHESIS_OK) {
+		synthesis_release(result);
+	}
+	return output;
+}
+
+/**
+ * \brief 	    synthesize an image file
+ * \param[in] 	path: path of the image
+ * \param[in] 	num_of_threads: threads of a large image, 0 uses the num of online CPUs
+ * \param[out] 	result: synthesis, to release with synthesis_release
+ * \return 		SYNTHESIS_OK, SYNTHESIS_NOT_FOUND, SYNTHESIS_FORMAT_ERROR,
+ *              SYNTHESIS_TRUNCATED or SYNTHESIS_OUT_OF_MEMORY.
+ */
+int
+synthesis_from_path(const char* path, int32_t num_of_threads, synthesis_t* result)
+{
+	ppm_t image;
+	int output = ppm_open(&image, path);
+
+	memset(result, 0, sizeof (synthesis_t));
+	if (output != PPM_OK) {
+		return output == PPM_NOT_FOUND ? SYNTHESIS_NOT_FOUND :
+			   output == PPM_FORMAT_ERROR ? SYNTHESIS_FORMAT_ERROR : SYNTHESIS_TRUNCATED;
+	}
+	output = synthesis_run(&image, num_of_threads > 0 ? num_of_threads : pool_cpu_count(), result);
+	ppm_close(&image);
+	return output;
+}
+
+/**
+ * \brief 	    synthesize an image in memory
+ * \param[in] 	data: bytes of a P4, P5 or P6 image file
+ * \param[in] 	size: num of bytes
+ * \param[in] 	num_of_threads: threads of a large image, 0 uses the num of online CPUs
+ * \param[out] 	result: synthesis, to release with synthesis_release
+ * \return 		SYNTHESIS_OK, SYNTHESIS_FORMAT_ERROR, SYNTHESIS_TRUNCATED or SYNTHESIS_OUT_OF_MEMORY.
+ */
+int
+synthesis_from_buffer(const uint8_t* data, size_t size, int32_t num_of_threads, synthesis_t* result)
+{
+	ppm_t image;
+	int output;
+
+	memset(&image, 0, sizeof (ppm_t));
+	memset(result, 0, sizeof (synthesis_t));
+	output = ppm_parse(&image, data, size);
+	if (output != PPM_OK) {
+		return output == PPM_FORMAT_ERROR ? SYNTHESIS_FORMAT_ERROR : SYNTHESIS_TRUNCATED;
+	}
+	return synthesis_run(&image, num_of_threads > 0 ? num_of_threads : pool_cpu_count(), result);
+}
+
+/**
+ * \brief 	    write a synthesis file of version 2
+ * \param[in] 	synthesis: synthesis
+ * \param[in] 	path: path of the synthesis file
+ * \return 		SYNTHESIS_OK, SYNTHESIS_NOT_FOUND or SYNTHESIS_WRITE_ERROR.
+ */
+int
+synthesis_write(const synthesis_t* synthesis, const char* path)
+{
+	FILE* fp = fopen(path, "wb");
+	size_t num_of_pixels = (size_t)synthesis->width * (size_t)synthesis->height;
+	binfile_t file;
+	int output;
+
+	if (fp == NULL) {
+		return SYNTHESIS_NOT_FOUND;
+	}
+	output = binfile_create(&file, fp, 0, synthesis->gram_size, synthesis->width, synthesis->height) ||
+			 binfile_write_grams(&file, synthesis->codes, synthesis->size) ||
+			 binfile_begin(&file, BINFILE_COUNTS, BINFILE_RAW) ||
+			 binfile_write(&file, synthesis->counts, synthesis->size * sizeof (uint32_t)) ||
+			 binfile_begin(&file, BINFILE_MAP, BINFILE_RAW) ||
+			 binfile_write(&file, synthesis->map, num_of_pixels * sizeof (float)) ||
+			 binfile_begin(&file, BINFILE_BITBOARD, BINFILE_RAW) ||
+			 binfile_write(&file, synthesis->bitboard, num_of_pixels * sizeof (uint8_t)) ||
+			 binfile_finish(&file, synthesis->total);
+	if (fclose(fp) != 0 || output) {
+		return SYNTHESIS_WRITE_ERROR;
+	}
+	return SYNTHESIS_OK;
+}
+
+/**
+ * \brief 	    activation function of the workers of a batch
+ * \param[in] 	addr: batch
+ * \return 		'NULL'
+ */
+void*
+synthesis_activation(void* addr)
+{
+	batch_t* batch = (batch_t*)addr;
+	int32_t worker;
+
+	pthread_mutex_lock(&batch->mutex);
+	worker = batch->next_worker++;
+	pthread_mutex_unlock(&batch->mutex);
+
+	for (;;) {
+		int32_t job = pool_pop(&batch->pool, worker);
+		synthesis_t local, *result;
+		uint64_t key = 0;
+
+		if (job == POOL_EMPTY) {
+			break;
+		} else if (job == POOL_TRIM) {
+			continue;
+		}
+
+		/* a current synthesis file is not written again */
+		if (batch->cache != NULL &&
+			(cache_current(batch->cache, batch->inputs[job], batch->outputs[job]) == CACHE_HIT ||
+			 cache_lookup(batch->cache, batch->inputs[job], batch->outputs[job], &key) == CACHE_HIT)) {
+			batch->statuses[job] = SYNTHESIS_OK;
+			pool_done(&batch->pool, worker, 0);
+			continue;
+		}
+		result = batch->results != NULL ? &batch->results[job] : &local;
+		batch->statuses[job] = synthesis_from_path(batch->inputs[job], pool_share(&batch->pool), result);
+		if (batch->statuses[job] == SYNTHESIS_OK && batch->outputs != NULL) {
+			batch->statuses[job] = synthesis_write(result, batch->outputs[job]);
+		}
+		if (batch->statuses[job] == SYNTHESIS_OK && batch->cache != NULL &&
+			cache_record(batch->cache, batch->inputs[job], batch->outputs[job], key)) {
+			batch->statuses[job] = SYNTHESIS_OUT_OF_MEMORY;
+		}
+		if (batch->results == NULL) {
+			synthesis_release(result);
+		}
+		pool_done(&batch->pool, worker, 0);
+	}
+	return NULL;
+}
+
+/**
+ * \brief 	    run the workers of a batch
+ * \note 	    the largest images are synthesized first.
+ * \param[in] 	batch: batch, with its images, outputs, results and cache
+ * \param[in] 	count: num of images
+ * \param[in] 	num_of_threads: num of threads, 0 uses the num of online CPUs
+ * \param[out] 	failed: index of the first image in error, -1 if none, can be NULL
+ * \return 		SYNTHESIS_OK or the error of the first image in error,
+ *              SYNTHESIS_OUT_OF_MEMORY if no worker could start.
+ */
+int
+synthesis_pool(batch_t* batch, int32_t count, int32_t num_of_threads, int32_t* failed)
+{
+	size_t* sizes = malloc((count > 0 ? count : 1) * sizeof (size_t));
+	pthread_t* threads;
+	int32_t started = 0;
+	int output = SYNTHESIS_OK;
+
+	if (failed != NULL) {
+		*failed = -1;
+	}
+	batch->num_of_threads = num_of_threads > 0 ? num_of_threads : pool_cpu_count();
+	batch->statuses = calloc(count > 0 ? count : 1, sizeof (int));
+	threads = malloc(batch->num_of_threads * sizeof (pthread_t));
+	if (sizes == NULL || batch->statuses == NULL || threads == NULL) {
+		free(sizes);
+		free(batch->statuses);
+		free(threads);
+		return SYNTHESIS_OUT_OF_MEMORY;
+	}
+	for (int32_t i = 0; i < count; ++i) {
+		struct stat info;
+
+		sizes[i] = stat(batch->inputs[i], &info) == 0 ? (size_t)info.st_size : 0;
+		if (batch->results != NULL) {
+			memset(&batch->results[i], 0, sizeof (synthesis_t));
+		}
+	}
+	if (pool_init(&batch->pool, sizes, count, batch->num_of_threads, SIZE_MAX)) {
+		free(sizes);
+		free(batch->statuses);
+		free(threads);
+		return SYNTHESIS_OUT_OF_MEMORY;
+	}
+	free(sizes);
+	pthread_mutex_init(&batch->mutex, NULL);
+
+	/* the jobs of a worker that could not start are stolen by the others */
+	for (int32_t i = 0; i < batch->num_of_threads; ++i)
+		if (pthread_create(&threads[started], NULL, synthesis_activation, batch) == 0) {
+			++started;
+		}
+	for (int32_t i = 0; i < started; ++i)
+		pthread_join(threads[i], NULL);
+	if (started == 0) {
+		output = SYNTHESIS_OUT_OF_MEMORY;
+	}
+
+	for (int32_t i = 0; i < count && output == SYNTHESIS_OK; ++i) {
+		if (batch->statuses[i] != SYNTHESIS_OK) {
+			output = batch->statuses[i];
+			if (failed != NULL) {
+				*failed = i;
+			}
+		}
+	}
+
+	pthread_mutex_destroy(&batch->mutex);
+	pool_free(&batch->pool);
+	free(batch->statuses);
+	free(threads);
+	return output;
+}
+
+/**
+ * \brief 	    synthesize a batch of images on a pool of threads
+ * \note 	    the largest images are synthesized first. Each image is written to its
+ *              synthesis file, returned in its result, or both.
+ * \param[in] 	count: num of images
+ * \param[in] 	inputs: paths of the images
+ * \param[in] 	outputs: paths of the synthesis files, NULL to write nothing
+ * \param[out] 	results: count syntheses to release with synthesis_release, NULL to keep nothing
+ * \param[in] 	num_of_threads: num of threads, 0 uses the num of online CPUs
+ * \param[out] 	failed: index of the first image in error, -1 if none, can be NULL
+ * \return 		SYNTHESIS_OK or the error of the first image in error.
+ */
+int
+synthesis_batch(int32_t count, const char* const* inputs, const char* const* outputs, synthesis_t* results,
+	int32_t num_of_threads, int32_t* failed)
+{
+	batch_t batch = {.inputs = inputs, .outputs = outputs, .results = results};
+
+	return synthesis_pool(&batch, count, num_of_threads, failed);
+}
+
+/**
+ * \brief 	    write the synthesis files of a batch of images that are not current
+ * \note 	    the manifest is the one of the synthesis program: a synthesis file is current
+ *              if its image and the parameters did not change since the run that recorded it.
+ *              The manifest is saved even if an image is in error.
+ * \param[in] 	count: num of images
+ * \param[in] 	inputs: paths of the images
+ * \param[in] 	outputs: paths of the synthesis files
+ * \param[in] 	manifest: path of the manifest
+ * \param[in] 	num_of_threads: num of threads, 0 uses the num of online CPUs
+ * \param[out] 	failed: index of the first image in error, -1 if none, can be NULL
+ * \return 		SYNTHESIS_OK, the error of the first image in error, or
+ *              SYNTHESIS_WRITE_ERROR if the manifest can not be written.
+ */
+int
+synthesis_update(int32_t count, const char* const* inputs, const char* const* outputs, const char* manifest,
+	int32_t num_of_threads, int32_t* failed)
+{
+	cache_t cache;
+	batch_t batch = {.inputs = inputs, .outputs = outputs, .cache = &cache};
+	int output;
+
+	if (cache_load(&cache, manifest, cache_parameters(0, library_gram_size, NULL))) {
+		cache_free(&cache);
+		return SYNTHESIS_OUT_OF_MEMORY;
+	}
+	output = synthesis_pool(&batch, count, num_of_threads, failed);
+	if (cache_save(&cache, manifest) && output == SYNTHESIS_OK) {
+		output = SYNTHESIS_WRITE_ERROR;
+	}
+	cache_free(&cache);
+	return output;
+}
+
+/**
+ * \brief 	    release the buffers of a synthesis
+ * \param[in] 	synthesis: synthesis
+ */
+void
+synthesis_release(synthesis_t* synthesis)
+{
+	free(synthesis->codes);
+	free(synthesis->counts);
+	free(synthesis->map);
+	free(synthesis->bitboard);
+	synthesis->codes = NULL;
+	synthesis->counts = NULL;
+	synthesis->map = NULL;
+	synthesis->bitboard = NULL;
+	synthesis->size = 0;
+}
+
+/**
+ * \brief 	    message of an error code
+ * \param[in] 	code: SYNTHESIS_OK or an error code
+ * \return 		static string.
+ */
+const char*
+synthesis_error(int code)
+{
+	switch (code) {
+		case SYNTHESIS_OK: return "any error";
+		case SYNTHESIS_NOT_FOUND: return "file not found";
+		case SYNTHESIS_FORMAT_ERROR: return "image format error";
+		case SYNTHESIS_TRUNCATED: return "pixels reading error";
+		case SYNTHESIS_OUT_OF_MEMORY: return "out of memory";
+		case SYNTHESIS_WRITE_ERROR: return "write error";
+		case SYNTHESIS_INVALID_ARGUMENT: return "invalid argument";
+		default: return "unknown error";
+	}
+}
@@ -0,0 +1,106 @@
+/**
+ * \file            libsynthesis.h
+ * \brief           C API of the shared library libsynthesis.so
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of libsynthesis.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+#ifndef LIBSYNTHESIS_H
+#define LIBSYNTHESIS_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define SYNTHESIS_API __attribute__((visibility("default"))) /* exported by libsynthesis.so */
+#define SYNTHESIS_ABI_VERSION 1 /* changed when the API breaks */
+
+#define SYNTHESIS_OK 0 /* synthesis done */
+#define SYNTHESIS_NOT_FOUND 1 /* the image can not be opened or the output created */
+#define SYNTHESIS_FORMAT_ERROR 2 /* the image is not a P4, P5 or P6 image */
+#define SYNTHESIS_TRUNCATED 3 /* the image ends before the last pixel */
+#define SYNTHESIS_OUT_OF_MEMORY 4 /* out of memory */
+#define SYNTHESIS_WRITE_ERROR 5 /* the synthesis file can not be written */
+#define SYNTHESIS_INVALID_ARGUMENT 6 /* the argument is out of range */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		synthesis_t
+ * \note		Synthesis of an image. The buffers are allocated by the library and owned
+ *              by the caller, who releases them with synthesis_release. The first pixel of
+ *              a gram is the most significant bit of its code.
+*/
+typedef struct
+{
+	int32_t 	gram_size; 	/*!< side of the grams */
+	int32_t 	width; 		/*!< width of the image */
+	int32_t 	height; 	/*!< height of the image */
+	uint64_t 	size; 		/*!< num of distinct grams */
+	uint64_t 	total; 		/*!< num of grams of the image */
+	uint64_t* 	codes; 		/*!< packed grams, ascending */
+	uint32_t* 	counts; 	/*!< recurrences of the grams */
+	float* 		map; 		/*!< width*height recurrence map, 1/count at the top left pixel of a gram */
+	uint8_t* 	bitboard; 	/*!< width*height pixels, 1 if brighter than the median */
+} synthesis_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+SYNTHESIS_API int 			synthesis_abi_version(void);
+SYNTHESIS_API int32_t 		synthesis_gram_size(void);
+SYNTHESIS_API int 			synthesis_set_gram_size(int32_t);
+SYNTHESIS_API int 			synthesis_from_path(const char*, int32_t, synthesis_t*);
+SYNTHESIS_API int 			synthesis_from_buffer(const uint8_t*, size_t, int32_t, synthesis_t*);
+SYNTHESIS_API int 			synthesis_write(const synthesis_t*, const char*);
+SYNTHESIS_API int 			synthesis_batch(int32_t, const char* const*, const char* const*, synthesis_t*, int32_t, int32_t*);
+SYNTHESIS_API int 			synthesis_update(int32_t, const char* const*, const char* const*, const char*, int32_t, int32_t*);
+SYNTHESIS_API void 			synthesis_release(synthesis_t*);
+SYNTHESIS_API const char* 	synthesis_error(int);
+
+
+#endif /* guard */
@@ -12,8 +12,25 @@
 #include "../config.h"
 #include "sort.h"
 #include "darr.h"
-#include "select.h"
+#include "binfile.h"
+#include "arena.h"
+#include "gram.h"
+#include "radix.h"
+#include "hash.h"
+#include "binarize.h"
+#include "cache.h"
+#include "band.h"
+#include "bench.h"
+#include "trace.h"
+#include "ppm.h"
+#include "stream.h"
+#include "pool.h"
+#include "pipeline.h"
+#include "layer.h"
+#include "opinion.h"
+#include "param.h"
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
@@ -29,31 +46,21 @@
 #define ERRSTR_LEN 256 /* max length of error string */
 #define IMAG_FORMAT (".ppm") /* images format */
 #define BIN_FORMAT (".bin") /* synthesis format */
+#define FOOTPRINT_DISTINCT 4 /* estimated num of grams for each distinct gram */
 
 
 /**********************/
 /*!< types definition */
 /**********************/
 
-/**
- * \brief 		pool_t
- * \note		This structure is used to implement a pool of processes.
-*/
-typedef struct
-{
-	pthread_mutex_t 	mutex; 	        /*!< mutex used as a light */
-	char** 	            directories; 	/*!< list of directories */
-	int32_t 	        index, 	        /*!< next input */
-		                count; 	        /*!< num of directories */
-} pool_t;
-
 /**
  * \brief		image_t
  * \note		This structure is used to implement an images.
 */
 typedef struct
 {
-	uint8_t* 	bitboard; 	    /*!< is a vector with data of pixels */
+	ppm_t 	    source; 	    /*!< mapped image file */
+	bitboard_t 	bitboard; 	    /*!< black and white pixels */
 	int32_t 	width, height; 	/*!< image shape */
 } image_t;
 
@@ -62,19 +69,36 @@ typedef struct
 /*!< function and variables */
 /****************************/
 
-pool_t 	            main_list; 	                            /*!< pool of processes */
-pthread_t 	        threads[THREAD_COUNT]; 	                /*!< vector of threads */
+pool_t 	            main_pool; 	                            /*!< pool of processes */
+char** 	            directories; 	                        /*!< list of directories */
+int32_t 	        count; 	                                /*!< num of directories */
+atomic_int 	        started; 	                            /*!< num of started directories */
+pthread_t* 	        threads; 	                            /*!< vector of threads */
+int32_t 	        num_of_threads; 	                    /*!< num of workers of the pool */
 pthread_mutex_t 	error_mutex; 	                        /*!< mutex used to coordinate error reporting.  */
 uint8_t 	        flag; 	                                /*!< if flag is 0 the pool of processes stops */
 char 	            source_directory[FILENAME_MAX]; 	    /*!< directory of the set folder */
 char 	            destination_directory[FILENAME_MAX]; 	/*!< directory of the synthesis folder */
 char 	            buffer[8]; 	                            /*!< buffer used to save the format images */
+int32_t 	        engine; 	                            /*!< engine counting the grams */
+int32_t 	        model; 	                                /*!< model of the synthesis */
+int32_t 	        layers; 	                            /*!< num of layers of the multilayer model */
+int32_t 	        area; 	                                /*!< side of the interaction area of the opinion model */
+double 	            confidence; 	                        /*!< confidence of the opinion model */
+int32_t 	        parameters[2]; 	                        /*!< other parameters of the model, as in the synthesis files */
+const gram_kernel_t* 	kernel; 	                        /*!< kernel of the grams */
+cache_t 	        main_cache; 	                        /*!< synthesis files of the previous runs */
+pipeline_t 	        main_pipeline; 	                        /*!< readers and writers of the pool */
+uint64_t* 	        keys; 	                                /*!< hash of each image, by a reader or its worker */
 
-#if MODEL == 0
-int 	std_cmp(const void*, const void*, void*);
 int 	cmp(const void*, const void*, void*);
-#endif /* MODEL == 0 */
-int 	synth(char*);
+void 	image_path(char*, const char*);
+void 	synthesis_path(char*, const char*);
+size_t 	input_footprint(const char*);
+FILE* 	output_open(const char*);
+int 	input_read(int32_t);
+void 	output_written(int32_t, int);
+int 	synth(int32_t, arena_t*);
 void* 	activation(void*);
 int 	main(int, char**);
 
@@ -83,27 +107,6 @@ int 	main(int, char**);
 /*!< function implementations */
 /******************************/
 
-#if MODEL == 0
-/**
- * \brief 	    standard comparison between two floats
- * \note 	    std_cmp <= 0 iff the 'a' <= 'b'.
- * \param[in] 	a: reference to first float
- * \param[in] 	b: reference to second float
- * \param[in] 	context: unused
- * \return 		-1: if a < b
- *              0: if a == b
- *              1: if a > b
- */
-int
-std_cmp(const void* a, const void* b, void* context)
-{
-	if (*(float*)a < *(float*)b) {
-		return -1;
-	} else {
-		return *(float*)a > *(float*)b;
-	}
-}
-
 /**
  * \brief 	    comparison between two grams, used in sort function
  * \note 	    cmp <= 0 iff the 'a' <= 'b'.
@@ -117,241 +120,540 @@ std_cmp(const void* a, const void* b, void* context)
 int
 cmp(const void* a, const void* b, void* context)
 {
-	image_t image = *(image_t*)context;
+	const image_t* image = (image_t*)context;
 	int32_t i = *(int32_t*)a, j = *(int32_t*)b;
-	uint8_t *curr_i = image.bitboard + i, *curr_j = image.bitboard + j;
+	int32_t raw_i = i / image->width, col_i = i % image->width, raw_j = j / image->width, col_j = j % image->width;
+
+	TRACE_COUNT(TRACE_COMPARISONS, 1);
 
 	/* check gram existence */
-	{
-		int32_t raw_i = i / image.width, col_i = i % image.width, raw_j = j / image.width, col_j = j % image.width;
-		if (raw_i + BW_GRAM_SIZE > image.height || col_i + BW_GRAM_SIZE > image.width) {
-			return (raw_j + BW_GRAM_SIZE > image.height || col_j + BW_GRAM_SIZE > image.width) ? 0 : 1;
-		} else if (raw_j + BW_GRAM_SIZE > image.height || col_j + BW_GRAM_SIZE > image.width) {
-			return -1;
-		}
+	if (raw_i + kernel->size > image->height || col_i + kernel->size > image->width) {
+		return (raw_j + kernel->size > image->height || col_j + kernel->size > image->width) ? 0 : 1;
+	} else if (raw_j + kernel->size > image->height || col_j + kernel->size > image->width) {
+		return -1;
 	}
 
 	/* compare grams */
-	for (volatile int32_t r = 0; r < BW_GRAM_SIZE; r++) {
-		for (volatile int32_t c = 0; c < BW_GRAM_SIZE; c++) {
-			if (*curr_i == 0) {
-				if (*curr_j == 1) {
-					return -1;
-				}
-			} else if (*curr_j == 0) {
-				return 1;
+	{
+		uint64_t gram_i = kernel->at(kernel, &image->bitboard, raw_i, col_i), gram_j = kernel->at(kernel, &image->bitboard, raw_j, col_j);
+		return gram_i < gram_j ? -1 : gram_i > gram_j;
+	}
+}
+
+/**
+ * \brief 	    path of an image
+ * \param[out] 	path: FILENAME_MAX chars
+ * \param[in] 	directory: image file path respect its set.
+ */
+void
+image_path(char* path, const char* directory)
+{
+	strcpy(path, source_directory);
+	strcat(path, "/");
+	strcat(path, directory);
+	strcat(path, IMAG_FORMAT);
+}
+
+/**
+ * \brief 	    path of the synthesis file of an image
+ * \param[out] 	path: FILENAME_MAX chars
+ * \param[in] 	directory: image file path respect its set.
+ */
+void
+synthesis_path(char* path, const char* directory)
+{
+	strcpy(path, destination_directory);
+	strcat(path, "/");
+	strcat(path, directory);
+	strcat(path, BIN_FORMAT);
+}
+
+/**
+ * \brief 	    estimated peak memory of the synthesis of an image
+ * \note 	    the shape is read from the header of the image. The distinct grams are
+ *              estimated as a FOOTPRINT_DISTINCT-th of the grams; the hash table takes up
+ *              to 6 slots for each distinct gram while it grows and the list of packed
+ *              grams of the sort up to twice its size. Used to schedule the largest images first and to
+ *              admit the images within the memory budget.
+ * \param[in] 	directory: image file path respect its set.
+ * \return 		estimated bytes, 0 if the image can not be read.
+ */
+size_t
+input_footprint(const char* directory)
+{
+	ppm_t image;
+	char source_dir[FILENAME_MAX] = {'\0'};
+	size_t num_of_pixels, num_of_grams, distinct, table, list, footprint;
+
+	image_path(source_dir, directory);
+	if (ppm_open(&image, source_dir) != PPM_OK) {
+		return 0;
+	}
+	num_of_pixels = (size_t)image.width * (size_t)image.height;
+	num_of_grams = gram_count(kernel, image.width, image.height);
+	ppm_close(&image);
+	if (model == 1) {
+		return layer_footprint(image.width, image.height, kernel->size, layers);
+	}
+
+	distinct = num_of_grams / FOOTPRINT_DISTINCT;
+	if (kernel->bits < 64 && distinct > (size_t)(UINT64_C(1) << kernel->bits)) {
+		distinct = (size_t)(UINT64_C(1) << kernel->bits);
+	}
+	table = 6*distinct*(sizeof (uint64_t) + sizeof (uint32_t) + sizeof (size_t));
+	list = distinct*(2*sizeof (uint64_t) + 2*sizeof (size_t) + sizeof (int32_t));
+
+	/* bitboard and recurrence map */
+	footprint = num_of_pixels/8 + num_of_pixels*sizeof (float);
+	switch (engine) {
+		case ENGINE_SORT:
+			footprint += num_of_pixels*(sizeof (size_t) + sizeof (int32_t)) + 2*distinct*sizeof (uint64_t);
+			break;
+		case ENGINE_STREAM:
+			footprint = table + list;
+			break;
+		default:
+			if (engine == ENGINE_RADIX && num_of_pixels < PARALLEL_PIXELS) {
+				footprint += num_of_grams*(2*sizeof (uint64_t) + 2*sizeof (size_t) + sizeof (int32_t));
+			} else {
+				footprint += num_of_grams*sizeof (uint64_t) + (num_of_pixels < PARALLEL_PIXELS ? 1 : 2)*table + list;
 			}
-			curr_i++;
-			curr_j++;
+			break;
+	}
+
+	/* the opinions are freed before the grams are counted */
+	if (model == 2 && footprint < num_of_pixels/8 + opinion_footprint(image.width, image.height, area)) {
+		footprint = num_of_pixels/8 + opinion_footprint(image.width, image.height, area);
+	}
+	return footprint;
+}
+
+/**
+ * \brief 	    open the synthesis file of an image
+ * \note 	    In the event of an error, it writes to stderr the communicating thread and error details.
+ * \param[in] 	directory: image file path respect its set.
+ * \return 		the file opened for writing, NULL if it can not be created.
+ */
+FILE*
+output_open(const char* directory)
+{
+	FILE* fp;
+	char binary_dir[FILENAME_MAX] = {'\0'};
+
+	synthesis_path(binary_dir, directory);
+	fp = fopen(binary_dir, "wb");
+	if (fp == NULL) {
+		pthread_mutex_lock(&error_mutex);
+		{
+			fflush(stderr);
+			fprintf(stderr, "\t> %lu: file not found: input %s\n", (unsigned long)pthread_self(), binary_dir);
 		}
-		curr_i += image.width - BW_GRAM_SIZE;
-		curr_j += image.width - BW_GRAM_SIZE;
+		pthread_mutex_unlock(&error_mutex);
 	}
-	return 0;
+	return fp;
 }
 
-#endif  /* MODEL == 0 */
+/**
+ * \brief 	    read an image ahead of its synthesis, function of the readers
+ * \note 	    the image is hashed, which leaves it in the page cache for its mapping.
+ * \param[in] 	index: index of the directory of the image
+ * \return 		0: any error.
+ *              1: the image can not be read, its worker reads it.
+ */
+int
+input_read(int32_t index)
+{
+	char input[FILENAME_MAX];
+
+	image_path(input, directories[index]);
+	return cache_hash(input, &keys[index]);
+}
+
+/**
+ * \brief 	    end of a synthesis file, function of the writers
+ * \note 	    a closed synthesis file is recorded in the manifest. In the event of an
+ *              error, it writes to stderr the communicating thread and error details, and
+ *              stops the pool.
+ * \param[in] 	index: index of the directory of the image
+ * \param[in] 	error: 1 if the file could not be closed
+ */
+void
+output_written(int32_t index, int error)
+{
+	char input[FILENAME_MAX], binary[FILENAME_MAX];
+	bool recorded;
+
+	image_path(input, directories[index]);
+	synthesis_path(binary, directories[index]);
+	recorded = !error && cache_record(&main_cache, input, binary, keys[index]) == 0;
+	if (!recorded) {
+		pthread_mutex_lock(&error_mutex);
+		{
+			flag = false;
+			fflush(stderr);
+			if (error) {
+				fprintf(stderr, "\t> %lu: write error: output %s\n", (unsigned long)pthread_self(), directories[index]);
+			} else {
+				fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+			}
+			fprintf(stderr, "\t> %lu: %s not synthesized\n", (unsigned long)pthread_self(), directories[index]);
+		}
+		pthread_mutex_unlock(&error_mutex);
+	}
+}
 
 /**
  * \brief 	    perform a synthesis of the image
- * \note 	    read the image, compute the synthesis, save synthesis.
+ * \note 	    read the image, compute the synthesis, save synthesis. The synthesis file is
+ *              closed by the writers of the pipeline.
  *              In the event of an error, it writes to stderr the communicating thread and error details.
- * \param[in] 	directory: image file path respect its set.
+ * \param[in] 	index: index of the directory of the image
+ * \param[in] 	arena: buffers of the worker
  * \return 		0: any error.
  *              1: error encountered.
  */
 int
-synth(char* directory)
+synth(int32_t index, arena_t* arena)
 {
+	char* directory = directories[index];
 	image_t my_image;
 	size_t num_of_pixels;
 
-	/* read image */
+	BENCH_START();
+	TRACE_BEGIN("synth", directory);
+	TRACE_BEGIN("read", NULL);
+
+	/* map image */
 	{
-		FILE* fp;
 		char source_dir[FILENAME_MAX] = {'\0'};
+		int output;
 
-		strcpy(source_dir, source_directory);
-		strcat(source_dir, "/");
-		strcat(source_dir, directory);
-		strcat(source_dir, IMAG_FORMAT);
-		fp = fopen(source_dir, "rb");
-		if (fp == NULL) {
-			pthread_mutex_lock(&error_mutex);
-			{
-				fflush(stderr);
-				fprintf(stderr, "\t> %lu: file not found: input %s\n", (unsigned long)pthread_self(), source_dir);
-			}
-			pthread_mutex_unlock(&error_mutex);
-		}
-		if (fscanf(fp, "P6\n%d %d\n255", &my_image.width, &my_image.height) != 2) {
+		image_path(source_dir, directory);
+		output = ppm_open(&my_image.source, source_dir);
+		if (output != PPM_OK) {
 			pthread_mutex_lock(&error_mutex);
 			{
 				fflush(stderr);
-				fprintf(stderr, "\t> %lu: image format error\n", (unsigned long)pthread_self());
+				if (output == PPM_NOT_FOUND) {
+					fprintf(stderr, "\t> %lu: file not found: input %s\n", (unsigned long)pthread_self(), source_dir);
+				} else if (output == PPM_FORMAT_ERROR) {
+					fprintf(stderr, "\t> %lu: image format error\n", (unsigned long)pthread_self());
+				} else {
+					fprintf(stderr, "\t> %lu: pixels reading error\n", (unsigned long)pthread_self());
+				}
 			}
 			pthread_mutex_unlock(&error_mutex);
 			return 1;
 		}
-		fgetc(fp);  // used to skip the character newline
+		my_image.width = my_image.source.width;
+		my_image.height = my_image.source.height;
 		num_of_pixels = (size_t)my_image.width * (size_t)my_image.height;
-		my_image.bitboard = calloc(3*num_of_pixels, sizeof (uint8_t));
-		if (my_image.bitboard == NULL) {
-			pthread_mutex_lock(&error_mutex);
-			{
-				fflush(stderr);
-				fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
-			}
-			pthread_mutex_unlock(&error_mutex);
+	}
+	BENCH_STAGE(BENCH_READ);
+	TRACE_END("read");
+
+	/* written from the mapping to the synthesis file: the rows streamed, or the layers of the multilayer model */
+	if (model == 1 || engine == ENGINE_STREAM) {
+		FILE* fp;
+		int output;
+
+		TRACE_BEGIN("count", NULL);
+		fp = output_open(directory);
+		if (fp == NULL) {
+			ppm_close(&my_image.source);
 			return 1;
 		}
-		if (fread(my_image.bitboard, sizeof (uint8_t), 3*num_of_pixels, fp) != 3*num_of_pixels) {
+		output = model == 1 ? layer_synth(kernel->size, layers, &my_image.source, fp, arena) :
+			stream_synth(model, kernel, &my_image.source, fp);
+		ppm_close(&my_image.source);
+		if (output) {
+			fclose(fp);
 			pthread_mutex_lock(&error_mutex);
 			{
 				fflush(stderr);
-				fprintf(stderr, "\t> %lu: pixels reading error\n", (unsigned long)pthread_self());
+				if (output == 1) {
+					fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+				} else {
+					fprintf(stderr, "\t> %lu: write error: output %s\n", (unsigned long)pthread_self(), directory);
+				}
 			}
 			pthread_mutex_unlock(&error_mutex);
 			return 1;
 		}
-		fclose(fp);
+		pipeline_close(&main_pipeline, fp, index);
+		BENCH_STAGE(BENCH_COUNT);
+		BENCH_END(directory, num_of_pixels);
+		TRACE_END("count");
+		TRACE_END("synth");
+		return 0;
 	}
 
-#if MODEL == 0
-	/* Optimisation: compression to bw bitboard */
+	/* Optimisation: compression to bw bitboard around the median brightness, of the opinions for the opinion model */
 	{
-		float *bright = calloc(num_of_pixels, sizeof (float)), *cpy_bright = calloc(num_of_pixels, sizeof (float));
-		float median_bright;
-
-		if (bright == NULL) {
-			pthread_mutex_lock(&error_mutex);
-			{
-				fflush(stderr);
-				fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
-			}
-			pthread_mutex_unlock(&error_mutex);
-			return 1;
+		uint32_t median = 0;
+		int output;
+
+		TRACE_BEGIN("binarize", NULL);
+		my_image.bitboard.words = arena_calloc(arena, ARENA_BITBOARD,
+			bitboard_shape(&my_image.bitboard, my_image.width, my_image.height) * sizeof (uint64_t));
+		if (my_image.bitboard.words == NULL) {
+			output = 1;
+		} else if (model == 2) {
+			output = opinion_ppm(&my_image.source, area, confidence, num_of_pixels < PARALLEL_PIXELS ? 1 : pool_share(&main_pool),
+				&my_image.bitboard, NULL);
+		} else {
+			TRACE_BEGIN("median", NULL);
+			output = binarize_ppm_median(&my_image.source, &median);
+			BENCH_STAGE(BENCH_MEDIAN);
+			TRACE_END("median");
+			output = output || binarize_ppm_threshold(&my_image.source, median, &my_image.bitboard);
 		}
-		if (cpy_bright == NULL) {
+		BENCH_STAGE(BENCH_BINARIZE);
+		TRACE_END("binarize");
+		if (output) {
 			pthread_mutex_lock(&error_mutex);
 			{
 				fflush(stderr);
 				fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
 			}
 			pthread_mutex_unlock(&error_mutex);
+			ppm_close(&my_image.source);
 			return 1;
 		}
-		for (size_t bit_index = 0; bit_index < num_of_pixels; ++bit_index) {
-			uint8_t r = my_image.bitboard[3*bit_index],
-				g = my_image.bitboard[3*bit_index + 1],
-				b = my_image.bitboard[3*bit_index + 2],
-				min = r < g ? (r < b ? r : b) : (g < b ? g : b),
-				max = r >= g ? (r >= b ? r : b) : (g >= b ? g : b);
-			bright[bit_index] = ((float)min/255 + (float)max/255)/2;
-		}
-		memcpy(cpy_bright, bright, num_of_pixels*sizeof (float));
-		median_bright = *(float*)select(cpy_bright, num_of_pixels, sizeof (float), num_of_pixels/2, std_cmp, NULL);
-		for (size_t bit_index = 0; bit_index < num_of_pixels; ++bit_index)
-			my_image.bitboard[bit_index] = (uint8_t)(bright[bit_index] >= median_bright);
-		free(cpy_bright);
-		free(bright);
 	}
+	TRACE_BEGIN("count", NULL);
+	ppm_close(&my_image.source);
 
-	my_image.bitboard = realloc(my_image.bitboard, num_of_pixels * sizeof (uint8_t));
-
-	/* perform analysis on my_image.bitboard*/
+	/* perform analysis on my_image.bitboard */
 	{
-		darr_t my_list = empty_vec;
-		size_t* index_matrix;
+		darr_t* my_list = &arena->list;
+		size_t* index_matrix = NULL;
+		uint64_t* codes = NULL;
+		const uint64_t* grams = NULL;
+		hash_t table = {0};
 		uint32_t* recurrence;
 		float* recurrence_map;
 		uint32_t size_list = 0;
-
-		/* build matrix of indices */
-		index_matrix = calloc(num_of_pixels, sizeof (size_t));
-		if (index_matrix == NULL) {
-			pthread_mutex_lock(&error_mutex);
-			{
-				fflush(stderr);
-				fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
-			}
-			pthread_mutex_unlock(&error_mutex);
-			return 1;
-		}
-		for (size_t i = 0; i < num_of_pixels; ++i)
-			index_matrix[i] = i;
-
-		/* sort used to sort the matrix of indices */
-		sort(index_matrix, num_of_pixels, sizeof (size_t), cmp, &my_image);
-
-		/* make list of data */
-		{
-			size_t i = 0;
-			int32_t max_num_of_grams = (my_image.width-1+BW_GRAM_SIZE)*(my_image.height-1+BW_GRAM_SIZE);
-			recurrence = calloc(max_num_of_grams, sizeof (int32_t));
-			if (recurrence == NULL) {
+		bool parallel = engine != ENGINE_SORT && num_of_pixels >= PARALLEL_PIXELS;
+		int32_t num_of_bands = parallel ? pool_share(&main_pool) : 1;
+		int error = 1;
+
+		if (engine == ENGINE_SORT) {
+			/* build matrix of indices */
+			index_matrix = arena_alloc(arena, ARENA_INDEX, num_of_pixels * sizeof (size_t));
+			if (index_matrix == NULL) {
 				pthread_mutex_lock(&error_mutex);
 				{
 					fflush(stderr);
 					fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
 				}
 				pthread_mutex_unlock(&error_mutex);
-				return 1;
+				goto end;
 			}
-			while (i < num_of_pixels) {
-				uint8_t* curr;
-				size_t j = i, index = index_matrix[i];
-				int32_t counter = 1;
+			for (size_t i = 0; i < num_of_pixels; ++i)
+				index_matrix[i] = i;
 
-				curr = my_image.bitboard + index;
+			/* sort used to sort the matrix of indices */
+			sort(index_matrix, num_of_pixels, sizeof (size_t), cmp, &my_image);
 
-				/* check the index, if it is close the margin the algorithm ends */
-				if (index / (size_t)my_image.width + BW_GRAM_SIZE > my_image.height ||
-					index % (size_t)my_image.width + BW_GRAM_SIZE > my_image.width) {
-					break;
+			/* make list of data */
+			{
+				size_t i = 0;
+				int32_t max_num_of_grams = (my_image.width-1+kernel->size)*(my_image.height-1+kernel->size);
+				recurrence = arena_alloc(arena, ARENA_RECURRENCE, max_num_of_grams * sizeof (int32_t));
+				if (recurrence == NULL) {
+					pthread_mutex_lock(&error_mutex);
+					{
+						fflush(stderr);
+						fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+					}
+					pthread_mutex_unlock(&error_mutex);
+					goto end;
 				}
+				while (i < num_of_pixels) {
+					size_t j = i, index = index_matrix[i];
+					uint64_t code;
+					int32_t counter = 1;
+
+					/* check the index, if it is close the margin the algorithm ends */
+					if (index / (size_t)my_image.width + (size_t)kernel->size > (size_t)my_image.height ||
+						index % (size_t)my_image.width + (size_t)kernel->size > (size_t)my_image.width) {
+						break;
+					}
 
-				/* the gram exists, so it is pushed on the list */
-				{
-					for (int32_t raw = 0; raw < BW_GRAM_SIZE; ++raw)
-						if (darr_write(
-								curr + raw*my_image.width,
-								BW_GRAM_SIZE * sizeof (uint8_t),
-								BW_GRAM_SIZE*BW_GRAM_SIZE * size_list + raw*BW_GRAM_SIZE,
-								&my_list)) {
-							pthread_mutex_lock(&error_mutex);
-							{
-								fflush(stderr);
-								fprintf(stderr, "\t> %lu: write error on the dynamic array\n", (unsigned long)pthread_self());
+					/* the gram exists, so it is pushed on the list */
+					code = kernel->at(kernel, &my_image.bitboard, index / my_image.width, index % my_image.width);
+					if (darr_write(&code, sizeof (uint64_t), sizeof (uint64_t) * (size_t)size_list, my_list)) {
+						pthread_mutex_lock(&error_mutex);
+						{
+							fflush(stderr);
+							fprintf(stderr, "\t> %lu: write error on the dynamic array\n", (unsigned long)pthread_self());
+						}
+						pthread_mutex_unlock(&error_mutex);
+						goto end;
+					}
+
+					/* compare each gram with the current one until find a different one */
+					{
+						while (j + 1 < num_of_pixels) {
+							++j;
+							if (cmp(index_matrix+i, index_matrix+j, &my_image)) {
+								recurrence[size_list] = counter;
+								i = j; // pass at next iteration
+								break;
+							} else {
+								++counter;
 							}
-							pthread_mutex_unlock(&error_mutex);
-							return 1;
 						}
+						if (j + 1 == num_of_pixels) { // no break
+							recurrence[size_list] = counter;
+							i = j + 1; // finish writing
+						}
+					}
+					++size_list;
+				}
+				grams = my_list->array;
+			}
+		} else if (engine == ENGINE_RADIX && !parallel) {
+			/* encode the grams and sort them */
+			{
+				size_t num_of_grams = gram_count(kernel, my_image.width, my_image.height);
+				uint64_t* scratch_keys;
+				size_t* scratch_values;
+
+				codes = arena_alloc(arena, ARENA_CODES, num_of_grams * sizeof (uint64_t));
+				index_matrix = arena_alloc(arena, ARENA_INDEX, num_of_grams * sizeof (size_t));
+				scratch_keys = arena_alloc(arena, ARENA_SORT_KEYS, num_of_grams * sizeof (uint64_t));
+				scratch_values = arena_alloc(arena, ARENA_SORT_VALUES, num_of_grams * sizeof (size_t));
+				if (codes == NULL || index_matrix == NULL || scratch_keys == NULL || scratch_values == NULL) {
+					pthread_mutex_lock(&error_mutex);
+					{
+						fflush(stderr);
+						fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+					}
+					pthread_mutex_unlock(&error_mutex);
+					goto end;
+				}
+				gram_encode(kernel, &my_image.bitboard, codes, index_matrix);
+
+				/* radix sort used to group the equal grams */
+				if (radix_sort(codes, index_matrix, num_of_grams, kernel->bits, scratch_keys, scratch_values)) {
+					pthread_mutex_lock(&error_mutex);
+					{
+						fflush(stderr);
+						fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+					}
+					pthread_mutex_unlock(&error_mutex);
+					goto end;
 				}
 
-				/* compare each gram with the current one until find a different one */
-				{
-					while (j + 1 < num_of_pixels) {
+				/* make list of data */
+				recurrence = arena_alloc(arena, ARENA_RECURRENCE, num_of_grams * sizeof (int32_t));
+				if (recurrence == NULL) {
+					pthread_mutex_lock(&error_mutex);
+					{
+						fflush(stderr);
+						fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+					}
+					pthread_mutex_unlock(&error_mutex);
+					goto end;
+				}
+				for (size_t i = 0; i < num_of_grams; ++size_list) {
+					size_t j = i + 1;
+
+					while (j < num_of_grams && codes[j] == codes[i])
 						++j;
-						if (cmp(index_matrix+i, index_matrix+j, &my_image)) {
-							recurrence[size_list] = counter;
-							i = j; // pass at next iteration
-							break;
-						} else {
-							++counter;
+					recurrence[size_list] = (int32_t)(j - i);
+
+					/* the distinct grams are compacted at the head of the codes */
+					codes[size_list] = codes[i];
+					i = j;
+				}
+				grams = codes;
+			}
+		} else {
+			/* count the grams in a hash table */
+			{
+				size_t num_of_grams = gram_count(kernel, my_image.width, my_image.height);
+				uint64_t* keys;
+				size_t* slots;
+
+				codes = arena_alloc(arena, ARENA_CODES, num_of_grams * sizeof (uint64_t));
+				if (codes == NULL || hash_alloc(&table, 0, arena)) {
+					pthread_mutex_lock(&error_mutex);
+					{
+						fflush(stderr);
+						fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+					}
+					pthread_mutex_unlock(&error_mutex);
+					goto end;
+				}
+				if (parallel) {
+					/* large image: a thread per band of rows */
+					if (band_count(kernel, &my_image.bitboard, codes, &table, num_of_bands)) {
+						pthread_mutex_lock(&error_mutex);
+						{
+							fflush(stderr);
+							fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
 						}
+						pthread_mutex_unlock(&error_mutex);
+						goto end;
 					}
-					if (j + 1 == num_of_pixels) { // no break
-						recurrence[size_list] = counter;
-						i = j + 1; // finish writing
+				} else {
+					uint64_t* curr_code = codes;
+
+					gram_encode(kernel, &my_image.bitboard, codes, NULL);
+					for (int32_t raw = 0; raw + kernel->size <= my_image.height; ++raw) {
+						for (int32_t col = 0; col + kernel->size <= my_image.width; ++col) {
+							if (hash_insert(&table, *(curr_code++), (size_t)raw*my_image.width + col)) {
+								pthread_mutex_lock(&error_mutex);
+								{
+									fflush(stderr);
+									fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+								}
+								pthread_mutex_unlock(&error_mutex);
+								goto end;
+							}
+						}
 					}
 				}
-				++size_list;
+
+				/* sort the distinct grams, so the list is the same of the other engines */
+				keys = arena_alloc(arena, ARENA_KEYS, table.size * sizeof (uint64_t));
+				slots = arena_alloc(arena, ARENA_SLOTS, table.size * sizeof (size_t));
+				recurrence = arena_alloc(arena, ARENA_RECURRENCE, table.size * sizeof (int32_t));
+				if (keys == NULL || slots == NULL || recurrence == NULL) {
+					pthread_mutex_lock(&error_mutex);
+					{
+						fflush(stderr);
+						fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+					}
+					pthread_mutex_unlock(&error_mutex);
+					goto end;
+				}
+				if (hash_sorted(&table, keys, slots, kernel->bits)) {
+					pthread_mutex_lock(&error_mutex);
+					{
+						fflush(stderr);
+						fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+					}
+					pthread_mutex_unlock(&error_mutex);
+					goto end;
+				}
+
+				/* make list of data */
+				for (; size_list < table.size; ++size_list)
+					recurrence[size_list] = (int32_t)table.counts[slots[size_list]];
+				grams = keys;
 			}
 		}
 
+		BENCH_STAGE(BENCH_COUNT);
+		TRACE_END("count");
+		TRACE_BEGIN("map", NULL);
+
 		/* make a matrix with float values */
-		recurrence_map = calloc(num_of_pixels, sizeof (float));
+		recurrence_map = arena_calloc(arena, ARENA_MAP, num_of_pixels * sizeof (float));
 		if (recurrence_map == NULL) {
 			pthread_mutex_lock(&error_mutex);
 			{
@@ -359,110 +661,165 @@ synth(char* directory)
 				fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
 			}
 			pthread_mutex_unlock(&error_mutex);
-			return 1;
+			goto end;
 		}
-		{
+		if (parallel) {
+			if (band_map(kernel, &my_image.bitboard, codes, &table, recurrence_map, num_of_bands)) {
+				pthread_mutex_lock(&error_mutex);
+				{
+					fflush(stderr);
+					fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
+				}
+				pthread_mutex_unlock(&error_mutex);
+				goto end;
+			}
+		} else if (engine == ENGINE_HASH) {
+			uint64_t* curr_code = codes;
+
+			for (int32_t raw = 0; raw + kernel->size <= my_image.height; ++raw)
+				for (int32_t col = 0; col + kernel->size <= my_image.width; ++col)
+					recurrence_map[(size_t)raw*my_image.width + col] = 1./hash_find(&table, *(curr_code++));
+		} else {
 			size_t* curr_index = index_matrix;
 
-			for (int32_t i = 0; i < size_list; ++i) {
+			for (uint32_t i = 0; i < size_list; ++i) {
 				int32_t curr_ric = recurrence[i];
 				for (volatile int32_t j = 0; j < curr_ric; ++j)
 					recurrence_map[*(curr_index++)] = 1./curr_ric;
 			}
 		}
+		BENCH_STAGE(BENCH_MAP);
+		TRACE_END("map");
+		TRACE_BEGIN("write", NULL);
 
 		/* write on file grams and occurrence */
 		{
-			FILE* fp;
-			char binary_dir[FILENAME_MAX] = {'\0'};
-
-			strcpy(binary_dir, destination_directory);
-			strcat(binary_dir, "/");
-			strcat(binary_dir, directory);
-			strcat(binary_dir, BIN_FORMAT);
-			fp = fopen(binary_dir, "wb");
+			FILE* fp = output_open(directory);
+			uint8_t* row = arena_alloc(arena, ARENA_ROW, my_image.width * sizeof (uint8_t));
+			binfile_t file;
+			int output;
+
 			if (fp == NULL) {
+				goto end;
+			}
+			if (row == NULL) {
 				pthread_mutex_lock(&error_mutex);
 				{
 					fflush(stderr);
-					fprintf(stderr, "\t> %lu: file not found: input %s\n", (unsigned long)pthread_self(), binary_dir);
+					fprintf(stderr, "\t> %lu: out of memory\n", (unsigned long)pthread_self());
 				}
 				pthread_mutex_unlock(&error_mutex);
+				fclose(fp);
+				goto end;
 			}
 
-			{
-				int32_t s = BW_GRAM_SIZE;
-
-				fwrite(&s, sizeof (int32_t), 1, fp);
+			output = binfile_create(&file, fp, model, kernel->size, my_image.width, my_image.height);
+			file.header.parameters[0] = parameters[0];
+			file.header.parameters[1] = parameters[1];
+			output = output ||
+					 binfile_write_grams(&file, grams, size_list) ||
+					 binfile_begin(&file, BINFILE_COUNTS, BINFILE_RAW) ||
+					 binfile_write(&file, recurrence, size_list * sizeof (uint32_t)) ||
+					 binfile_begin(&file, BINFILE_MAP, BINFILE_RAW) ||
+					 binfile_write(&file, recurrence_map, num_of_pixels * sizeof (float)) ||
+					 binfile_begin(&file, BINFILE_BITBOARD, BINFILE_RAW);
+			for (int32_t raw = 0; !output && raw < my_image.height; ++raw) {
+				bitboard_unpack(&my_image.bitboard, raw, row);
+				output = binfile_write(&file, row, my_image.width * sizeof (uint8_t));
 			}
+			output = output || binfile_finish(&file, gram_count(kernel, my_image.width, my_image.height));
+			if (output) {
+				fclose(fp);
+				pthread_mutex_lock(&error_mutex);
+				{
+					fflush(stderr);
+					fprintf(stderr, "\t> %lu: write error: output %s\n", (unsigned long)pthread_self(), directory);
+				}
+				pthread_mutex_unlock(&error_mutex);
+				goto end;
+			}
+			pipeline_close(&main_pipeline, fp, index);
+		}
 
-			fwrite(&size_list, sizeof (int32_t), 1, fp);
-
-			fwrite(my_list.array, sizeof (uint8_t), size_list*BW_GRAM_SIZE*BW_GRAM_SIZE, fp);
-			fwrite(recurrence, sizeof (int32_t), size_list, fp);
-
-			fwrite(&my_image.width, sizeof (int32_t), 1, fp);
-			fwrite(&my_image.height, sizeof (int32_t), 1, fp);
-			fwrite(recurrence_map, sizeof (float), num_of_pixels, fp);
+		error = 0;
 
-			fwrite(my_image.bitboard, sizeof (uint8_t), num_of_pixels, fp);
-			fclose(fp);
+	end:
+		hash_free(&table);
+		if (error) {
+			return 1;
 		}
-
-		free(recurrence_map);
-		free(recurrence);
-		free(index_matrix);
-		darr_free(my_list);
 	}
-#endif  /* defined(BW_GRAM) */
-
-	free(my_image.bitboard);
+	BENCH_STAGE(BENCH_WRITE);
+	BENCH_END(directory, num_of_pixels);
+	TRACE_END("write");
+	TRACE_END("synth");
 
 	return 0;
 }
 
 /**
  * \brief 	    activation function of the pool
- * \note 	    extract directory that will be pass at the synth function.
+ * \note 	    pop the directories of the worker, largest first, then steal from the others.
+ *              The buffers kept by the worker between the images count in the memory budget.
  *              In the event of an error, it writes to stderr the communicating thread and error details.
- * \param[in] 	addr: unused
+ * \param[in] 	addr: index of the worker
  * \return 		'NULL'
  */
 void*
 activation(void* addr)
 {
+	int32_t worker = (int32_t)(intptr_t)addr;
+	arena_t arena = {0};
+
+	TRACE_THREAD("worker");
 	while (flag) {
+		char input[FILENAME_MAX], binary[FILENAME_MAX];
 		int32_t index, output;
 
-		/* pop next index */
-		{
-			pthread_mutex_lock(&main_list.mutex);
-			{
-				if (main_list.index < main_list.count) {
-					index = main_list.index;
-
-					#if PROGRESS == 1
-						float prog = 100.*(float)(main_list.index+1)/main_list.count;
-						fflush(stdout);
-						printf("\033[A");
-						printf("\tprogress: %.2f%%\n", prog);
-					#endif /* PROGRESS == 1*/
+		/* pop next index, within the memory budget */
+		TRACE_BEGIN("pool wait", NULL);
+		index = pool_pop(&main_pool, worker);
+		TRACE_END("pool wait");
 
-					++main_list.index;
-				} else {
-					index = main_list.count;
-				}
-			}
-			pthread_mutex_unlock(&main_list.mutex);
+		/* release the buffers for a job of another worker */
+		if (index == POOL_TRIM) {
+			arena_free(&arena);
+			continue;
 		}
 
 		/* end of pool */
-		if (index == main_list.count) {
+		if (index == POOL_EMPTY) {
 			break;
 		}
 
-		/* synthesis */
-		output = synth(main_list.directories[index]);
+		#if PROGRESS == 1
+		{
+			float prog = 100.*(float)(atomic_fetch_add(&started, 1)+1)/count;
+			printf("\033[A\tprogress: %.2f%%\n", prog);
+			fflush(stdout);
+		}
+		#endif /* PROGRESS == 1*/
+
+		/* an image already synthesized, under this name or another one, is not synthesized again,
+		   the image is hashed by a reader if it was read ahead */
+		image_path(input, directories[index]);
+		synthesis_path(binary, directories[index]);
+		TRACE_BEGIN("cache lookup", directories[index]);
+		output = pipeline_take(&main_pipeline, index) ? cache_match(&main_cache, input, binary, keys[index]) :
+			cache_lookup(&main_cache, input, binary, &keys[index]);
+		TRACE_END("cache lookup");
+		if (output == CACHE_HIT) {
+			/* the buffers of the previous images are still held */
+			pool_done(&main_pool, worker, arena_size(&arena));
+			continue;
+		}
+
+		/* synthesis, reusing the buffers of the previous images, its file is recorded by a writer */
+		arena_reset(&arena);
+		output = synth(index, &arena);
+		TRACE_BEGIN("pool done", NULL);
+		pool_done(&main_pool, worker, arena_size(&arena));
+		TRACE_END("pool done");
 
 		/* error check */
 		if(output) {
@@ -470,12 +827,13 @@ activation(void* addr)
 			{
 				flag = false;
 				fflush(stderr);
-				fprintf(stderr, "\t> %lu: %s not synthesized\n", (unsigned long)pthread_self(), main_list.directories[index]);
+				fprintf(stderr, "\t> %lu: %s not synthesized\n", (unsigned long)pthread_self(), directories[index]);
 			}
 			pthread_mutex_unlock(&error_mutex);
 			break;
 		}
 	}
+	arena_free(&arena);
 	return NULL;
 }
 
@@ -486,49 +844,176 @@ activation(void* addr)
 
 /**
  * \brief 	    main
- * \note 	    init the pool of processed and start it.
- * \param[in] 	argc: is 2
+ * \note 	    init the pool of processed and start it. The images whose synthesis file is
+ *              current, by the manifest of the previous run, are not in the pool.
+ * \param[in] 	argc: at least 2
  * \param[in] 	argv[0]: current executable name
  *              argv[1]: input_file name
+ *              argv[2...]: parameters 'name=value' (optional, default in config.h): 'model',
+ *              'gram_size', 'layers', 'area', 'confidence', 'engine', 'threads', or 'config' reading
+ *              them from a file.
+ *              A number is the engine, as 'engine=number'.
  * \return 		'EXIT_SUCCESS': any error
  *              'EXIT_FAILURE': error encountered
  */
 int
 main(int argc, char** argv)
 {
-	if(argc != 2) return EXIT_FAILURE;
+	char manifest[FILENAME_MAX] = {'\0'};
+	int32_t num_of_works;
+	param_t param;
+
+	if(argc < 2) return EXIT_FAILURE;
+
+	/* parameters of the run, the kernel of the grams is chosen once */
+	param_default(&param);
+	for (int32_t i = 2; i < argc; ++i) {
+		char assignment[PARAM_LINE];
+		int output;
+
+		snprintf(assignment, PARAM_LINE, strchr(argv[i], '=') == NULL ? "engine=%s" : "%s", argv[i]);
+		output = param_set(&param, assignment);
+		if (output != PARAM_OK) {
+			if (output == PARAM_NOT_FOUND) {
+				fprintf(stderr, "\t> file not found: config %s\n", strchr(argv[i], '=') + 1);
+			} else {
+				fprintf(stderr, output == PARAM_UNKNOWN ? "\t> unknown parameter %s\n" :
+					"\t> parameter out of range %s\n", argv[i]);
+			}
+			return EXIT_FAILURE;
+		}
+	}
+	if (param.model == 1 && layer_bits(param.gram_size, param.layers) > LAYER_MAX_BITS) {
+		fprintf(stderr, "\t> parameter out of range: grams of %d bits, more than %d\n",
+			layer_bits(param.gram_size, param.layers), LAYER_MAX_BITS);
+		return EXIT_FAILURE;
+	}
+	model = param.model;
+	engine = param.engine;
+	layers = param.layers;
+	area = param.area;
+	confidence = param.confidence;
+	if (model == 1) {
+		parameters[0] = layers;
+	} else if (model == 2) {
+		/* the opinion model needs the whole image, it is not streamed */
+		parameters[0] = area;
+		parameters[1] = (int32_t)(confidence * OPINION_SCALE + 0.5);
+		engine = engine == ENGINE_STREAM ? ENGINE_HASH : engine;
+	}
+	kernel = gram_kernel(param.gram_size);
 
-	/* init main_list & flag */
+	/* init main_pool & flag */
 	{
 		FILE* fp = fopen(input_file, "r");
+		size_t* sizes;
 
+		if (fp == NULL) {
+			fprintf(stderr, "\t> file not found: input %s\n", input_file);
+			return EXIT_FAILURE;
+		}
 		fscanf(fp, "%s ", source_directory);  // nota: insert a space avoid reading of \n
 		fscanf(fp, "%s ", destination_directory);
-		fscanf(fp, "%d ", &main_list.count);
-		main_list.directories = calloc(main_list.count, sizeof (char*));
-		for (int32_t i = 0; i < main_list.count; ++i) {
-			main_list.directories[i] = calloc(FILENAME_MAX, sizeof (char));
-			fscanf(fp, "%[^.]%s ", main_list.directories[i], buffer);
+		fscanf(fp, "%d ", &num_of_works);
+		directories = calloc(num_of_works > 0 ? num_of_works : 1, sizeof (char*));
+		sizes = calloc(num_of_works > 0 ? num_of_works : 1, sizeof (size_t));
+
+		/* synthesis files of the previous run */
+		strcpy(manifest, destination_directory);
+		strcat(manifest, "/");
+		strcat(manifest, CACHE_MANIFEST);
+		if (directories == NULL || sizes == NULL || cache_load(&main_cache, manifest, cache_parameters(model, kernel->size, parameters))) {
+			fprintf(stderr, "\t> out of memory\n");
+			return EXIT_FAILURE;
+		}
+
+		/* the current synthesis files are skipped, their buffer is reused */
+		count = 0;
+		for (int32_t i = 0; i < num_of_works; ++i) {
+			char input[FILENAME_MAX], binary[FILENAME_MAX];
+
+			if (directories[count] == NULL) {
+				directories[count] = calloc(FILENAME_MAX, sizeof (char));
+			}
+			fscanf(fp, "%[^.]%s ", directories[count], buffer);
+			image_path(input, directories[count]);
+			synthesis_path(binary, directories[count]);
+			if (cache_current(&main_cache, input, binary) == CACHE_HIT) {
+				continue;
+			}
+			sizes[count] = input_footprint(directories[count]);
+			++count;
 		}
-		pthread_mutex_init(&main_list.mutex, NULL);
-		flag = true;
 		fclose(fp);
 
+		num_of_threads = param.num_of_threads > 0 ? param.num_of_threads : pool_cpu_count();
+		threads = calloc(num_of_threads, sizeof (pthread_t));
+		if (threads == NULL || pool_init(&main_pool, sizes, count, num_of_threads,
+			MEMORY_BUDGET > 0 ? (size_t)MEMORY_BUDGET << 20 : pool_available_memory())) {
+			fprintf(stderr, "\t> out of memory\n");
+			return EXIT_FAILURE;
+		}
+		free(sizes);
+
+		/* readers and writers, in the order of the pool */
+		{
+			int32_t* order = malloc((count > 0 ? count : 1) * sizeof (int32_t));
+
+			keys = calloc(count > 0 ? count : 1, sizeof (uint64_t));
+			if (order != NULL) {
+				pool_order(&main_pool, order);
+			}
+			if (order == NULL || keys == NULL || pipeline_start(&main_pipeline, order, count, PIPELINE_DEPTH,
+				READER_COUNT, WRITER_COUNT, input_read, output_written)) {
+				fprintf(stderr, "\t> out of memory\n");
+				return EXIT_FAILURE;
+			}
+			free(order);
+		}
+		atomic_init(&started, 0);
+		flag = true;
+
 		#if PROGRESS == 1
 			printf("<Subprocess>\n");
-			printf("\tpool: %ld processes, %ld input\n\n", THREAD_COUNT, main_list.count);
+			printf("\tpool: %d processes, %d input, %d current\n\n", num_of_threads, count, num_of_works - count);
 		#endif /* PROGRESS == 1 */
 	}
 
 	/* pool of processes */
-	for (int32_t i = 0; i < THREAD_COUNT; ++i)
-		pthread_create(&threads[i], NULL, activation, NULL);
+	for (int32_t i = 0; i < num_of_threads; ++i)
+		pthread_create(&threads[i], NULL, activation, (void*)(intptr_t)i);
 
-	for (int32_t i = 0; i < THREAD_COUNT; ++i)
+	for (int32_t i = 0; i < num_of_threads; ++i)
 		pthread_join(threads[i], NULL);
 
-	free(main_list.directories);
-	pthread_mutex_destroy(&(main_list.mutex));
+	/* the last synthesis files are closed and recorded */
+	pipeline_stop(&main_pipeline);
+
+	/* the manifest lists the synthesis files of this run */
+	if (cache_save(&main_cache, manifest)) {
+		fprintf(stderr, "\t> write error: output %s\n", manifest);
+		flag = false;
+	}
+	cache_free(&main_cache);
+
+	/* stage timings of the bench build */
+	if (BENCH_REPORT(destination_directory, model, kernel->size, engine, num_of_threads)) {
+		fprintf(stderr, "\t> write error: output %s/%s\n", destination_directory, BENCH_FILE);
+		flag = false;
+	}
+
+	/* spans and counters of the trace build */
+	if (TRACE_DUMP(destination_directory)) {
+		fprintf(stderr, "\t> write error: output %s/%s\n", destination_directory, TRACE_FILE);
+		flag = false;
+	}
+
+	for (int32_t i = 0; i < num_of_works; ++i)
+		free(directories[i]);
+	free(directories);
+	free(keys);
+	free(threads);
+	pool_free(&main_pool);
 
 	return flag ? EXIT_SUCCESS : EXIT_FAILURE;
 }
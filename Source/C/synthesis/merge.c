@@ -0,0 +1,216 @@
+/**
+ * \file 		merge.c
+ * \brief 		define merge_profiles, merge_free
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of merge.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "merge.h"
+#include <stdbool.h>
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		loser_tree_t
+ * \note		Tournament tree of the runs: the node i >= 1 holds the loser of the match
+ *              played in it, the node 0 holds the overall winner. The leaves are the
+ *              nodes count..2*count-1, so any num of runs makes a complete tree.
+*/
+typedef struct
+{
+	int32_t* 	        nodes; 	    /*!< run of each node */
+	size_t* 	        positions; 	/*!< next gram of each run */
+	const profile_t* 	runs; 	    /*!< sorted runs */
+	int32_t 	        count; 	    /*!< num of runs */
+} loser_tree_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+bool 	merge_less(const loser_tree_t*, int32_t, int32_t);
+int32_t merge_play(loser_tree_t*, int32_t);
+void 	merge_replay(loser_tree_t*);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    order of the heads of two runs
+ * \note 	    an exhausted run is greater than any gram, equal grams follow the runs.
+ * \param[in] 	tree: loser tree
+ * \param[in] 	a: first run
+ * \param[in] 	b: second run
+ * \return 		true: if the head of a comes before the head of b
+ */
+bool
+merge_less(const loser_tree_t* tree, int32_t a, int32_t b)
+{
+	bool end_a = tree->positions[a] == tree->runs[a].size, end_b = tree->positions[b] == tree->runs[b].size;
+	uint64_t code_a, code_b;
+
+	if (end_a || end_b) {
+		return !end_a;
+	}
+	code_a = tree->runs[a].codes[tree->positions[a]];
+	code_b = tree->runs[b].codes[tree->positions[b]];
+	return code_a < code_b || (code_a == code_b && a < b);
+}
+
+/**
+ * \brief 	    play the matches of a subtree
+ * \param[in] 	tree: loser tree
+ * \param[in] 	node: root of the subtree
+ * \return 		winner of the subtree.
+ */
+int32_t
+merge_play(loser_tree_t* tree, int32_t node)
+{
+	int32_t left, right;
+
+	if (node >= tree->count) {
+		return node - tree->count;
+	}
+	left = merge_play(tree, 2*node);
+	right = merge_play(tree, 2*node + 1);
+	if (merge_less(tree, left, right)) {
+		tree->nodes[node] = right;
+		return left;
+	}
+	tree->nodes[node] = left;
+	return right;
+}
+
+/**
+ * \brief 	    replay the matches of the winner, after its run advanced
+ * \note 	    only the log2(count) matches on the path of the winner are played.
+ * \param[in] 	tree: loser tree
+ */
+void
+merge_replay(loser_tree_t* tree)
+{
+	int32_t winner = tree->nodes[0];
+
+	for (int32_t node = (winner + tree->count) / 2; node > 0; node /= 2) {
+		if (merge_less(tree, tree->nodes[node], winner)) {
+			int32_t loser = winner;
+			winner = tree->nodes[node];
+			tree->nodes[node] = loser;
+		}
+	}
+	tree->nodes[0] = winner;
+}
+
+/**
+ * \brief 	    merge sorted profiles into one profile
+ * \note 	    the recurrences of the same gram are summed in 64 bits. Each gram costs log2(count)
+ *              comparisons, against count-1 of a linear scan of the heads.
+ * \param[in] 	profiles: profiles to merge, with the same gram size
+ * \param[in] 	count: num of profiles
+ * \param[out] 	result: merged profile, to free with merge_free
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+merge_profiles(const profile_t* profiles, int32_t count, merged_t* result)
+{
+	loser_tree_t tree = {NULL, NULL, profiles, count};
+	size_t capacity = 0;
+
+	result->codes = NULL;
+	result->counts = NULL;
+	result->size = 0;
+	result->total = 0;
+	result->gram_size = count > 0 ? profiles[0].gram_size : 0;
+	for (int32_t i = 0; i < count; ++i) {
+		capacity += profiles[i].size;
+		result->total += profiles[i].total;
+	}
+
+	tree.nodes = malloc((count > 0 ? count : 1) * sizeof (int32_t));
+	tree.positions = calloc(count > 0 ? count : 1, sizeof (size_t));
+	result->codes = malloc((capacity ? capacity : 1) * sizeof (uint64_t));
+	result->counts = malloc((capacity ? capacity : 1) * sizeof (uint64_t));
+	if (tree.nodes == NULL || tree.positions == NULL || result->codes == NULL || result->counts == NULL) {
+		free(tree.nodes);
+		free(tree.positions);
+		merge_free(result);
+		return 1;
+	}
+
+	if (count > 0) {
+		tree.nodes[0] = merge_play(&tree, 1);
+		while (tree.positions[tree.nodes[0]] < profiles[tree.nodes[0]].size) {
+			int32_t winner = tree.nodes[0];
+			uint64_t code = profiles[winner].codes[tree.positions[winner]];
+			uint32_t recurrence = profiles[winner].counts[tree.positions[winner]++];
+
+			if (result->size > 0 && result->codes[result->size - 1] == code) {
+				result->counts[result->size - 1] += recurrence;
+			} else {
+				result->codes[result->size] = code;
+				result->counts[result->size++] = recurrence;
+			}
+			merge_replay(&tree);
+		}
+	}
+
+	free(tree.nodes);
+	free(tree.positions);
+	return 0;
+}
+
+/**
+ * \brief 	    free a merged profile
+ * \param[in] 	merged: merged profile to free
+ */
+void
+merge_free(merged_t* merged)
+{
+	free(merged->codes);
+	free(merged->counts);
+	merged->codes = NULL;
+	merged->counts = NULL;
+	merged->size = 0;
+	merged->total = 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * \file            merge.h
+ * \brief           Loser tree k-way merge of gram profiles
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of merge.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+#ifndef MERGE_H
+#define MERGE_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "profile.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		merged_t
+ * \note		Profile of several syntheses, sorted by packed gram. The summed
+ *              recurrences are 64 bits, as a gram can recur more than 2^32 times
+ *              in the works of an author.
+*/
+typedef struct
+{
+	uint64_t* 	codes; 		/*!< packed grams, ascending */
+	uint64_t* 	counts; 	/*!< summed recurrences of the grams */
+	size_t 		size; 		/*!< num of distinct grams */
+	uint64_t 	total; 		/*!< num of grams */
+	int32_t 	gram_size; 	/*!< side of the grams */
+} merged_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	merge_profiles(const profile_t*, int32_t, merged_t*);
+void 	merge_free(merged_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,445 @@
+/**
+ * \file 		opinion.c
+ * \brief 		define opinion_footprint, opinion_ppm
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of opinion.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "opinion.h"
+#include "binarize.h"
+#include "trace.h"
+#include <math.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+#endif
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define OPINION_TILE_COLS 1024 /* num of columns of a tile, the rows of the interaction area stay in cache */
+
+#if defined(__SSE2__)
+	#define OPINION_SSE2 /* SSE2 kernels */
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define OPINION_AVX /* AVX kernels, selected at runtime */
+#endif
+
+
+/***********************/
+/*!< types definitions */
+/***********************/
+
+/**
+ * \brief 		opinion_band_t
+ * \note		A band of rows of the opinions, updated by a thread. The opinions are
+ *              padded by 'radius' rows and columns of NaN, which interact with none.
+*/
+typedef struct
+{
+	const float* 	src; 		/*!< padded opinions before the update */
+	float* 			dst; 		/*!< padded opinions after the update */
+	size_t 			stride; 	/*!< num of floats of a padded row */
+	int32_t 		radius; 	/*!< half side of the interaction area */
+	float 			bound; 		/*!< max distance of two interacting opinions */
+	int32_t 		width; 		/*!< num of opinions of a row */
+	int32_t 		first_row; 	/*!< first row of the band */
+	int32_t 		num_of_rows; 	/*!< num of rows of the band */
+	float 			delta; 		/*!< max change of an opinion of the band */
+	float (*kernel)(const float*, size_t, int32_t, float, float*, int32_t); 	/*!< update of a row */
+} opinion_band_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+float 	opinion_row_scalar(const float*, size_t, int32_t, float, float*, int32_t);
+#ifdef OPINION_SSE2
+float 	opinion_row_sse2(const float*, size_t, int32_t, float, float*, int32_t);
+#endif /* OPINION_SSE2 */
+#ifdef OPINION_AVX
+float 	opinion_row_avx(const float*, size_t, int32_t, float, float*, int32_t);
+#endif /* OPINION_AVX */
+void* 	opinion_activation(void*);
+int 	opinion_run(opinion_band_t*, int32_t);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    update a row of opinions
+ * \note 	    an opinion becomes the mean of the opinions of its interaction area
+ *              within the bound, itself included.
+ * \param[in] 	src: first opinion of the row, padded
+ * \param[in] 	stride: num of floats of a padded row
+ * \param[in] 	radius: half side of the interaction area
+ * \param[in] 	bound: max distance of two interacting opinions
+ * \param[out] 	dst: first updated opinion of the row, padded
+ * \param[in] 	num_of_cols: num of opinions
+ * \return 		max change of an opinion.
+ */
+float
+opinion_row_scalar(const float* src, size_t stride, int32_t radius, float bound, float* dst, int32_t num_of_cols)
+{
+	float delta = 0;
+
+	for (int32_t col = 0; col < num_of_cols; ++col) {
+		float center = src[col], sum = 0, count = 0, change;
+
+		for (int32_t dy = -radius; dy <= radius; ++dy) {
+			const float* row = src + col + dy*(ptrdiff_t)stride;
+
+			for (int32_t dx = -radius; dx <= radius; ++dx) {
+				float x = row[dx];
+				int in = x - center <= bound && center - x <= bound;
+
+				sum += in ? x : 0;
+				count += in;
+			}
+		}
+		dst[col] = sum / count;
+		change = dst[col] - center;
+		change = change < 0 ? -change : change;
+		delta = change > delta ? change : delta;
+	}
+	return delta;
+}
+
+#ifdef OPINION_SSE2
+/**
+ * \brief 	    update a row of opinions, SSE2 kernel
+ * \note 	    4 opinions at a time, the NaN of the padding fail both comparisons.
+ * \param[in] 	src: first opinion of the row, padded
+ * \param[in] 	stride: num of floats of a padded row
+ * \param[in] 	radius: half side of the interaction area
+ * \param[in] 	bound: max distance of two interacting opinions
+ * \param[out] 	dst: first updated opinion of the row, padded
+ * \param[in] 	num_of_cols: num of opinions
+ * \return 		max change of an opinion.
+ */
+float
+opinion_row_sse2(const float* src, size_t stride, int32_t radius, float bound, float* dst, int32_t num_of_cols)
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1), upper = _mm_set1_ps(bound), lower = _mm_set1_ps(-bound);
+	__m128 change = zero;
+	float delta[4];
+	int32_t col = 0;
+
+	for (; col + 4 <= num_of_cols; col += 4) {
+		__m128 center = _mm_loadu_ps(src + col), sum = zero, count = zero, mean;
+
+		for (int32_t dy = -radius; dy <= radius; ++dy) {
+			const float* row = src + col + dy*(ptrdiff_t)stride;
+
+			for (int32_t dx = -radius; dx <= radius; ++dx) {
+				__m128 x = _mm_loadu_ps(row + dx), distance = _mm_sub_ps(x, center);
+				__m128 in = _mm_and_ps(_mm_cmple_ps(distance, upper), _mm_cmpge_ps(distance, lower));
+
+				sum = _mm_add_ps(sum, _mm_and_ps(in, x));
+				count = _mm_add_ps(count, _mm_and_ps(in, one));
+			}
+		}
+		mean = _mm_div_ps(sum, count);
+		_mm_storeu_ps(dst + col, mean);
+		mean = _mm_sub_ps(mean, center);
+		change = _mm_max_ps(change, _mm_max_ps(mean, _mm_sub_ps(zero, mean)));
+	}
+	_mm_storeu_ps(delta, change);
+	delta[0] = delta[0] > delta[1] ? delta[0] : delta[1];
+	delta[2] = delta[2] > delta[3] ? delta[2] : delta[3];
+	delta[0] = delta[0] > delta[2] ? delta[0] : delta[2];
+	delta[1] = opinion_row_scalar(src + col, stride, radius, bound, dst + col, num_of_cols - col);
+	return delta[0] > delta[1] ? delta[0] : delta[1];
+}
+#endif /* OPINION_SSE2 */
+
+#ifdef OPINION_AVX
+/**
+ * \brief 	    update a row of opinions, AVX kernel
+ * \note 	    8 opinions at a time, the NaN of the padding fail both comparisons.
+ * \param[in] 	src: first opinion of the row, padded
+ * \param[in] 	stride: num of floats of a padded row
+ * \param[in] 	radius: half side of the interaction area
+ * \param[in] 	bound: max distance of two interacting opinions
+ * \param[out] 	dst: first updated opinion of the row, padded
+ * \param[in] 	num_of_cols: num of opinions
+ * \return 		max change of an opinion.
+ */
+__attribute__((target("avx"))) float
+opinion_row_avx(const float* src, size_t stride, int32_t radius, float bound, float* dst, int32_t num_of_cols)
+{
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1);
+	const __m256 upper = _mm256_set1_ps(bound), lower = _mm256_set1_ps(-bound);
+	__m256 change = zero;
+	float delta[8], max = 0;
+	int32_t col = 0;
+
+	for (; col + 8 <= num_of_cols; col += 8) {
+		__m256 center = _mm256_loadu_ps(src + col), sum = zero, count = zero, mean;
+
+		for (int32_t dy = -radius; dy <= radius; ++dy) {
+			const float* row = src + col + dy*(ptrdiff_t)stride;
+
+			for (int32_t dx = -radius; dx <= radius; ++dx) {
+				__m256 x = _mm256_loadu_ps(row + dx), distance = _mm256_sub_ps(x, center);
+				__m256 in = _mm256_and_ps(_mm256_cmp_ps(distance, upper, _CMP_LE_OQ),
+					_mm256_cmp_ps(distance, lower, _CMP_GE_OQ));
+
+				sum = _mm256_add_ps(sum, _mm256_and_ps(in, x));
+				count = _mm256_add_ps(count, _mm256_and_ps(in, one));
+			}
+		}
+		mean = _mm256_div_ps(sum, count);
+		_mm256_storeu_ps(dst + col, mean);
+		mean = _mm256_sub_ps(mean, center);
+		change = _mm256_max_ps(change, _mm256_max_ps(mean, _mm256_sub_ps(zero, mean)));
+	}
+	_mm256_storeu_ps(delta, change);
+	for (int32_t i = 0; i < 8; ++i)
+		max = delta[i] > max ? delta[i] : max;
+	delta[0] = opinion_row_scalar(src + col, stride, radius, bound, dst + col, num_of_cols - col);
+	return delta[0] > max ? delta[0] : max;
+}
+#endif /* OPINION_AVX */
+
+/**
+ * \brief 	    activation function of a band updating its opinions
+ * \note 	    the band is updated by tiles of OPINION_TILE_COLS columns, so the rows
+ *              of the interaction area read by a tile stay in cache.
+ * \param[in] 	addr: reference to opinion_band_t
+ * \return 		'NULL'
+ */
+void*
+opinion_activation(void* addr)
+{
+	opinion_band_t* band = addr;
+
+	TRACE_BEGIN("opinion band", NULL);
+	band->delta = 0;
+	for (int32_t first_col = 0; first_col < band->width; first_col += OPINION_TILE_COLS) {
+		int32_t num_of_cols = band->width - first_col < OPINION_TILE_COLS ? band->width - first_col : OPINION_TILE_COLS;
+
+		for (int32_t raw = band->first_row; raw < band->first_row + band->num_of_rows; ++raw) {
+			size_t offset = (size_t)(raw + band->radius)*band->stride + band->radius + first_col;
+			float delta = band->kernel(band->src + offset, band->stride, band->radius, band->bound,
+				band->dst + offset, num_of_cols);
+
+			band->delta = delta > band->delta ? delta : band->delta;
+		}
+	}
+	TRACE_END("opinion band");
+	return NULL;
+}
+
+/**
+ * \brief 	    update the opinions of each band, a thread per band
+ * \note 	    the last band is processed by the calling thread.
+ * \param[in] 	bands: bands
+ * \param[in] 	num_of_bands: num of bands
+ * \return 		0: any error.
+ *              1: a thread could not start.
+ */
+int
+opinion_run(opinion_band_t* bands, int32_t num_of_bands)
+{
+	pthread_t threads[num_of_bands > 0 ? num_of_bands : 1];
+	int32_t started = 0, error = 0;
+
+	for (; started < num_of_bands - 1; ++started)
+		if (pthread_create(&threads[started], NULL, opinion_activation, &bands[started])) {
+			error = 1;
+			break;
+		}
+	if (num_of_bands > 0 && !error) {
+		opinion_activation(&bands[num_of_bands - 1]);
+	}
+	for (int32_t i = 0; i < started; ++i)
+		pthread_join(threads[i], NULL);
+	return error;
+}
+
+/**
+ * \brief 	    estimate the memory of the opinions of an image
+ * \param[in] 	width: width of the image
+ * \param[in] 	height: height of the image
+ * \param[in] 	area: side of the interaction area
+ * \return 		bytes
+ */
+size_t
+opinion_footprint(int32_t width, int32_t height, int32_t area)
+{
+	int32_t radius = area / 2;
+
+	return 2*(size_t)(width + 2*radius)*(size_t)(height + 2*radius)*sizeof (float) + (size_t)width*(3 + sizeof (uint16_t));
+}
+
+/**
+ * \brief 	    binarize a mapped image by the opinion model
+ * \note 	    the opinions start as the brightness codes of the pixels and are updated
+ *              all at once, by double buffering, until no opinion moves more than
+ *              OPINION_TOLERANCE: each opinion becomes the mean of the opinions of its
+ *              interaction area within confidence*(BINARIZE_LEVELS - 1) (bounded confidence).
+ *              The rows are split among the threads, then the opinions are thresholded
+ *              at their median as the BW model does. With area 1 the bitboard is the one
+ *              of the BW model.
+ * \param[in] 	image: mapped image
+ * \param[in] 	area: odd side of the interaction area, up to OPINION_MAX_AREA
+ * \param[in] 	confidence: max distance of two interacting opinions, from 0 to 1
+ * \param[in] 	num_of_threads: num of threads
+ * \param[out] 	board: allocated and zeroed bitboard with the shape of the image
+ * \param[out] 	iterations: num of updates, can be NULL
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+opinion_ppm(const ppm_t* image, int32_t area, double confidence, int32_t num_of_threads, bitboard_t* board,
+	int32_t* iterations)
+{
+	int32_t width = image->width, height = image->height, radius = area / 2, iteration = 0;
+	int32_t num_of_bands = num_of_threads < height ? num_of_threads : height;
+	size_t stride = (size_t)(width + 2*radius), padded = stride * (size_t)(height + 2*radius);
+	size_t histogram[BINARIZE_LEVELS] = {0};
+	float* opinions[2] = {malloc(padded * sizeof (float)), malloc(padded * sizeof (float))};
+	uint8_t* buffer = malloc(3*(size_t)width);
+	uint16_t* codes = malloc((size_t)width * sizeof (uint16_t));
+	opinion_band_t* bands;
+	float (*kernel)(const float*, size_t, int32_t, float, float*, int32_t) = opinion_row_scalar;
+	uint32_t median;
+
+	num_of_bands = num_of_bands > 0 ? num_of_bands : 1;
+	bands = calloc(num_of_bands, sizeof (opinion_band_t));
+	TRACE_COUNT(TRACE_ALLOCATIONS, 5);
+	if (opinions[0] == NULL || opinions[1] == NULL || buffer == NULL || codes == NULL || bands == NULL) {
+		free(opinions[0]);
+		free(opinions[1]);
+		free(buffer);
+		free(codes);
+		free(bands);
+		return 1;
+	}
+
+#ifdef OPINION_SSE2
+	kernel = opinion_row_sse2;
+#endif /* OPINION_SSE2 */
+#ifdef OPINION_AVX
+	if (__builtin_cpu_supports("avx")) {
+		kernel = opinion_row_avx;
+	}
+#endif /* OPINION_AVX */
+
+	/* the opinions start as the brightness codes, the padding is NaN in both buffers */
+	for (size_t i = 0; i < padded; ++i)
+		opinions[0][i] = opinions[1][i] = NAN;
+	for (int32_t raw = 0; raw < height; ++raw) {
+		float* row = opinions[0] + (size_t)(raw + radius)*stride + radius;
+
+		binarize_ppm_codes(image, raw, buffer, codes);
+		for (int32_t col = 0; col < width; ++col)
+			row[col] = codes[col];
+	}
+
+	/* update all the opinions at once, until they converge */
+	for (int32_t i = 0, first_row = 0; i < num_of_bands; ++i) {
+		bands[i].stride = stride;
+		bands[i].radius = radius;
+		bands[i].bound = (float)(confidence * (BINARIZE_LEVELS - 1));
+		bands[i].width = width;
+		bands[i].first_row = first_row;
+		bands[i].num_of_rows = height / num_of_bands + (i < height % num_of_bands);
+		bands[i].kernel = kernel;
+		first_row += bands[i].num_of_rows;
+	}
+	while (iteration < OPINION_MAX_ITERATIONS) {
+		float delta = 0;
+
+		for (int32_t i = 0; i < num_of_bands; ++i) {
+			bands[i].src = opinions[iteration % 2];
+			bands[i].dst = opinions[(iteration + 1) % 2];
+		}
+		if (opinion_run(bands, num_of_bands)) {
+			free(opinions[0]);
+			free(opinions[1]);
+			free(buffer);
+			free(codes);
+			free(bands);
+			return 1;
+		}
+		++iteration;
+		for (int32_t i = 0; i < num_of_bands; ++i)
+			delta = bands[i].delta > delta ? bands[i].delta : delta;
+		if (delta <= OPINION_TOLERANCE) {
+			break;
+		}
+	}
+	if (iterations != NULL) {
+		*iterations = iteration;
+	}
+
+	/* threshold the opinions at their median, rounded to the brightness codes */
+	for (int32_t raw = 0; raw < height; ++raw) {
+		const float* row = opinions[iteration % 2] + (size_t)(raw + radius)*stride + radius;
+
+		for (int32_t col = 0; col < width; ++col)
+			++histogram[(uint32_t)(row[col] + 0.5f)];
+	}
+	median = binarize_median(histogram, (size_t)width * (size_t)height);
+	for (int32_t raw = 0; raw < height; ++raw) {
+		const float* row = opinions[iteration % 2] + (size_t)(raw + radius)*stride + radius;
+		uint64_t* words = BITBOARD_ROW(board, raw);
+
+		for (int32_t col = 0; col < width; col += 64) {
+			uint64_t word = 0;
+
+			for (int32_t bit = 0; bit < 64 && col + bit < width; ++bit)
+				word |= (uint64_t)((uint32_t)(row[col + bit] + 0.5f) >= median) << (63 - bit);
+			words[col >> 6] = word;
+		}
+	}
+
+	free(opinions[0]);
+	free(opinions[1]);
+	free(buffer);
+	free(codes);
+	free(bands);
+	return 0;
+}
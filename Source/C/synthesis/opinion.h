@@ -0,0 +1,70 @@
+/**
+ * \file            opinion.h
+ * \brief           Opinion model: bounded confidence dynamics of the brightness
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of opinion.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+#ifndef OPINION_H
+#define OPINION_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "bitboard.h"
+#include "ppm.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define OPINION_MAX_AREA 15 /* max side of the interaction area */
+#define OPINION_MAX_ITERATIONS 100 /* max num of updates of the opinions */
+#define OPINION_TOLERANCE 0.01f /* the opinions converged when none moves more, in brightness codes */
+#define OPINION_SCALE 10000 /* confidence in the header of the synthesis file, 1 is OPINION_SCALE */
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+size_t 	opinion_footprint(int32_t, int32_t, int32_t);
+int 	opinion_ppm(const ppm_t*, int32_t, double, int32_t, bitboard_t*, int32_t*);
+
+
+#endif /* guard */
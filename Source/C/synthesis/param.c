@@ -0,0 +1,192 @@
+/**
+ * \file 		param.c
+ * \brief 		define param_default, param_set, param_load
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of param.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "param.h"
+#include "binarize.h"
+#include "opinion.h"
+#include "gram.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	param_assign(param_t*, const char*, bool);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    parameters of config.h
+ * \param[out] 	param: parameters
+ */
+void
+param_default(param_t* param)
+{
+	param->model = MODEL;
+	param->gram_size = PARAM_GRAM_SIZE;
+	param->layers = PARAM_LAYERS;
+	param->area = PARAM_AREA;
+	param->confidence = PARAM_CONFIDENCE;
+	param->engine = ENGINE;
+	param->num_of_threads = THREAD_COUNT;
+}
+
+/**
+ * \brief 	    set a parameter
+ * \note 	    the parameters are 'model', 'gram_size', 'layers', 'area', 'confidence', 'engine'
+ *              and 'threads';
+ *              'config' reads a config file, only from the command line.
+ * \param[out] 	param: parameters
+ * \param[in] 	assignment: 'name=value'
+ * \param[in] 	config: if true 'config' is allowed
+ * \return 		PARAM_OK or the error.
+ */
+int
+param_assign(param_t* param, const char* assignment, bool config)
+{
+	const char* equal = strchr(assignment, '=');
+	size_t length;
+	char* end;
+	long value;
+
+	if (equal == NULL) {
+		return PARAM_UNKNOWN;
+	}
+	length = (size_t)(equal - assignment);
+	if (config && length == 6 && strncmp(assignment, "config", length) == 0) {
+		return param_load(param, equal + 1);
+	}
+	if (length == 10 && strncmp(assignment, "confidence", length) == 0) {
+		double confidence = strtod(equal + 1, &end);
+
+		if (end == equal + 1 || (*end != '\0' && *end != '\n' && *end != '\r') ||
+			!(confidence >= 0 && confidence <= 1)) {
+			return PARAM_RANGE;
+		}
+		param->confidence = confidence;
+		return PARAM_OK;
+	}
+	value = strtol(equal + 1, &end, 10);
+	if (end == equal + 1 || (*end != '\0' && *end != '\n' && *end != '\r')) {
+		return PARAM_RANGE;
+	}
+
+	if (length == 5 && strncmp(assignment, "model", length) == 0) {
+		if (value < 0 || value > PARAM_MODELS - 1) {
+			return PARAM_RANGE;
+		}
+		param->model = (int32_t)value;
+	} else if (length == 9 && strncmp(assignment, "gram_size", length) == 0) {
+		if (gram_kernel((int32_t)value) == NULL) {
+			return PARAM_RANGE;
+		}
+		param->gram_size = (int32_t)value;
+	} else if (length == 6 && strncmp(assignment, "layers", length) == 0) {
+		if (value < 2 || value > BINARIZE_MAX_LAYERS) {
+			return PARAM_RANGE;
+		}
+		param->layers = (int32_t)value;
+	} else if (length == 4 && strncmp(assignment, "area", length) == 0) {
+		if (value < 1 || value > OPINION_MAX_AREA || value % 2 == 0) {
+			return PARAM_RANGE;
+		}
+		param->area = (int32_t)value;
+	} else if (length == 6 && strncmp(assignment, "engine", length) == 0) {
+		if (value < ENGINE_SORT || value > ENGINE_STREAM) {
+			return PARAM_RANGE;
+		}
+		param->engine = (int32_t)value;
+	} else if (length == 7 && strncmp(assignment, "threads", length) == 0) {
+		if (value < 0 || value > 4096) {
+			return PARAM_RANGE;
+		}
+		param->num_of_threads = (int32_t)value;
+	} else {
+		return PARAM_UNKNOWN;
+	}
+	return PARAM_OK;
+}
+
+/**
+ * \brief 	    set a parameter of the command line
+ * \param[out] 	param: parameters
+ * \param[in] 	assignment: 'name=value', 'config=path' reads a config file
+ * \return 		PARAM_OK or the error.
+ */
+int
+param_set(param_t* param, const char* assignment)
+{
+	return param_assign(param, assignment, true);
+}
+
+/**
+ * \brief 	    read a config file
+ * \note 	    a line is 'name=value', empty or a comment starting with '#'.
+ * \param[out] 	param: parameters
+ * \param[in] 	path: path of the config file
+ * \return 		PARAM_OK or the error of the first wrong line.
+ */
+int
+param_load(param_t* param, const char* path)
+{
+	char line[PARAM_LINE];
+	FILE* fp = fopen(path, "r");
+	int output = PARAM_OK;
+
+	if (fp == NULL) {
+		return PARAM_NOT_FOUND;
+	}
+	while (output == PARAM_OK && fgets(line, PARAM_LINE, fp) != NULL) {
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r' || line[0] == '\0') {
+			continue;
+		}
+		output = param_assign(param, line, false);
+	}
+	fclose(fp);
+	return output;
+}
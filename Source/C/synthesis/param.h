@@ -0,0 +1,114 @@
+/**
+ * \file            param.h
+ * \brief           Parameters of the synthesis, set at runtime
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of param.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+#ifndef PARAM_H
+#define PARAM_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "../config.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define PARAM_OK 0 /* parameter set */
+#define PARAM_UNKNOWN 1 /* the name is not a parameter */
+#define PARAM_RANGE 2 /* the value is out of range */
+#define PARAM_NOT_FOUND 3 /* the config file can not be opened */
+#define PARAM_LINE 256 /* max length of a parameter */
+#define PARAM_MODELS 3 /* num of models of config.h */
+
+#ifdef BW_GRAM_SIZE
+	#define PARAM_GRAM_SIZE BW_GRAM_SIZE /* default side of the grams */
+#else
+	#define PARAM_GRAM_SIZE GRAM_SIZE
+#endif /* BW_GRAM_SIZE */
+#ifdef N_LAYERS
+	#define PARAM_LAYERS N_LAYERS /* default num of layers of the multilayer model */
+#else
+	#define PARAM_LAYERS 2
+#endif /* N_LAYERS */
+#ifdef INTERACTION_AREA
+	#define PARAM_AREA INTERACTION_AREA /* default side of the interaction area of the opinion model */
+	#define PARAM_CONFIDENCE CONFIDENCE /* default confidence of the opinion model */
+#else
+	#define PARAM_AREA 5
+	#define PARAM_CONFIDENCE 0.5
+#endif /* INTERACTION_AREA */
+#define ENGINE_SORT 0 /* comparison sort of the indices */
+#define ENGINE_RADIX 1 /* radix sort of the packed grams */
+#define ENGINE_HASH 2 /* hash table of the packed grams */
+#define ENGINE_STREAM 3 /* hash table of the packed grams, streaming the rows */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		param_t
+ * \note		Parameters of the synthesis, the defaults are in config.h.
+*/
+typedef struct
+{
+	int32_t 	model; 			    /*!< model of the synthesis */
+	int32_t 	gram_size; 		    /*!< side of the grams */
+	int32_t 	layers; 		    /*!< num of layers of the multilayer model */
+	int32_t 	area; 			    /*!< side of the interaction area of the opinion model */
+	double 		confidence; 	    /*!< confidence of the opinion model */
+	int32_t 	engine; 		    /*!< engine counting the grams */
+	int32_t 	num_of_threads; 	/*!< num of threads, 0 uses the num of online CPUs */
+} param_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+void 	param_default(param_t*);
+int 	param_set(param_t*, const char*);
+int 	param_load(param_t*, const char*);
+
+
+#endif /* guard */
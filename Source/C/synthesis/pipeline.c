@@ -0,0 +1,267 @@
+/**
+ * \file 		pipeline.c
+ * \brief 		define pipeline_start, pipeline_take, pipeline_close, pipeline_stop
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of pipeline.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "pipeline.h"
+#include "trace.h"
+#include <string.h>
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+void* 	pipeline_reader(void*);
+void* 	pipeline_writer(void*);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    activation function of a reader
+ * \note 	    the reader takes the next job of the order that no worker has taken, while
+ *              less than depth jobs are ahead of the workers. A job that can not be read is
+ *              left to its worker.
+ * \param[in] 	addr: reference to pipeline_t
+ * \return 		'NULL'
+ */
+void*
+pipeline_reader(void* addr)
+{
+	pipeline_t* pipeline = addr;
+
+	TRACE_THREAD("reader");
+	pthread_mutex_lock(&pipeline->mutex);
+	while (!pipeline->stopping && pipeline->next < pipeline->count) {
+		int32_t job = pipeline->order[pipeline->next];
+		int output;
+
+		if (pipeline->states[job] != PIPELINE_PENDING) {
+			++pipeline->next;
+			continue;
+		}
+		if (pipeline->ahead >= pipeline->depth) {
+			pthread_cond_wait(&pipeline->changed, &pipeline->mutex);
+			continue;
+		}
+		++pipeline->next;
+		++pipeline->ahead;
+		pipeline->states[job] = PIPELINE_READING;
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		TRACE_BEGIN("read ahead", NULL);
+		output = pipeline->read(job);
+		TRACE_END("read ahead");
+
+		pthread_mutex_lock(&pipeline->mutex);
+		pipeline->states[job] = output ? PIPELINE_PENDING : PIPELINE_READ;
+		pipeline->ahead -= output != 0;
+		pthread_cond_broadcast(&pipeline->changed);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+	return NULL;
+}
+
+/**
+ * \brief 	    activation function of a writer
+ * \note 	    the writer closes the queued files until the pipeline stops and the queue is empty.
+ * \param[in] 	addr: reference to pipeline_t
+ * \return 		'NULL'
+ */
+void*
+pipeline_writer(void* addr)
+{
+	pipeline_t* pipeline = addr;
+
+	TRACE_THREAD("writer");
+	pthread_mutex_lock(&pipeline->mutex);
+	for (;;) {
+		pipeline_file_t file;
+		int output;
+
+		while (!pipeline->stopping && pipeline->size == 0)
+			pthread_cond_wait(&pipeline->changed, &pipeline->mutex);
+		if (pipeline->size == 0) {
+			break;
+		}
+		file = pipeline->files[pipeline->head];
+		pipeline->head = (pipeline->head + 1) % pipeline->depth;
+		--pipeline->size;
+		pthread_cond_broadcast(&pipeline->changed);
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		TRACE_BEGIN("close", NULL);
+		output = fclose(file.fp) != 0;
+		TRACE_END("close");
+		pipeline->written(file.job, output);
+
+		pthread_mutex_lock(&pipeline->mutex);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+	return NULL;
+}
+
+/**
+ * \brief 	    start the readers and the writers
+ * \note 	    with depth 0, or if no thread starts, the workers do their I/O.
+ * \param[out] 	pipeline: pipeline
+ * \param[in] 	order: count indices of the jobs, in the order of the workers
+ * \param[in] 	count: num of jobs
+ * \param[in] 	depth: max jobs read ahead of the workers, and max files queued
+ * \param[in] 	num_of_readers: num of reader threads
+ * \param[in] 	num_of_writers: num of writer threads
+ * \param[in] 	read: read a job, return 0 if it is read. Called by the readers.
+ * \param[in] 	written: end of the file of a job, with 1 for a write error. Called by
+ *              the writers, or by pipeline_close without writers.
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+pipeline_start(pipeline_t* pipeline, const int32_t* order, int32_t count, int32_t depth, int32_t num_of_readers,
+	int32_t num_of_writers, int (*read)(int32_t), void (*written)(int32_t, int))
+{
+	memset(pipeline, 0, sizeof (pipeline_t));
+	pipeline->count = count;
+	pipeline->depth = depth > 0 ? depth : 1;
+	pipeline->read = read;
+	pipeline->written = written;
+	pipeline->order = malloc((count > 0 ? count : 1) * sizeof (int32_t));
+	pipeline->states = calloc(count > 0 ? count : 1, sizeof (uint8_t));
+	pipeline->files = malloc(pipeline->depth * sizeof (pipeline_file_t));
+	pipeline->threads = malloc((num_of_readers + num_of_writers > 0 ? num_of_readers + num_of_writers : 1) * sizeof (pthread_t));
+	if (pipeline->order == NULL || pipeline->states == NULL || pipeline->files == NULL || pipeline->threads == NULL) {
+		free(pipeline->order);
+		free(pipeline->states);
+		free(pipeline->files);
+		free(pipeline->threads);
+		return 1;
+	}
+	memcpy(pipeline->order, order, count * sizeof (int32_t));
+	pthread_mutex_init(&pipeline->mutex, NULL);
+	pthread_cond_init(&pipeline->changed, NULL);
+
+	for (int32_t i = 0; depth > 0 && i < num_of_readers; ++i)
+		if (pthread_create(&pipeline->threads[pipeline->num_of_readers], NULL, pipeline_reader, pipeline) == 0) {
+			++pipeline->num_of_readers;
+		}
+	for (int32_t i = 0; depth > 0 && i < num_of_writers; ++i)
+		if (pthread_create(&pipeline->threads[pipeline->num_of_readers + pipeline->num_of_writers], NULL,
+			pipeline_writer, pipeline) == 0) {
+			++pipeline->num_of_writers;
+		}
+	return 0;
+}
+
+/**
+ * \brief 	    take a job for a worker
+ * \note 	    a job being read is waited for. A job not read yet is left to the worker.
+ * \param[in] 	pipeline: pipeline
+ * \param[in] 	job: index of the job
+ * \return 		1 if the job was read by a reader, else 0.
+ */
+int
+pipeline_take(pipeline_t* pipeline, int32_t job)
+{
+	int read;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	{
+		while (pipeline->states[job] == PIPELINE_READING)
+			pthread_cond_wait(&pipeline->changed, &pipeline->mutex);
+		read = pipeline->states[job] == PIPELINE_READ;
+		pipeline->ahead -= read;
+		pipeline->states[job] = PIPELINE_TAKEN;
+		pthread_cond_broadcast(&pipeline->changed);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+	return read;
+}
+
+/**
+ * \brief 	    close the synthesis file of a job
+ * \note 	    the file is queued for the writers, waiting while the queue is full.
+ *              Without writers, it is closed at once.
+ * \param[in] 	pipeline: pipeline
+ * \param[in] 	fp: written synthesis file
+ * \param[in] 	job: index of the job
+ */
+void
+pipeline_close(pipeline_t* pipeline, FILE* fp, int32_t job)
+{
+	if (pipeline->num_of_writers == 0) {
+		pipeline->written(job, fclose(fp) != 0);
+		return;
+	}
+	pthread_mutex_lock(&pipeline->mutex);
+	{
+		while (pipeline->size == pipeline->depth)
+			pthread_cond_wait(&pipeline->changed, &pipeline->mutex);
+		pipeline->files[(pipeline->head + pipeline->size) % pipeline->depth] = (pipeline_file_t){fp, job};
+		++pipeline->size;
+		pthread_cond_broadcast(&pipeline->changed);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+}
+
+/**
+ * \brief 	    stop the readers, wait for the writers to close the queued files, free the pipeline
+ * \note 	    the workers have ended.
+ * \param[in] 	pipeline: pipeline
+ */
+void
+pipeline_stop(pipeline_t* pipeline)
+{
+	pthread_mutex_lock(&pipeline->mutex);
+	{
+		pipeline->stopping = true;
+		pthread_cond_broadcast(&pipeline->changed);
+	}
+	pthread_mutex_unlock(&pipeline->mutex);
+	for (int32_t i = 0; i < pipeline->num_of_readers + pipeline->num_of_writers; ++i)
+		pthread_join(pipeline->threads[i], NULL);
+	pthread_mutex_destroy(&pipeline->mutex);
+	pthread_cond_destroy(&pipeline->changed);
+	free(pipeline->order);
+	free(pipeline->states);
+	free(pipeline->files);
+	free(pipeline->threads);
+}
@@ -0,0 +1,118 @@
+/**
+ * \file            pipeline.h
+ * \brief           Reader and writer threads overlapping the I/O of the images with their synthesis
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of pipeline.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define PIPELINE_PENDING 0 /* the job is not read yet */
+#define PIPELINE_READING 1 /* a reader is reading the job */
+#define PIPELINE_READ 2 /* the job is read, waiting for a worker */
+#define PIPELINE_TAKEN 3 /* a worker has taken the job */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		pipeline_file_t
+ * \note		A synthesis file waiting to be closed by a writer.
+*/
+typedef struct
+{
+	FILE* 		fp; 	/*!< written synthesis file */
+	int32_t 	job; 	/*!< index of the job */
+} pipeline_file_t;
+
+/**
+ * \brief 		pipeline_t
+ * \note		Reader threads read the next jobs, in the order of the pool, at most depth
+ *              jobs ahead of the workers. Writer threads close the synthesis files of the
+ *              workers, at most depth files queued, so the workers go on with the next job
+ *              while the files are flushed.
+*/
+typedef struct
+{
+	pthread_mutex_t 	mutex; 	            /*!< mutex of the queues */
+	pthread_cond_t 	    changed; 	        /*!< signaled when a job is read or taken, or a file queued or closed */
+	int 	            (*read)(int32_t); 	/*!< read a job, 0 if it is read */
+	void 	            (*written)(int32_t, int); 	/*!< end of the file of a job, 1 for a write error */
+	int32_t* 	        order; 	            /*!< jobs in reading order */
+	uint8_t* 	        states; 	        /*!< PIPELINE_* of each job */
+	pipeline_file_t* 	files; 	            /*!< ring of the queued files */
+	pthread_t* 	        threads; 	        /*!< readers, then writers */
+	int32_t 	        count, 	            /*!< num of jobs */
+		                depth, 	            /*!< max jobs read ahead, and max queued files */
+		                next, 	            /*!< next job of the order to read */
+		                ahead, 	            /*!< jobs read or being read, not taken yet */
+		                head, 	            /*!< first queued file */
+		                size, 	            /*!< num of queued files */
+		                num_of_readers, 	/*!< num of started readers */
+		                num_of_writers; 	/*!< num of started writers */
+	bool 	            stopping; 	        /*!< no more jobs are taken nor files queued */
+} pipeline_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	pipeline_start(pipeline_t*, const int32_t*, int32_t, int32_t, int32_t, int32_t, int (*)(int32_t),
+			void (*)(int32_t, int));
+int 	pipeline_take(pipeline_t*, int32_t);
+void 	pipeline_close(pipeline_t*, FILE*, int32_t);
+void 	pipeline_stop(pipeline_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,343 @@
+/**
+ * \file 		pool.c
+ * \brief 		define pool_cpu_count, pool_available_memory, pool_init, pool_order, pool_pop, pool_done, pool_share, pool_free
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of pool.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#define _POSIX_C_SOURCE 200809L  // sysconf
+#include "pool.h"
+#include "sort.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	pool_cmp(const void*, const void*, void*);
+int32_t pool_find(pool_t*, int32_t);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    comparison between two jobs, used in sort function
+ * \note 	    the largest jobs come first, equal jobs keep the input order.
+ * \param[in] 	a: reference to index int32_t
+ * \param[in] 	b: reference to index int32_t
+ * \param[in] 	context: sizes of the jobs
+ * \return 		-1: if a comes before b
+ *              0: if a == b
+ *              1: if a comes after b
+ */
+int
+pool_cmp(const void* a, const void* b, void* context)
+{
+	const size_t* sizes = (const size_t*)context;
+	int32_t i = *(const int32_t*)a, j = *(const int32_t*)b;
+
+	if (sizes[i] != sizes[j]) {
+		return sizes[i] > sizes[j] ? -1 : 1;
+	}
+	return i < j ? -1 : i > j;
+}
+
+/**
+ * \brief 	    num of workers of the pool
+ * \return 		num of online CPUs, at least 1.
+ */
+int32_t
+pool_cpu_count(void)
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return count < 1 ? 1 : (int32_t)count;
+}
+
+/**
+ * \brief 	    default memory budget of the pool
+ * \return 		available RAM in bytes, from /proc/meminfo or else the free pages.
+ */
+size_t
+pool_available_memory(void)
+{
+	FILE* fp = fopen("/proc/meminfo", "r");
+	char line[256];
+
+	if (fp != NULL) {
+		while (fgets(line, sizeof (line), fp) != NULL) {
+			unsigned long long kib;
+
+			if (sscanf(line, "MemAvailable: %llu kB", &kib) == 1) {
+				fclose(fp);
+				return (size_t)kib * 1024;
+			}
+		}
+		fclose(fp);
+	}
+	{
+		long pages = sysconf(_SC_AVPHYS_PAGES), page_size = sysconf(_SC_PAGESIZE);
+
+		return pages < 1 || page_size < 1 ? SIZE_MAX : (size_t)pages * (size_t)page_size;
+	}
+}
+
+/**
+ * \brief 	    init a pool of jobs
+ * \note 	    the jobs are sorted by decreasing size and dealt in turn to the workers,
+ *              so every worker starts from one of the largest jobs.
+ * \param[out] 	pool: pool
+ * \param[in] 	sizes: estimated peak bytes of each job
+ * \param[in] 	count: num of jobs
+ * \param[in] 	num_of_workers: num of workers
+ * \param[in] 	budget: max bytes held by the workers, SIZE_MAX for no limit
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+pool_init(pool_t* pool, const size_t* sizes, int32_t count, int32_t num_of_workers, size_t budget)
+{
+	int32_t* sorted = malloc((count > 0 ? count : 1) * sizeof (int32_t));
+	int32_t offset = 0;
+
+	pool->count = count;
+	pool->num_of_workers = num_of_workers;
+	pool->budget = budget;
+	pool->used = 0;
+	pool->running = 0;
+	pool->order = malloc((count > 0 ? count : 1) * sizeof (int32_t));
+	pool->sizes = malloc((count > 0 ? count : 1) * sizeof (size_t));
+	pool->held = calloc(num_of_workers, sizeof (size_t));
+	pool->deques = malloc(num_of_workers * sizeof (deque_t));
+	if (sorted == NULL || pool->order == NULL || pool->sizes == NULL || pool->held == NULL || pool->deques == NULL) {
+		free(sorted);
+		free(pool->order);
+		free(pool->sizes);
+		free(pool->held);
+		free(pool->deques);
+		return 1;
+	}
+	memcpy(pool->sizes, sizes, count * sizeof (size_t));
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->released, NULL);
+
+	/* largest-first order */
+	for (int32_t i = 0; i < count; ++i)
+		sorted[i] = i;
+	sort(sorted, count, sizeof (int32_t), pool_cmp, pool->sizes);
+
+	/* deal the jobs */
+	for (int32_t w = 0; w < num_of_workers; ++w) {
+		deque_t* deque = &pool->deques[w];
+
+		deque->jobs = pool->order + offset;
+		deque->head = deque->tail = 0;
+		offset += count / num_of_workers + (w < count % num_of_workers);
+	}
+	for (int32_t i = 0; i < count; ++i) {
+		deque_t* deque = &pool->deques[i % num_of_workers];
+		deque->jobs[deque->tail++] = sorted[i];
+	}
+
+	free(sorted);
+	return 0;
+}
+
+/**
+ * \brief 	    jobs in the order they were dealt, largest first
+ * \note 	    it is the order in which the workers start their jobs, when the
+ *              budget does not hold them back. Call it before the first pop.
+ * \param[in] 	pool: pool
+ * \param[out] 	order: pool->count indices of the jobs
+ */
+void
+pool_order(const pool_t* pool, int32_t* order)
+{
+	for (int32_t i = 0; i < pool->count; ++i)
+		order[i] = pool->deques[i % pool->num_of_workers].jobs[i / pool->num_of_workers];
+}
+
+/**
+ * \brief 	    find the next job of a worker that fits in the budget
+ * \note 	    the worker takes the largest job of its deque that fits, then the
+ *              smallest job of the other deques, so the small jobs fill the gaps
+ *              left by the large ones. The pool must be locked.
+ * \param[in] 	pool: pool
+ * \param[in] 	worker: index of the worker
+ * \return 		index of the job, removed from its deque, -1 if no job fits.
+ */
+int32_t
+pool_find(pool_t* pool, int32_t worker)
+{
+	size_t held = pool->held[worker], others = pool->used - held;
+	size_t available = pool->budget > others ? pool->budget - others : 0;
+	deque_t* deque = &pool->deques[worker];
+
+	/* largest job of the worker that fits */
+	for (int32_t i = deque->head; i < deque->tail; ++i) {
+		int32_t job = deque->jobs[i];
+
+		if (pool->running == 0 || (pool->sizes[job] > held ? pool->sizes[job] : held) <= available) {
+			memmove(deque->jobs + deque->head + 1, deque->jobs + deque->head, (i - deque->head) * sizeof (int32_t));
+			++deque->head;
+			return job;
+		}
+	}
+
+	/* smallest job of the other workers */
+	for (int32_t k = 1; k < pool->num_of_workers; ++k) {
+		deque = &pool->deques[(worker + k) % pool->num_of_workers];
+		if (deque->head < deque->tail) {
+			int32_t job = deque->jobs[deque->tail - 1];
+
+			if (pool->running == 0 || (pool->sizes[job] > held ? pool->sizes[job] : held) <= available) {
+				--deque->tail;
+				return job;
+			}
+		}
+	}
+	return -1;
+}
+
+/**
+ * \brief 	    pop the next job of a worker
+ * \note 	    if no job fits in the budget, the worker first releases the bytes it
+ *              holds, then waits for the end of a running job.
+ * \param[in] 	pool: pool
+ * \param[in] 	worker: index of the worker
+ * \return 		index of the job.
+ *              POOL_EMPTY: no more jobs, the worker holds no bytes.
+ *              POOL_TRIM: the worker has to free its buffers, then pop again.
+ */
+int32_t
+pool_pop(pool_t* pool, int32_t worker)
+{
+	int32_t job;
+
+	pthread_mutex_lock(&pool->mutex);
+	{
+		for (;;) {
+			bool empty = true;
+
+			job = pool_find(pool, worker);
+			if (job >= 0) {
+				size_t need = pool->sizes[job] > pool->held[worker] ? pool->sizes[job] : pool->held[worker];
+
+				pool->used += need - pool->held[worker];
+				pool->held[worker] = need;
+				++pool->running;
+				break;
+			}
+			for (int32_t w = 0; w < pool->num_of_workers; ++w)
+				empty = empty && pool->deques[w].head == pool->deques[w].tail;
+			if (empty || pool->held[worker] > 0) {
+				job = empty ? POOL_EMPTY : POOL_TRIM;
+				pool->used -= pool->held[worker];
+				pool->held[worker] = 0;
+				pthread_cond_broadcast(&pool->released);
+				break;
+			}
+			pthread_cond_wait(&pool->released, &pool->mutex);
+		}
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return job;
+}
+
+/**
+ * \brief 	    end a job
+ * \param[in] 	pool: pool
+ * \param[in] 	worker: index of the worker
+ * \param[in] 	retained: bytes still held by the worker, as its reused buffers
+ */
+void
+pool_done(pool_t* pool, int32_t worker, size_t retained)
+{
+	pthread_mutex_lock(&pool->mutex);
+	{
+		pool->used = pool->used - pool->held[worker] + retained;
+		pool->held[worker] = retained;
+		--pool->running;
+		pthread_cond_broadcast(&pool->released);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+/**
+ * \brief 	    share of the workers of a running job
+ * \note 	    a job split in threads, as the bands of a large image, takes its
+ *              share of the workers, so that the threads of the running jobs
+ *              do not outnumber the workers.
+ * \param[in] 	pool: pool
+ * \return 		num of threads of a running job, at least 1.
+ */
+int32_t
+pool_share(pool_t* pool)
+{
+	int32_t share;
+
+	pthread_mutex_lock(&pool->mutex);
+	{
+		share = pool->running > 1 ? pool->num_of_workers / pool->running : pool->num_of_workers;
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return share > 1 ? share : 1;
+}
+
+/**
+ * \brief 	    free a pool
+ * \param[in] 	pool: pool
+ */
+void
+pool_free(pool_t* pool)
+{
+	pthread_mutex_destroy(&pool->mutex);
+	pthread_cond_destroy(&pool->released);
+	free(pool->deques);
+	free(pool->order);
+	free(pool->sizes);
+	free(pool->held);
+	pool->deques = NULL;
+	pool->order = NULL;
+	pool->sizes = NULL;
+	pool->held = NULL;
+}
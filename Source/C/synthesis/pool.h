@@ -0,0 +1,111 @@
+/**
+ * \file            pool.h
+ * \brief           Pool of jobs with work stealing and a memory budget
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of pool.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+#ifndef POOL_H
+#define POOL_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define POOL_EMPTY (-1) /* no more jobs */
+#define POOL_TRIM (-2) /* the worker has to release its buffers before a new job */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		deque_t
+ * \note		Jobs of a worker, from the largest to the smallest.
+ *              The owner pops from the head, the thieves steal from the tail.
+*/
+typedef struct
+{
+	int32_t* 	        jobs; 	/*!< indices of the jobs */
+	int32_t 	        head, 	/*!< next job of the owner */
+		                tail; 	/*!< one past the last job */
+} deque_t;
+
+/**
+ * \brief 		pool_t
+ * \note		This structure is used to implement a pool of processes.
+ *              The jobs are dealt largest-first to the deques of the workers.
+ *              A job is admitted while the bytes held by the workers stay
+ *              within the budget, or when no other job is running.
+*/
+typedef struct
+{
+	pthread_mutex_t 	mutex; 	            /*!< mutex used as a light */
+	pthread_cond_t 	    released; 	        /*!< signaled when a job ends */
+	deque_t* 	        deques; 	        /*!< one deque for each worker */
+	int32_t* 	        order; 	            /*!< storage of the deques */
+	size_t* 	        sizes; 	            /*!< estimated peak bytes of each job */
+	size_t* 	        held; 	            /*!< bytes held by each worker */
+	size_t 	            budget, 	        /*!< max bytes held by the workers */
+		                used; 	            /*!< bytes held by the workers */
+	int32_t 	        running, 	        /*!< num of admitted jobs */
+		                num_of_workers, 	/*!< num of deques */
+		                count; 	            /*!< num of jobs */
+} pool_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int32_t 	pool_cpu_count(void);
+size_t 		pool_available_memory(void);
+int 		pool_init(pool_t*, const size_t*, int32_t, int32_t, size_t);
+void 		pool_order(const pool_t*, int32_t*);
+int32_t 	pool_pop(pool_t*, int32_t);
+void 		pool_done(pool_t*, int32_t, size_t);
+int32_t 	pool_share(pool_t*);
+void 		pool_free(pool_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,275 @@
+/**
+ * \file 		ppm.c
+ * \brief 		define ppm_open, ppm_parse, ppm_is_rgb, ppm_row, ppm_close
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ppm.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#define _DEFAULT_SOURCE  // madvise
+#include "ppm.h"
+#include "trace.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	ppm_token(const ppm_t*, size_t*, int32_t*);
+uint8_t ppm_sample(const ppm_t*, const uint8_t*);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    read a decimal field of the header
+ * \note 	    whitespaces and comments, from '#' to the end of the line, are skipped.
+ * \param[in] 	image: image
+ * \param[in] 	pos: offset of the next character, updated
+ * \param[out] 	value: value of the field
+ * \return 		0: any error.
+ *              1: missing or too large field.
+ */
+int
+ppm_token(const ppm_t* image, size_t* pos, int32_t* value)
+{
+	const uint8_t* map = image->data;
+	int64_t number = 0;
+	size_t start;
+
+	while (*pos < image->size) {
+		if (map[*pos] == '#') {
+			while (*pos < image->size && map[*pos] != '\n' && map[*pos] != '\r')
+				++*pos;
+		} else if (map[*pos] == ' ' || map[*pos] == '\t' || map[*pos] == '\n' ||
+			map[*pos] == '\r' || map[*pos] == '\v' || map[*pos] == '\f') {
+			++*pos;
+		} else {
+			break;
+		}
+	}
+
+	start = *pos;
+	while (*pos < image->size && map[*pos] >= '0' && map[*pos] <= '9') {
+		number = 10*number + (map[*pos] - '0');
+		if (number > INT32_MAX) {
+			return 1;
+		}
+		++*pos;
+	}
+	*value = (int32_t)number;
+	return *pos == start;
+}
+
+/**
+ * \brief 	    8-bit value of a sample
+ * \param[in] 	image: mapped image
+ * \param[in] 	sample: first byte of the sample
+ * \return 		the sample scaled from maxval to 255.
+ */
+uint8_t
+ppm_sample(const ppm_t* image, const uint8_t* sample)
+{
+	uint32_t value = image->maxval > 255 ? (uint32_t)sample[0] << 8 | sample[1] : sample[0];
+
+	if (value >= (uint32_t)image->maxval) {
+		return 255;
+	}
+	return (uint8_t)((value*255 + (uint32_t)image->maxval/2) / (uint32_t)image->maxval);
+}
+
+/**
+ * \brief 	    read an image from the bytes of its file
+ * \note 	    the pixels are not copied, the bytes must outlive the image.
+ * \param[out] 	image: image
+ * \param[in] 	data: bytes of the image file
+ * \param[in] 	size: num of bytes
+ * \return 		PPM_OK: any error.
+ *              PPM_FORMAT_ERROR: unknown or wrong header.
+ *              PPM_TRUNCATED: the buffer ends before the last pixel.
+ */
+int
+ppm_parse(ppm_t* image, const uint8_t* data, size_t size)
+{
+	size_t pos = 2, samples;
+
+	image->data = data;
+	image->size = size;
+	if (size < 3) {
+		return PPM_FORMAT_ERROR;
+	}
+
+	/* header */
+	image->format = (char)data[1];
+	if (data[0] != 'P' || (image->format != '4' && image->format != '5' && image->format != '6')) {
+		return PPM_FORMAT_ERROR;
+	}
+	image->maxval = 1;
+	if (ppm_token(image, &pos, &image->width) || ppm_token(image, &pos, &image->height) ||
+		(image->format != '4' && ppm_token(image, &pos, &image->maxval)) ||
+		image->width == 0 || image->height == 0 || image->maxval == 0 || image->maxval > 65535 ||
+		pos == size) {
+		return PPM_FORMAT_ERROR;
+	}
+	++pos;  // a single whitespace ends the header
+
+	/* pixels */
+	samples = image->format == '6' ? 3 : 1;
+	image->stride = image->format == '4' ? ((size_t)image->width + 7) / 8 :
+		samples * (image->maxval > 255 ? 2 : 1) * (size_t)image->width;
+	if ((size - pos) / image->stride < (size_t)image->height) {
+		return PPM_TRUNCATED;
+	}
+	image->pixels = data + pos;
+	return PPM_OK;
+}
+
+/**
+ * \brief 	    map an image in memory
+ * \note 	    the pixels are read sequentially, so the kernel is advised to read ahead.
+ * \param[out] 	image: mapped image
+ * \param[in] 	path: file path
+ * \return 		PPM_OK: any error.
+ *              PPM_NOT_FOUND: the file can not be opened or mapped.
+ *              PPM_FORMAT_ERROR: unknown or wrong header.
+ *              PPM_TRUNCATED: the file ends before the last pixel.
+ */
+int
+ppm_open(ppm_t* image, const char* path)
+{
+	struct stat info;
+	int fd = open(path, O_RDONLY), output;
+
+	memset(image, 0, sizeof (ppm_t));
+	if (fd < 0) {
+		return PPM_NOT_FOUND;
+	}
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return PPM_NOT_FOUND;
+	}
+	if (info.st_size < 3) {
+		close(fd);
+		return PPM_FORMAT_ERROR;
+	}
+	image->map_size = (size_t)info.st_size;
+	image->map = mmap(NULL, image->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (image->map == MAP_FAILED) {
+		image->map = NULL;
+		return PPM_NOT_FOUND;
+	}
+
+	output = ppm_parse(image, image->map, image->map_size);
+	if (output != PPM_OK) {
+		ppm_close(image);
+		return output;
+	}
+	madvise(image->map, image->map_size, MADV_SEQUENTIAL);
+	TRACE_COUNT(TRACE_BYTES_READ, image->map_size);
+	return PPM_OK;
+}
+
+/**
+ * \brief 	    check the layout of the pixels
+ * \param[in] 	image: mapped image
+ * \return 		1 if the pixels are 8-bit RGB, so they can be read in place.
+ */
+int
+ppm_is_rgb(const ppm_t* image)
+{
+	return image->format == '6' && image->maxval == 255;
+}
+
+/**
+ * \brief 	    convert a row of pixels to 8-bit RGB
+ * \note 	    the gray samples fill the three channels, the set bits of
+ *              a bitmap are black.
+ * \param[in] 	image: mapped image
+ * \param[in] 	raw: row of the image
+ * \param[out] 	rgb: 3*width bytes
+ */
+void
+ppm_row(const ppm_t* image, int32_t raw, uint8_t* rgb)
+{
+	const uint8_t* src = image->pixels + (size_t)raw*image->stride;
+	size_t bytes = image->maxval > 255 ? 2 : 1;
+
+	switch (image->format) {
+		case '6':
+			if (image->maxval == 255) {
+				memcpy(rgb, src, 3*(size_t)image->width);
+			} else {
+				for (size_t i = 0; i < 3*(size_t)image->width; ++i)
+					rgb[i] = ppm_sample(image, src + bytes*i);
+			}
+			break;
+		case '5':
+			for (int32_t col = 0; col < image->width; ++col) {
+				uint8_t value = ppm_sample(image, src + bytes*(size_t)col);
+				rgb[3*(size_t)col] = rgb[3*(size_t)col + 1] = rgb[3*(size_t)col + 2] = value;
+			}
+			break;
+		default:
+			for (int32_t col = 0; col < image->width; ++col) {
+				uint8_t value = (src[col / 8] >> (7 - col % 8)) & 1 ? 0 : 255;
+				rgb[3*(size_t)col] = rgb[3*(size_t)col + 1] = rgb[3*(size_t)col + 2] = value;
+			}
+			break;
+	}
+}
+
+/**
+ * \brief 	    unmap an image
+ * \note 	    the buffer of an image read by ppm_parse belongs to the caller.
+ * \param[in] 	image: image
+ */
+void
+ppm_close(ppm_t* image)
+{
+	if (image->map != NULL) {
+		munmap(image->map, image->map_size);
+	}
+	image->map = NULL;
+	image->data = NULL;
+	image->pixels = NULL;
+}
@@ -0,0 +1,94 @@
+/**
+ * \file            ppm.h
+ * \brief           Memory-mapped reader of the netpbm images
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of ppm.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+#ifndef PPM_H
+#define PPM_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define PPM_OK 0 /* image mapped */
+#define PPM_NOT_FOUND 1 /* the file can not be opened */
+#define PPM_FORMAT_ERROR 2 /* the header is not P4, P5 or P6 */
+#define PPM_TRUNCATED 3 /* the file ends before the last pixel */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		ppm_t
+ * \note		A P6 (RGB), P5 (gray) or P4 (bitmap) image mapped in memory, or read
+ *              from a buffer of the caller.
+ *              The samples of maxval greater than 255 take two bytes, big endian.
+*/
+typedef struct
+{
+	uint8_t* 	    map; 	        /*!< mapping of the file, NULL for a buffer of the caller */
+	size_t 	        map_size; 	    /*!< size of the mapping */
+	const uint8_t* 	data; 	        /*!< bytes of the image file */
+	size_t 	        size; 	        /*!< num of bytes of the image file */
+	const uint8_t* 	pixels; 	    /*!< first byte of the pixels */
+	size_t 	        stride; 	    /*!< bytes of a row of pixels */
+	int32_t 	    width, height; 	/*!< image shape */
+	int32_t 	    maxval; 	    /*!< max value of a sample, 1 for P4 */
+	char 	        format; 	    /*!< '4', '5' or '6' */
+} ppm_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	ppm_open(ppm_t*, const char*);
+int 	ppm_parse(ppm_t*, const uint8_t*, size_t);
+int 	ppm_is_rgb(const ppm_t*);
+void 	ppm_row(const ppm_t*, int32_t, uint8_t*);
+void 	ppm_close(ppm_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,234 @@
+/**
+ * \file 		ppmgen.c
+ * \brief 		Define the main function of the generator of synthetic images for the bench
+ */
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define kind (argv[1]) /* noise, flat, stripes or painting */
+#define megapixels (argv[2]) /* size of the image */
+#define output_file (argv[3]) /* P6 image */
+#define PPMGEN_OCTAVES 9 /* octaves of the luminance of a painting, periods from 512 to 2 pixels */
+#define PPMGEN_STRIPE 12 /* width of a stripe */
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+uint64_t 	ppmgen_state; 	/*!< state of the random generator */
+uint32_t 	ppmgen_seed; 	/*!< seed of the lattices */
+
+uint64_t 	ppmgen_random(void);
+uint32_t 	ppmgen_hash(int32_t, int32_t, uint32_t);
+float 		ppmgen_value(float, float, uint32_t);
+uint8_t 	ppmgen_clamp(float);
+void 		ppmgen_painting(int32_t, int32_t, uint8_t*);
+int 		main(int, char**);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    next random word, xorshift64*
+ * \return 		random word
+ */
+uint64_t
+ppmgen_random(void)
+{
+	ppmgen_state ^= ppmgen_state >> 12;
+	ppmgen_state ^= ppmgen_state << 25;
+	ppmgen_state ^= ppmgen_state >> 27;
+	return ppmgen_state * UINT64_C(0x2545F4914F6CDD1D);
+}
+
+/**
+ * \brief 	    random value of a node of a lattice
+ * \param[in] 	x: column of the node
+ * \param[in] 	y: row of the node
+ * \param[in] 	lattice: index of the lattice
+ * \return 		random word
+ */
+uint32_t
+ppmgen_hash(int32_t x, int32_t y, uint32_t lattice)
+{
+	uint32_t h = (uint32_t)x * 0x8da6b343u ^ (uint32_t)y * 0xd8163841u ^ lattice * 0xcb1ab31fu ^ ppmgen_seed;
+
+	h ^= h >> 16;
+	h *= 0x7feb352du;
+	h ^= h >> 15;
+	h *= 0x846ca68bu;
+	return h ^ (h >> 16);
+}
+
+/**
+ * \brief 	    value noise, smooth interpolation of a random lattice
+ * \param[in] 	x: column in units of the lattice
+ * \param[in] 	y: row in units of the lattice
+ * \param[in] 	lattice: index of the lattice
+ * \return 		value in [0, 1)
+ */
+float
+ppmgen_value(float x, float y, uint32_t lattice)
+{
+	int32_t ix = (int32_t)x, iy = (int32_t)y;
+	float fx = x - ix, fy = y - iy, top, bottom;
+
+	fx = fx*fx*(3 - 2*fx);
+	fy = fy*fy*(3 - 2*fy);
+	top = ppmgen_hash(ix, iy, lattice) + fx*((float)ppmgen_hash(ix + 1, iy, lattice) - ppmgen_hash(ix, iy, lattice));
+	bottom = ppmgen_hash(ix, iy + 1, lattice) +
+		fx*((float)ppmgen_hash(ix + 1, iy + 1, lattice) - ppmgen_hash(ix, iy + 1, lattice));
+	return (top + fy*(bottom - top)) * (1.f / 4294967296.f);
+}
+
+/**
+ * \brief 	    clamp a channel
+ * \param[in] 	value: channel
+ * \return 		channel in [0, 255]
+ */
+uint8_t
+ppmgen_clamp(float value)
+{
+	return value < 0 ? 0 : value > 255 ? 255 : (uint8_t)value;
+}
+
+/**
+ * \brief 	    a row of a painting-like image
+ * \note 	    the luminance is a sum of octaves of value noise whose amplitude is
+ *              their period, so the spectrum falls as 1/f like in the photos of
+ *              paintings. Two coarse fields tint the colors and a fine grain plays
+ *              the canvas.
+ * \param[in] 	raw: row
+ * \param[in] 	width: num of pixels
+ * \param[out] 	row: width RGB pixels
+ */
+void
+ppmgen_painting(int32_t raw, int32_t width, uint8_t* row)
+{
+	for (int32_t col = 0; col < width; ++col) {
+		float luminance = 0, total = 0, warm, green, grain;
+
+		for (uint32_t octave = 0; octave < PPMGEN_OCTAVES; ++octave) {
+			float period = (float)(512 >> octave);
+
+			luminance += period * ppmgen_value(col / period, raw / period, octave);
+			total += period;
+		}
+		luminance = 255 * luminance / total;
+		warm = 80 * (ppmgen_value(col / 700.f, raw / 700.f, 100) - 0.5f);
+		green = 50 * (ppmgen_value(col / 300.f, raw / 300.f, 101) - 0.5f);
+		grain = (float)(ppmgen_random() >> 61) - 3.5f;
+		row[3*col] = ppmgen_clamp(1.3f*(luminance - 128) + 128 + warm + grain);
+		row[3*col + 1] = ppmgen_clamp(1.3f*(luminance - 128) + 128 + green + grain);
+		row[3*col + 2] = ppmgen_clamp(1.3f*(luminance - 128) + 128 - warm + grain);
+	}
+}
+
+
+/*******************/
+/*!< main function */
+/*******************/
+
+/**
+ * \brief 	    main
+ * \note 	    write a synthetic P6 image of about 4:3 ratio.
+ * \param[in] 	argc: 4 or 5
+ * \param[in] 	argv[0]: current executable name
+ *              argv[1]: kind: 'noise' (uniform pixels), 'flat' (a single color),
+ *              'stripes' (diagonal stripes of two colors) or 'painting'
+ *              argv[2]: megapixels, from 0.000001 to 100
+ *              argv[3]: image file
+ *              argv[4]: seed (optional)
+ * \return 		'EXIT_SUCCESS': any error
+ *              'EXIT_FAILURE': error encountered
+ */
+int
+main(int argc, char** argv)
+{
+	double size;
+	int32_t width, height;
+	uint8_t* row;
+	FILE* fp;
+	int output = 0;
+
+	if (argc < 4) {
+		fprintf(stderr, "\t> usage: ppmgen noise|flat|stripes|painting megapixels image [seed]\n");
+		return EXIT_FAILURE;
+	}
+	size = atof(megapixels);
+	if (!(size >= 1e-6 && size <= 100)) {
+		fprintf(stderr, "\t> megapixels out of range %s\n", megapixels);
+		return EXIT_FAILURE;
+	}
+	if (strcmp(kind, "noise") && strcmp(kind, "flat") && strcmp(kind, "stripes") && strcmp(kind, "painting")) {
+		fprintf(stderr, "\t> unknown kind %s\n", kind);
+		return EXIT_FAILURE;
+	}
+	ppmgen_state = argc > 4 ? strtoull(argv[4], NULL, 10) | 1 : UINT64_C(0x9E3779B97F4A7C15);
+	ppmgen_seed = (uint32_t)ppmgen_random();
+	width = (int32_t)(sqrt(size * 1e6 * 4 / 3) + 0.5);
+	width = width > 0 ? width : 1;
+	height = (int32_t)(size * 1e6 / width + 0.5);
+	height = height > 0 ? height : 1;
+
+	row = malloc(3*(size_t)width);
+	fp = fopen(output_file, "wb");
+	if (row == NULL || fp == NULL) {
+		fprintf(stderr, row == NULL ? "\t> out of memory\n" : "\t> file not found: output %s\n", output_file);
+		free(row);
+		if (fp != NULL) {
+			fclose(fp);
+		}
+		return EXIT_FAILURE;
+	}
+
+	fprintf(fp, "P6\n%d %d\n255\n", width, height);
+	for (int32_t raw = 0; !output && raw < height; ++raw) {
+		if (kind[0] == 'n') {
+			for (int32_t i = 0; i < 3*width; ++i)
+				row[i] = (uint8_t)(ppmgen_random() >> 56);
+		} else if (kind[0] == 'f') {
+			for (int32_t col = 0; col < width; ++col) {
+				row[3*col] = 128;
+				row[3*col + 1] = 96;
+				row[3*col + 2] = 64;
+			}
+		} else if (kind[0] == 's') {
+			for (int32_t col = 0; col < width; ++col) {
+				int dark = (col + raw/2) / PPMGEN_STRIPE % 2;
+
+				row[3*col] = dark ? 40 : 220;
+				row[3*col + 1] = dark ? 50 : 200;
+				row[3*col + 2] = dark ? 90 : 160;
+			}
+		} else {
+			ppmgen_painting(raw, width, row);
+		}
+		output = fwrite(row, 3, width, fp) != (size_t)width;
+	}
+
+	free(row);
+	if (fclose(fp) != 0 || output) {
+		fprintf(stderr, "\t> write error: output %s\n", output_file);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+/**
+ * \file 		profile.c
+ * \brief 		define profile_read, profile_free
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of profile.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "profile.h"
+#include "binfile.h"
+#include "radix.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define PROFILE_CHUNK 4096 /* num of grams read at once */
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	profile_sort(profile_t*);
+int 	profile_read_v1(profile_t*, const char*);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    sort a profile by packed gram, merging the equal grams
+ * \note 	    the syntheses are already sorted, this is only needed by old files.
+ * \param[in] 	profile: profile
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+profile_sort(profile_t* profile)
+{
+	size_t* order = malloc((profile->size ? profile->size : 1) * sizeof (size_t));
+	uint32_t* counts = malloc((profile->size ? profile->size : 1) * sizeof (uint32_t));
+	size_t size = 0;
+
+	if (order == NULL || counts == NULL) {
+		free(order);
+		free(counts);
+		return 1;
+	}
+	for (size_t i = 0; i < profile->size; ++i)
+		order[i] = i;
+	if (radix_sort(profile->codes, order, profile->size, 8*sizeof (uint64_t), NULL, NULL)) {
+		free(order);
+		free(counts);
+		return 1;
+	}
+	for (size_t i = 0; i < profile->size; ++i) {
+		if (size > 0 && profile->codes[size - 1] == profile->codes[i]) {
+			counts[size - 1] += profile->counts[order[i]];
+		} else {
+			profile->codes[size] = profile->codes[i];
+			counts[size++] = profile->counts[order[i]];
+		}
+	}
+	free(profile->counts);
+	free(order);
+	profile->counts = counts;
+	profile->size = size;
+	return 0;
+}
+
+/**
+ * \brief 	    read the profile of a synthesis file of version 1
+ * \note 	    only the grams and their recurrences are read, the maps are skipped.
+ * \param[out] 	profile: profile
+ * \param[in] 	path: synthesis file path
+ * \return 		PROFILE_OK: any error.
+ *              PROFILE_NOT_FOUND: the file can not be opened.
+ *              PROFILE_FORMAT_ERROR: wrong or truncated file, or grams larger than 8x8.
+ *              PROFILE_OUT_OF_MEMORY: out of memory.
+ */
+int
+profile_read_v1(profile_t* profile, const char* path)
+{
+	FILE* fp = fopen(path, "rb");
+	int32_t gram_size, num_of_grams, gram_bits;
+	uint8_t* chunk;
+	bool sorted = true;
+
+	memset(profile, 0, sizeof (profile_t));
+	if (fp == NULL) {
+		return PROFILE_NOT_FOUND;
+	}
+	if (fread(&gram_size, sizeof (int32_t), 1, fp) != 1 || fread(&num_of_grams, sizeof (int32_t), 1, fp) != 1 ||
+		gram_size < 1 || gram_size > 8 || num_of_grams < 0) {
+		fclose(fp);
+		return PROFILE_FORMAT_ERROR;
+	}
+	gram_bits = gram_size*gram_size;
+	profile->gram_size = gram_size;
+	profile->size = (size_t)num_of_grams;
+	profile->codes = malloc((profile->size ? profile->size : 1) * sizeof (uint64_t));
+	profile->counts = malloc((profile->size ? profile->size : 1) * sizeof (uint32_t));
+	chunk = malloc(PROFILE_CHUNK * (size_t)gram_bits);
+	if (profile->codes == NULL || profile->counts == NULL || chunk == NULL) {
+		free(chunk);
+		profile_free(profile);
+		fclose(fp);
+		return PROFILE_OUT_OF_MEMORY;
+	}
+
+	/* grams */
+	for (size_t first = 0; first < profile->size; first += PROFILE_CHUNK) {
+		size_t len = profile->size - first < PROFILE_CHUNK ? profile->size - first : PROFILE_CHUNK;
+
+		if (fread(chunk, (size_t)gram_bits, len, fp) != len) {
+			free(chunk);
+			profile_free(profile);
+			fclose(fp);
+			return PROFILE_FORMAT_ERROR;
+		}
+		for (size_t i = 0; i < len; ++i) {
+			const uint8_t* gram = chunk + i*(size_t)gram_bits;
+			uint64_t code = 0;
+
+			for (int32_t b = 0; b < gram_bits; ++b)
+				code = (code << 1) | (gram[b] & 1);
+			profile->codes[first + i] = code;
+			sorted = sorted && (first + i == 0 || profile->codes[first + i - 1] < code);
+		}
+	}
+	free(chunk);
+
+	/* recurrences */
+	if (fread(profile->counts, sizeof (uint32_t), profile->size, fp) != profile->size) {
+		profile_free(profile);
+		fclose(fp);
+		return PROFILE_FORMAT_ERROR;
+	}
+	fclose(fp);
+	for (size_t i = 0; i < profile->size; ++i)
+		profile->total += profile->counts[i];
+
+	if (!sorted && profile_sort(profile)) {
+		profile_free(profile);
+		return PROFILE_OUT_OF_MEMORY;
+	}
+	return PROFILE_OK;
+}
+
+/**
+ * \brief 	    read the profile of a synthesis file
+ * \note 	    the files of version 2 are mapped and only the sections of the grams and
+ *              of the recurrences are read, the files of version 1 are still accepted.
+ * \param[out] 	profile: profile
+ * \param[in] 	path: synthesis file path
+ * \return 		PROFILE_OK: any error.
+ *              PROFILE_NOT_FOUND: the file can not be opened.
+ *              PROFILE_FORMAT_ERROR: wrong or truncated file, grams larger than 8x8, or grams
+ *              of the multilayer model.
+ *              PROFILE_OUT_OF_MEMORY: out of memory.
+ */
+int
+profile_read(profile_t* profile, const char* path)
+{
+	binfile_t file;
+	const uint32_t* counts;
+	uint64_t size = 0;
+	int output = binfile_open(&file, path);
+
+	memset(profile, 0, sizeof (profile_t));
+	if (output == BINFILE_VERSION_1) {
+		return profile_read_v1(profile, path);
+	} else if (output != BINFILE_OK) {
+		return output == BINFILE_NOT_FOUND ? PROFILE_NOT_FOUND : PROFILE_FORMAT_ERROR;
+	}
+
+	counts = binfile_section(&file, BINFILE_COUNTS, &size);
+	if (file.header.model == 1 || file.header.gram_size < 1 || file.header.gram_size > 8 || counts == NULL ||
+		size != file.header.num_of_grams * sizeof (uint32_t)) {
+		binfile_close(&file);
+		return PROFILE_FORMAT_ERROR;
+	}
+	profile->gram_size = file.header.gram_size;
+	profile->size = (size_t)file.header.num_of_grams;
+	profile->codes = malloc((profile->size ? profile->size : 1) * sizeof (uint64_t));
+	profile->counts = malloc((profile->size ? profile->size : 1) * sizeof (uint32_t));
+	if (profile->codes == NULL || profile->counts == NULL) {
+		profile_free(profile);
+		binfile_close(&file);
+		return PROFILE_OUT_OF_MEMORY;
+	}
+	if (binfile_decode_grams(&file, profile->codes, profile->size) != profile->size) {
+		profile_free(profile);
+		binfile_close(&file);
+		return PROFILE_FORMAT_ERROR;
+	}
+	memcpy(profile->counts, counts, profile->size * sizeof (uint32_t));
+	binfile_close(&file);
+	for (size_t i = 0; i < profile->size; ++i)
+		profile->total += profile->counts[i];
+	return PROFILE_OK;
+}
+
+/**
+ * \brief 	    free a profile
+ * \param[in] 	profile: profile
+ */
+void
+profile_free(profile_t* profile)
+{
+	free(profile->codes);
+	free(profile->counts);
+	profile->codes = NULL;
+	profile->counts = NULL;
+	profile->size = 0;
+	profile->total = 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * \file            profile.h
+ * \brief           Gram profile of a synthesis file
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of profile.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define PROFILE_OK 0 /* profile read */
+#define PROFILE_NOT_FOUND 1 /* the file can not be opened */
+#define PROFILE_FORMAT_ERROR 2 /* the file is not a synthesis or its grams do not fit 64 bits */
+#define PROFILE_OUT_OF_MEMORY 3 /* out of memory */
+
+
+/**********************/
+/*!< types definition */
+/**********************/
+
+/**
+ * \brief 		profile_t
+ * \note		Sparse vector of the recurrences of the grams of a synthesis,
+ *              sorted by packed gram. The first pixel of a gram is the most
+ *              significant bit of its code.
+*/
+typedef struct
+{
+	uint64_t* 	codes; 		/*!< packed grams, ascending */
+	uint32_t* 	counts; 	/*!< recurrences of the grams */
+	size_t 		size; 		/*!< num of distinct grams */
+	uint64_t 	total; 		/*!< num of grams */
+	int32_t 	gram_size; 	/*!< side of the grams */
+} profile_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	profile_read(profile_t*, const char*);
+void 	profile_free(profile_t*);
+
+
+#endif /* guard */
@@ -0,0 +1,156 @@
+/**
+ * \file 		radix.c
+ * \brief 		Define radix_sort function
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of radix.
+ *
+ * Author: 		Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "radix.h"
+#include "trace.h"
+#include <string.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define RADIX_BITS 8 /* bits of a digit */
+#define RADIX_SIZE (1 << RADIX_BITS) /* num of buckets */
+#define RADIX_PASSES (64 / RADIX_BITS) /* max num of digits */
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    perform a LSD radix sort of keys, moving the values with them
+ * \note 	    the sort is stable. The histograms of all digits are computed in one pass
+ *              and the digits shared by all keys are skipped.
+ * \param[in] 	keys: keys to sort
+ * \param[in] 	values: values attached to the keys
+ * \param[in] 	len: num of keys
+ * \param[in] 	bits: num of significant bits of the keys
+ * \param[in] 	scratch_keys: len keys of scratch, as a buffer of an arena, NULL to allocate them
+ * \param[in] 	scratch_values: len values of scratch, NULL to allocate them
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+radix_sort(uint64_t* const keys, size_t* const values, size_t len, uint32_t bits,
+	uint64_t* scratch_keys, size_t* scratch_values)
+{
+	size_t count[RADIX_PASSES][RADIX_SIZE];
+	uint64_t *src_keys = keys, *dst_keys = scratch_keys;
+	size_t *src_values = values, *dst_values = scratch_values;
+	uint32_t passes = (bits + RADIX_BITS - 1) / RADIX_BITS;
+
+	if (len < 2 || passes == 0) {
+		return 0;
+	}
+	if (passes > RADIX_PASSES) {
+		passes = RADIX_PASSES;
+	}
+
+	if (scratch_keys == NULL) {
+		dst_keys = malloc(len * sizeof (uint64_t));
+		TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+	}
+	if (scratch_values == NULL) {
+		dst_values = malloc(len * sizeof (size_t));
+		TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+	}
+	if (dst_keys == NULL || dst_values == NULL) {
+		if (scratch_keys == NULL) {
+			free(dst_keys);
+		}
+		if (scratch_values == NULL) {
+			free(dst_values);
+		}
+		return 1;
+	}
+	memset(count, 0, passes * sizeof (*count));
+
+	/* histograms of every digit */
+	for (size_t i = 0; i < len; ++i) {
+		uint64_t key = keys[i];
+		for (uint32_t p = 0; p < passes; ++p)
+			++count[p][(key >> (p*RADIX_BITS)) & (RADIX_SIZE-1)];
+	}
+
+	for (uint32_t p = 0; p < passes; ++p) {
+		uint32_t shift = p*RADIX_BITS;
+		size_t offset = 0;
+
+		/* all keys have the same digit */
+		if (count[p][(src_keys[0] >> shift) & (RADIX_SIZE-1)] == len) {
+			continue;
+		}
+
+		for (uint32_t d = 0; d < RADIX_SIZE; ++d) {
+			size_t c = count[p][d];
+			count[p][d] = offset;
+			offset += c;
+		}
+		for (size_t i = 0; i < len; ++i) {
+			size_t j = count[p][(src_keys[i] >> shift) & (RADIX_SIZE-1)]++;
+			dst_keys[j] = src_keys[i];
+			dst_values[j] = src_values[i];
+		}
+
+		{
+			uint64_t* tmp_keys = src_keys;
+			size_t* tmp_values = src_values;
+			src_keys = dst_keys;
+			src_values = dst_values;
+			dst_keys = tmp_keys;
+			dst_values = tmp_values;
+		}
+	}
+
+	/* the result is in the buffers */
+	if (src_keys != keys) {
+		memcpy(keys, src_keys, len * sizeof (uint64_t));
+		memcpy(values, src_values, len * sizeof (size_t));
+	}
+
+	if (scratch_keys == NULL) {
+		free(src_keys != keys ? src_keys : dst_keys);
+	}
+	if (scratch_values == NULL) {
+		free(src_values != values ? src_values : dst_values);
+	}
+	return 0;
+}
@@ -1,6 +1,6 @@
 /**
  * \file 		select.c
- * \brief 		Define select function
+ * \brief 		Define select functions
  */
 
 /*
@@ -38,45 +38,198 @@
 /**********************/
 
 #include "select.h"
+#include <stddef.h>
+#include <string.h>
 
 
 /***********************/
 /*!< MACRO definitions */
 /***********************/
 
+#define SELECT_SMALL 16 /* partitions up to this length are sorted by insertion */
+#define SELECT_BUFFER 64 /* max num of bytes of a pivot copied on the stack */
+
 /**
- * \brief 			swap data
+ * \brief 			swap data, a word at a time
  * \param[in]       a: first reference
  * \param[in]       b: second reference
  * \param[in] 		size: num of bytes to swap
  * \hideinitializer
  */
-#define SWAP(a, b, size) 			\
-do { 								\
-	size_t __size = (size); 		\
-	char *__a = (a), *__b = (b); 	\
-	do { 							\
-		char __tmp = *__a; 			\
-		*__a++ = *__b; 				\
-		*__b++ = __tmp; 			\
-	} while (--__size > 0); 		\
+#define SWAP(a, b, size) 										\
+do { 															\
+	size_t __size = (size); 									\
+	char *__a = (char*)(a), *__b = (char*)(b); 					\
+	for (; __size >= sizeof (uint64_t); __size -= sizeof (uint64_t)) { 	\
+		uint64_t __tmp; 										\
+		memcpy(&__tmp, __a, sizeof (uint64_t)); 				\
+		memcpy(__a, __b, sizeof (uint64_t)); 					\
+		memcpy(__b, &__tmp, sizeof (uint64_t)); 				\
+		__a += sizeof (uint64_t); 								\
+		__b += sizeof (uint64_t); 								\
+	} 															\
+	for (; __size > 0; --__size) { 							\
+		char __tmp = *__a; 										\
+		*__a++ = *__b; 											\
+		*__b++ = __tmp; 										\
+	} 															\
 }while (0)
 
+#define SELECT_BAD 3 /* bad partitions around medians of three before the medians of medians */
+
 /**
- * \brief 			copy data
- * \param[in]       dest: destination reference
- * \param[in]       src: source reference
- * \param[in] 		size: num of byte
+ * \brief 			a partition is bad when it keeps more than 3/4 of the components
+ * \param[in]       kept: num of components kept
+ * \param[in]       len: num of components partitioned
  * \hideinitializer
  */
-#define CPY(dest, src, size) 				\
-do { 										\
-	size_t __size = (size); 				\
-	char *__dest = (dest), *__src = (src); 	\
-	do { 									\
-		*__dest++ = *__src++; 				\
-	} while (--__size > 0); 				\
-}while (0)
+#define BAD(kept, len) ((kept) > (len) - (len)/4)
+
+/**
+ * \brief 			natural order of numbers
+ * \hideinitializer
+ */
+#define LESS(a, b) ((a) < (b))
+
+/**
+ * \brief 			define an iterative introselect of a type and its batch mode
+ * \note 			three-way partitions around the median of three, median of medians
+ *                  after SELECT_BAD bad partitions. Ranks start from 1.
+ * \param[in]       name: name of the function
+ * \param[in]       type: type of the components
+ * \param[in]       less: order of the components
+ * \hideinitializer
+ */
+#define SELECT_DEFINE(name, type, less) 											\
+static void 																		\
+name##_insertion(type* vec, size_t len) 											\
+{ 																					\
+	for (size_t i = 1; i < len; ++i) { 												\
+		type tmp = vec[i]; 															\
+		size_t j = i; 																\
+		for (; j > 0 && less(tmp, vec[j-1]); --j) 									\
+			vec[j] = vec[j-1]; 														\
+		vec[j] = tmp; 																\
+	} 																				\
+} 																					\
+																					\
+static type 																		\
+name##_pivot(type* vec, size_t len, uint32_t depth) 								\
+{ 																					\
+	if (depth > 0) { 																\
+		type a = vec[0], b = vec[len/2], c = vec[len-1]; 							\
+		return less(a, b) ? (less(b, c) ? b : (less(a, c) ? c : a)) 				\
+			: (less(a, c) ? a : (less(b, c) ? c : b)); 								\
+	} 																				\
+	for (size_t g = 0; g < len/5; ++g) { 											\
+		type tmp; 																	\
+		name##_insertion(vec + 5*g, 5); 											\
+		tmp = vec[g]; vec[g] = vec[5*g + 2]; vec[5*g + 2] = tmp; 					\
+	} 																				\
+	return name(vec, len/5, (len/5 + 1)/2); 										\
+} 																					\
+																					\
+type 																				\
+name(type* const vec, size_t len, size_t k) 										\
+{ 																					\
+	type* lo = vec; 																\
+	uint32_t depth = SELECT_BAD; 													\
+																					\
+	k = k ? k : 1; 																	\
+	while (len > SELECT_SMALL) { 													\
+		type pivot = name##_pivot(lo, len, depth); 									\
+		size_t lt = 0, i = 0, gt = len, n = len; 									\
+																					\
+		while (i < gt) { 															\
+			if (less(pivot, lo[i])) { 												\
+				type tmp = lo[i]; lo[i] = lo[--gt]; lo[gt] = tmp; 					\
+			} else if (less(lo[i], pivot)) { 										\
+				type tmp = lo[i]; lo[i++] = lo[lt]; lo[lt++] = tmp; 				\
+			} else { 																\
+				++i; 																\
+			} 																		\
+		} 																			\
+		if (k <= lt) { 																\
+			len = lt; 																\
+		} else if (k <= gt) { 														\
+			return pivot; 															\
+		} else { 																	\
+			lo += gt; 																\
+			len -= gt; 																\
+			k -= gt; 																\
+		} 																			\
+		depth -= depth > 0 && BAD(len, n); 											\
+	} 																				\
+	name##_insertion(lo, len); 														\
+	return lo[k-1]; 																\
+} 																					\
+																					\
+int 																				\
+name##_batch(type* const vec, size_t len, const size_t* ks, size_t num_of_ks, type* out) 	\
+{ 																					\
+	struct { size_t lo, len, first, last; uint32_t depth; } *stack; 				\
+	size_t top = 0; 																\
+																					\
+	if (len == 0 || num_of_ks == 0) { 												\
+		return 0; 																	\
+	} 																				\
+	stack = malloc((num_of_ks + 1) * sizeof (*stack)); 								\
+	if (stack == NULL) { 															\
+		return 1; 																	\
+	} 																				\
+	stack[top].lo = 0; 																\
+	stack[top].len = len; 															\
+	stack[top].first = 0; 															\
+	stack[top].last = num_of_ks; 													\
+	stack[top++].depth = SELECT_BAD; 												\
+	while (top) { 																	\
+		size_t lo = stack[--top].lo, n = stack[top].len; 							\
+		size_t first = stack[top].first, last = stack[top].last; 					\
+		uint32_t depth = stack[top].depth; 											\
+		size_t lt = 0, i = 0, gt = n, split; 										\
+		type pivot; 																\
+																					\
+		if (n <= SELECT_SMALL || last - first == 1) { 								\
+			if (n <= SELECT_SMALL) { 												\
+				name##_insertion(vec + lo, n); 										\
+			} else { 																\
+				name(vec + lo, n, (ks[first] ? ks[first] : 1) - lo); 				\
+			} 																		\
+			continue; 																\
+		} 																			\
+		pivot = name##_pivot(vec + lo, n, depth); 									\
+		while (i < gt) { 															\
+			type* v = vec + lo; 													\
+			if (less(pivot, v[i])) { 												\
+				type tmp = v[i]; v[i] = v[--gt]; v[gt] = tmp; 						\
+			} else if (less(v[i], pivot)) { 										\
+				type tmp = v[i]; v[i++] = v[lt]; v[lt++] = tmp; 					\
+			} else { 																\
+				++i; 																\
+			} 																		\
+		} 																			\
+		for (split = first; split < last && ks[split] <= lo + lt; ++split); 		\
+		if (split > first) { 														\
+			stack[top].lo = lo; 													\
+			stack[top].len = lt; 													\
+			stack[top].first = first; 												\
+			stack[top].last = split; 												\
+			stack[top++].depth = depth - (depth > 0 && BAD(lt, n)); 				\
+		} 																			\
+		for (first = split; first < last && ks[first] <= lo + gt; ++first); 		\
+		if (last > first) { 														\
+			stack[top].lo = lo + gt; 												\
+			stack[top].len = n - gt; 												\
+			stack[top].first = first; 												\
+			stack[top].last = last; 												\
+			stack[top++].depth = depth - (depth > 0 && BAD(n - gt, n)); 			\
+		} 																			\
+	} 																				\
+	free(stack); 																	\
+	for (size_t j = 0; j < num_of_ks; ++j) 											\
+		out[j] = vec[(ks[j] ? ks[j] : 1) - 1]; 										\
+	return 0; 																		\
+}
 
 
 /*************************/
@@ -84,8 +237,9 @@ do { 										\
 /*************************/
 
 void* 	select_pivot(void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*);
+void* 	select_mom(void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*);
 void 	select_partition(void* const, void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*, void** , void**);
-void* 	prv__select(void* const, void* const, size_t, size_t, size_t, int (*)(const void*, const void*, void*), void*);
+void 	select_insertion(void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*);
 
 
 /******************************/
@@ -126,6 +280,29 @@ select_pivot(void* const vec, size_t len, size_t el_size, int (*cmp)(const void*
 	}
 }
 
+/**
+ * \brief 	    compute the pivot as median of medians
+ * \note 	    the medians of the groups of 5 components are moved at the begin of the
+ *              vector, so the pivot splits the vector at least 3/10 - 7/10.
+ * \param[in] 	vec: reference at the first component of the vector
+ * \param[in] 	len: num of components, at least 5
+ * \param[in] 	el_size: num of bytes of a component
+ * \param[in] 	cmp: comparison function
+ * \param[in] 	args: reference at the context of the comparison
+ * \return 		reference at the pivot.
+ */
+void*
+select_mom(void* const vec, size_t len, size_t el_size, int (*cmp)(const void*, const void*, void*), void* args)
+{
+	char* base = vec;
+
+	for (size_t g = 0; g < len/5; ++g) {
+		select_insertion(base + 5*g*el_size, 5, el_size, cmp, args);
+		SWAP(base + g*el_size, base + (5*g + 2)*el_size, el_size);
+	}
+	return select(vec, len/5, el_size, (len/5 + 1)/2, cmp, args);
+}
+
 /**
  * \brief 	    perform the partition of the quick_select.
  * \note 	    It's important that pivot is allocated outside of the vector.
@@ -166,53 +343,175 @@ select_partition(void* const pivot, void* const vec, size_t len, size_t el_size,
 }
 
 /**
- * \brief 	    perform the quick_select
- * \note 	    use a preallocated buffer.
- * \param[in] 	buf: buffer
+ * \brief 	    perform the insertion sort
+ * \note 	    used for the small partitions.
+ * \param[in] 	vec: reference at the first component of the vector
+ * \param[in] 	len: num of components
+ * \param[in] 	el_size: num of bytes of a component
+ * \param[in] 	cmp: comparison function
+ * \param[in] 	args: reference at the context of the comparison
+ */
+void
+select_insertion(void* const vec, size_t len, size_t el_size, int (*cmp)(const void*, const void*, void*), void* args)
+{
+	char* base = vec;
+
+	for (size_t i = 1; i < len; ++i)
+		for (size_t j = i; j > 0 && cmp(base + (j-1)*el_size, base + j*el_size, args) > 0; --j)
+			SWAP(base + (j-1)*el_size, base + j*el_size, el_size);
+}
+
+/**
+ * \brief 	    perform an iterative introselect
+ * \note 	    the pivots are medians of three until SELECT_BAD partitions keep more
+ *              than 3/4 of their components, then medians of medians. The bad partitions
+ *              are a constant num and the others shrink the range geometrically, so the
+ *              time is linear in the worst case.
+ *              A pivot of more than SELECT_BUFFER bytes is copied on the heap, if it can
+ *              not be allocated the vector is sorted by insertion.
+ *              After the call the k-th component is in its sorted position.
  * \param[in] 	vec: reference at the first component of the vector
  * \param[in] 	len: num of components
  * \param[in] 	el_size: num of bytes of a component
+ * \param[in] 	k: rank of the component, from 1
  * \param[in] 	cmp: comparison function
  * \param[in] 	args: reference at the context of the comparison
+ * \return 		reference at the k-th component.
  */
 void*
-prv__select(void* const buf, void* const vec, const size_t k, size_t len, size_t el_size, int (*cmp)(const void*, const void*, void*), void* args)
+select(void* const vec, size_t len, size_t el_size, const size_t k, int (*cmp)(const void*, const void*, void*), void* args)
 {
-	if (len == 1) {
-		return vec;
-	} else {
-		void *pivot, *l_mid, *u_mid;
-		pivot = select_pivot(vec, len, el_size, cmp, args);
-		CPY(buf, pivot, el_size);
-		select_partition(buf, vec, len, el_size, cmp, args, &l_mid, &u_mid);
+	_Alignas(max_align_t) char small[SELECT_BUFFER];
+	char *lo = vec, *buf = el_size <= SELECT_BUFFER ? small : malloc(el_size);
+	size_t rank = k ? k : 1;
+	uint32_t depth = SELECT_BAD;
 
-		{
-			size_t vec_l_len = ((size_t)l_mid - (size_t)vec)/el_size;
-			size_t vec_m_len = ((size_t)u_mid - (size_t)l_mid)/el_size;
-			size_t vec_u_len = len - vec_m_len - vec_l_len;
-			if (k <= vec_l_len) {
-				return prv__select(buf, vec, k, vec_l_len, el_size, cmp, args);
-			} else if (k - vec_l_len <= vec_m_len) {
-				return l_mid;
-			} else {
-				return prv__select(buf, u_mid, k - vec_l_len - vec_m_len, vec_u_len, el_size, cmp, args);
+	if (buf == NULL) {
+		select_insertion(lo, len, el_size, cmp, args);
+		return lo + (rank-1)*el_size;
+	}
+
+	while (len > SELECT_SMALL) {
+		void *l_mid, *u_mid;
+		size_t vec_l_len, vec_m_len, n = len;
+
+		if (depth > 0) {
+			memcpy(buf, select_pivot(lo, len, el_size, cmp, args), el_size);
+		} else {
+			memcpy(buf, select_mom(lo, len, el_size, cmp, args), el_size);
+		}
+		select_partition(buf, lo, len, el_size, cmp, args, &l_mid, &u_mid);
+
+		vec_l_len = ((size_t)l_mid - (size_t)lo)/el_size;
+		vec_m_len = ((size_t)u_mid - (size_t)l_mid)/el_size;
+		if (rank <= vec_l_len) {
+			len = vec_l_len;
+		} else if (rank - vec_l_len <= vec_m_len) {
+			if (buf != small) {
+				free(buf);
 			}
+			return lo + (rank-1)*el_size;
+		} else {
+			rank -= vec_l_len + vec_m_len;
+			len -= vec_l_len + vec_m_len;
+			lo = u_mid;
 		}
+		depth -= depth > 0 && BAD(len, n);
+	}
+	select_insertion(lo, len, el_size, cmp, args);
+	if (buf != small) {
+		free(buf);
 	}
+	return lo + (rank-1)*el_size;
 }
 
 /**
- * \brief 	    call prv__select
+ * \brief 	    perform several selections in one pass
+ * \note 	    each partition is shared by all the ranks inside it. After the call
+ *              the ks[i]-th component is in its sorted position, for each i.
  * \param[in] 	vec: reference at the first component of the vector
  * \param[in] 	len: num of components
  * \param[in] 	el_size: num of bytes of a component
+ * \param[in] 	ks: ranks of the components, from 1, in increasing order
+ * \param[in] 	num_of_ks: num of ranks
  * \param[in] 	cmp: comparison function
  * \param[in] 	args: reference at the context of the comparison
+ * \return 		0: any error.
+ *              1: out of memory.
  */
-void* select(void* const vec, size_t len, size_t el_size, const size_t k, int (*cmp)(const void*, const void*, void*), void* args)
+int
+select_batch(void* const vec, size_t len, size_t el_size, const size_t* ks, size_t num_of_ks, int (*cmp)(const void*, const void*, void*), void* args)
 {
-	char* buf = malloc(el_size);
-	void* ret = prv__select(buf, vec, k, len, el_size, cmp, args);
-	free(buf);
-	return ret;
+	struct { char* lo; size_t len, first, last; uint32_t depth; } *stack;
+	_Alignas(max_align_t) char small[SELECT_BUFFER];
+	char* buf;
+	size_t top = 0;
+
+	if (len == 0 || num_of_ks == 0) {
+		return 0;
+	}
+	stack = malloc((num_of_ks + 1) * sizeof (*stack));
+	buf = el_size <= SELECT_BUFFER ? small : malloc(el_size);
+	if (stack == NULL || buf == NULL) {
+		free(stack);
+		if (buf != small) {
+			free(buf);
+		}
+		return 1;
+	}
+	stack[top].lo = vec;
+	stack[top].len = len;
+	stack[top].first = 0;
+	stack[top].last = num_of_ks;
+	stack[top++].depth = SELECT_BAD;
+	while (top) {
+		char* lo = stack[--top].lo;
+		size_t n = stack[top].len, first = stack[top].first, last = stack[top].last;
+		size_t offset = (size_t)(lo - (char*)vec)/el_size, vec_l_len, vec_u_begin, split;
+		uint32_t depth = stack[top].depth;
+		void *l_mid, *u_mid;
+
+		if (n <= SELECT_SMALL) {
+			select_insertion(lo, n, el_size, cmp, args);
+			continue;
+		}
+		if (last - first == 1) {
+			select(lo, n, el_size, (ks[first] ? ks[first] : 1) - offset, cmp, args);
+			continue;
+		}
+		if (depth > 0) {
+			memcpy(buf, select_pivot(lo, n, el_size, cmp, args), el_size);
+		} else {
+			memcpy(buf, select_mom(lo, n, el_size, cmp, args), el_size);
+		}
+		select_partition(buf, lo, n, el_size, cmp, args, &l_mid, &u_mid);
+
+		vec_l_len = ((size_t)l_mid - (size_t)lo)/el_size;
+		vec_u_begin = ((size_t)u_mid - (size_t)lo)/el_size;
+		for (split = first; split < last && ks[split] <= offset + vec_l_len; ++split);
+		if (split > first) {
+			stack[top].lo = lo;
+			stack[top].len = vec_l_len;
+			stack[top].first = first;
+			stack[top].last = split;
+			stack[top++].depth = depth - (depth > 0 && BAD(vec_l_len, n));
+		}
+		for (first = split; first < last && ks[first] <= offset + vec_u_begin; ++first);
+		if (last > first) {
+			stack[top].lo = u_mid;
+			stack[top].len = n - vec_u_begin;
+			stack[top].first = first;
+			stack[top].last = last;
+			stack[top++].depth = depth - (depth > 0 && BAD(n - vec_u_begin, n));
+		}
+	}
+	if (buf != small) {
+		free(buf);
+	}
+	free(stack);
+	return 0;
 }
+
+SELECT_DEFINE(select_size_t, size_t, LESS)
+SELECT_DEFINE(select_uint64, uint64_t, LESS)
+SELECT_DEFINE(select_float, float, LESS)
@@ -1,6 +1,6 @@
 /**
  * \file            select.h
- * \brief           Implementation of a dynamic array
+ * \brief           Prototypes of the select functions
  */
 
 /*
@@ -42,13 +42,21 @@
 /**********************/
 
 #include <stdlib.h>
+#include <stdint.h>
 
 
 /*************************/
 /*!< function prototypes */
 /*************************/
 
-void* select(void* const vec, size_t, size_t, size_t, int (*)(const void*, const void*, void*), void*);
+void* 		select(void* const vec, size_t, size_t, size_t, int (*)(const void*, const void*, void*), void*);
+int 		select_batch(void* const, size_t, size_t, const size_t*, size_t, int (*)(const void*, const void*, void*), void*);
+size_t 		select_size_t(size_t* const, size_t, size_t);
+int 		select_size_t_batch(size_t* const, size_t, const size_t*, size_t, size_t*);
+uint64_t 	select_uint64(uint64_t* const, size_t, size_t);
+int 		select_uint64_batch(uint64_t* const, size_t, const size_t*, size_t, uint64_t*);
+float 		select_float(float* const, size_t, size_t);
+int 		select_float_batch(float* const, size_t, const size_t*, size_t, float*);
 
 
 #endif /* SELECT_H */
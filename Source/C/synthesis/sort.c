@@ -1,6 +1,6 @@
 /**
- * \file 		select.c
- * \brief 		Define sort function
+ * \file 		sort.c
+ * \brief 		Define sort functions
  */
 
 /*
@@ -38,46 +38,145 @@
 /**********************/
 
 #include "sort.h"
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 /***********************/
 /*!< MACRO definitions */
 /***********************/
 
+#define SORT_INSERTION 16 /* partitions up to this length are sorted by insertion */
+#define SORT_STACK 64 /* max num of pending partitions, the smaller one is always sorted first */
+#define SORT_BUFFER 64 /* max num of bytes of a pivot copied on the stack */
+
 /**
- * \brief 			swap data
+ * \brief 			swap data, a word at a time
  * \param[in]       a: first reference
  * \param[in]       b: second reference
  * \param[in] 		size: num of bytes to swap
  * \hideinitializer
  */
-#define SWAP(a, b, size) 			\
-do { 								\
-	size_t __size = (size); 		\
-	char *__a = (a), *__b = (b); 	\
-	do { 							\
-		char __tmp = *__a; 			\
-		*__a++ = *__b; 				\
-		*__b++ = __tmp; 			\
-	} while (--__size > 0); 		\
+#define SWAP(a, b, size) 										\
+do { 															\
+	size_t __size = (size); 									\
+	char *__a = (char*)(a), *__b = (char*)(b); 					\
+	for (; __size >= sizeof (uint64_t); __size -= sizeof (uint64_t)) { 	\
+		uint64_t __tmp; 										\
+		memcpy(&__tmp, __a, sizeof (uint64_t)); 				\
+		memcpy(__a, __b, sizeof (uint64_t)); 					\
+		memcpy(__b, &__tmp, sizeof (uint64_t)); 				\
+		__a += sizeof (uint64_t); 								\
+		__b += sizeof (uint64_t); 								\
+	} 															\
+	for (; __size > 0; --__size) { 							\
+		char __tmp = *__a; 										\
+		*__a++ = *__b; 											\
+		*__b++ = __tmp; 										\
+	} 															\
 }while (0)
 
 /**
- * \brief 			copy data
- * \param[in]       dest: destination reference
- * \param[in]       src: source reference
- * \param[in] 		size: num of byte
+ * \brief 			max depth of the quick sort before the heap sort
+ * \param[in]       len: num of components
  * \hideinitializer
  */
-#define CPY(dest, src, size) 				\
-do { 										\
-	size_t __size = (size); 				\
-	char *__dest = (dest), *__src = (src); 	\
-	do { 									\
-		*__dest++ = *__src++; 				\
-	} while (--__size > 0); 				\
-}while (0)
+#define DEPTH(len) (2 * (uint32_t)(63 - __builtin_clzll((unsigned long long)(len) | 1)))
+
+/**
+ * \brief 			natural order of numbers
+ * \hideinitializer
+ */
+#define LESS(a, b) ((a) < (b))
+
+/**
+ * \brief 			define a non-recursive introsort of a type
+ * \note 			three-way partitions around the median of three, heap sort
+ *                  when the depth exceeds DEPTH, insertion sort of small partitions.
+ * \param[in]       name: name of the function
+ * \param[in]       type: type of the components
+ * \param[in]       less: order of the components
+ * \hideinitializer
+ */
+#define SORT_DEFINE(name, type, less) 												\
+static void 																		\
+name##_heap(type* vec, size_t len) 													\
+{ 																					\
+	for (size_t start = len/2, end = len; end > 1; ) { 								\
+		size_t root; 																\
+		if (start > 0) { 															\
+			root = --start; 														\
+		} else { 																	\
+			type tmp = vec[0]; vec[0] = vec[--end]; vec[end] = tmp; 				\
+			root = 0; 																\
+		} 																			\
+		while (2*root + 1 < end) { 													\
+			size_t child = 2*root + 1; 												\
+			if (child + 1 < end && less(vec[child], vec[child + 1])) ++child; 		\
+			if (!less(vec[root], vec[child])) break; 								\
+			{ type tmp = vec[root]; vec[root] = vec[child]; vec[child] = tmp; } 	\
+			root = child; 															\
+		} 																			\
+	} 																				\
+} 																					\
+																					\
+void 																				\
+name(type* const vec, size_t len) 													\
+{ 																					\
+	struct { type* vec; size_t len; uint32_t depth; } stack[SORT_STACK]; 			\
+	size_t top = 0; 																\
+																					\
+	stack[top].vec = vec; 															\
+	stack[top].len = len; 															\
+	stack[top++].depth = DEPTH(len); 												\
+	while (top) { 																	\
+		type* lo = stack[--top].vec; 												\
+		size_t n = stack[top].len; 													\
+		uint32_t depth = stack[top].depth; 											\
+																					\
+		while (n > SORT_INSERTION) { 												\
+			type pivot, a = lo[0], b = lo[n/2], c = lo[n-1]; 						\
+			size_t lt = 0, i = 0, gt = n; 											\
+																					\
+			if (depth-- == 0) { 													\
+				name##_heap(lo, n); 												\
+				n = 0; 																\
+				break; 																\
+			} 																		\
+			pivot = less(a, b) ? (less(b, c) ? b : (less(a, c) ? c : a)) 			\
+				: (less(a, c) ? a : (less(b, c) ? c : b)); 							\
+			while (i < gt) { 														\
+				if (less(pivot, lo[i])) { 											\
+					type tmp = lo[i]; lo[i] = lo[--gt]; lo[gt] = tmp; 				\
+				} else if (less(lo[i], pivot)) { 									\
+					type tmp = lo[i]; lo[i++] = lo[lt]; lo[lt++] = tmp; 			\
+				} else { 															\
+					++i; 															\
+				} 																	\
+			} 																		\
+			if (lt < n - gt) { 														\
+				stack[top].vec = lo + gt; 											\
+				stack[top].len = n - gt; 											\
+				stack[top++].depth = depth; 										\
+				n = lt; 															\
+			} else { 																\
+				stack[top].vec = lo; 												\
+				stack[top].len = lt; 												\
+				stack[top++].depth = depth; 										\
+				lo += gt; 															\
+				n -= gt; 															\
+			} 																		\
+		} 																			\
+		for (size_t i = 1; i < n; ++i) { 											\
+			type tmp = lo[i]; 														\
+			size_t j = i; 															\
+			for (; j > 0 && less(tmp, lo[j-1]); --j) 								\
+				lo[j] = lo[j-1]; 													\
+			lo[j] = tmp; 															\
+		} 																			\
+	} 																				\
+}
 
 
 /*************************/
@@ -86,7 +185,8 @@ do { 										\
 
 void* 	sort_pivot(void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*);
 void 	sort_partition(void* const, void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*, void**, void**);
-void 	prv__sort(void* const, void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*);
+void 	sort_heap(void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*);
+void 	sort_insertion(void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*);
 
 
 /******************************/
@@ -165,9 +265,8 @@ sort_partition(void* const pivot, void* const vec, size_t len, size_t el_size, i
 }
 
 /**
- * \brief 	    perform the quick_sort
- * \note 	    use a preallocated buffer.
- * \param[in] 	buf: buffer
+ * \brief 	    perform the heap sort
+ * \note 	    used when the quick sort goes too deep.
  * \param[in] 	vec: reference at the first component of the vector
  * \param[in] 	len: num of components
  * \param[in] 	el_size: num of bytes of a component
@@ -175,48 +274,37 @@ sort_partition(void* const pivot, void* const vec, size_t len, size_t el_size, i
  * \param[in] 	args: reference at the context of the comparison
  */
 void
-prv__sort(void* const buf, void* const vec, size_t len, size_t el_size, int (*cmp)(const void*, const void*, void*), void* args)
+sort_heap(void* const vec, size_t len, size_t el_size, int (*cmp)(const void*, const void*, void*), void* args)
 {
-	if (len > 3) {
-		void *pivot, *l_mid, *u_mid;
-		size_t vec_l_len, vec_u_len;
-
-		pivot = sort_pivot(vec, len, el_size, cmp, args);
-		CPY(buf, pivot, el_size);
-
-		sort_partition(buf, vec, len, el_size, cmp, args, &l_mid, &u_mid);
-
-		vec_l_len = ((size_t)l_mid - (size_t)vec)/el_size;
-		prv__sort(buf, vec, vec_l_len, el_size, cmp, args);
-
-		vec_u_len = len - ((size_t)u_mid - (size_t)l_mid)/el_size - vec_l_len;
-		prv__sort(buf, u_mid, vec_u_len, el_size, cmp, args);
-	} else if (len == 3) {
-		void *a = vec, *b = vec+el_size, *c = vec+2*el_size;
-
-		if (cmp(a, b, args) > 0) {
-			SWAP(a, b, el_size);
-			if (cmp(b, c, args) > 0) {
-				SWAP(b, c, el_size);
-				if (cmp(a, b, args) > 0) {
-					SWAP(b, c, el_size);
-				}
-			}
-		} else if (cmp(b, c, args) > 0) {
-			SWAP(b, c, el_size);
-			if (cmp(a, b, args) > 0)
-				SWAP(a, c, el_size);
+	char* base = vec;
+
+	for (size_t start = len/2, end = len; end > 1; ) {
+		size_t root;
+
+		if (start > 0) {
+			root = --start;  // build the heap
+		} else {
+			--end;  // move the max after the heap
+			SWAP(base, base + end*el_size, el_size);
+			root = 0;
 		}
-	} else if (len == 2) {
-		if(cmp(vec, vec+el_size, args) > 0) {
-			SWAP(vec, vec+el_size, el_size);
+		while (2*root + 1 < end) {
+			size_t child = 2*root + 1;
+			if (child + 1 < end && cmp(base + child*el_size, base + (child+1)*el_size, args) < 0) {
+				++child;
+			}
+			if (cmp(base + root*el_size, base + child*el_size, args) >= 0) {
+				break;
+			}
+			SWAP(base + root*el_size, base + child*el_size, el_size);
+			root = child;
 		}
 	}
-	return;
 }
 
 /**
- * \brief 	    call prv__sort
+ * \brief 	    perform the insertion sort
+ * \note 	    used for the small partitions.
  * \param[in] 	vec: reference at the first component of the vector
  * \param[in] 	len: num of components
  * \param[in] 	el_size: num of bytes of a component
@@ -224,13 +312,85 @@ prv__sort(void* const buf, void* const vec, size_t len, size_t el_size, int (*cm
  * \param[in] 	args: reference at the context of the comparison
  */
 void
-sort(void* const vec, size_t len, size_t el_size, int (*cmp)(const void*, const void*, void*), void* args)
+sort_insertion(void* const vec, size_t len, size_t el_size, int (*cmp)(const void*, const void*, void*), void* args)
 {
-	char* buf = malloc(el_size);
-	prv__sort(buf, vec, len, el_size, cmp, args);
-	free(buf);
+	char* base = vec;
+
+	for (size_t i = 1; i < len; ++i)
+		for (size_t j = i; j > 0 && cmp(base + (j-1)*el_size, base + j*el_size, args) > 0; --j)
+			SWAP(base + (j-1)*el_size, base + j*el_size, el_size);
 }
 
+/**
+ * \brief 	    perform a non-recursive introsort
+ * \note 	    three-way quick sort with an explicit stack, the smaller partition is sorted first.
+ *              The heap sort bounds the depth, the insertion sort ends the small partitions.
+ *              A pivot of more than SORT_BUFFER bytes is copied on the heap, if it can not
+ *              be allocated the vector is sorted by the heap sort.
+ * \param[in] 	vec: reference at the first component of the vector
+ * \param[in] 	len: num of components
+ * \param[in] 	el_size: num of bytes of a component
+ * \param[in] 	cmp: comparison function
+ * \param[in] 	args: reference at the context of the comparison
+ */
+void
+sort(void* const vec, size_t len, size_t el_size, int (*cmp)(const void*, const void*, void*), void* args)
+{
+	struct { char* vec; size_t len; uint32_t depth; } stack[SORT_STACK];
+	_Alignas(max_align_t) char small[SORT_BUFFER];
+	size_t top = 0;
+	char* buf;
 
+	if (len < 2) {
+		return;
+	}
+	buf = el_size <= SORT_BUFFER ? small : malloc(el_size);
+	if (buf == NULL) {
+		sort_heap(vec, len, el_size, cmp, args);
+		return;
+	}
+	stack[top].vec = vec;
+	stack[top].len = len;
+	stack[top++].depth = DEPTH(len);
+	while (top) {
+		char* lo = stack[--top].vec;
+		size_t n = stack[top].len;
+		uint32_t depth = stack[top].depth;
+
+		while (n > SORT_INSERTION) {
+			void *l_mid, *u_mid;
+			size_t vec_l_len, vec_u_len;
 
+			if (depth-- == 0) {
+				sort_heap(lo, n, el_size, cmp, args);
+				n = 0;
+				break;
+			}
+			memcpy(buf, sort_pivot(lo, n, el_size, cmp, args), el_size);
+			sort_partition(buf, lo, n, el_size, cmp, args, &l_mid, &u_mid);
+
+			vec_l_len = ((size_t)l_mid - (size_t)lo)/el_size;
+			vec_u_len = n - ((size_t)u_mid - (size_t)lo)/el_size;
+			if (vec_l_len < vec_u_len) {
+				stack[top].vec = u_mid;
+				stack[top].len = vec_u_len;
+				stack[top++].depth = depth;
+				n = vec_l_len;
+			} else {
+				stack[top].vec = lo;
+				stack[top].len = vec_l_len;
+				stack[top++].depth = depth;
+				lo = u_mid;
+				n = vec_u_len;
+			}
+		}
+		sort_insertion(lo, n, el_size, cmp, args);
+	}
+	if (buf != small) {
+		free(buf);
+	}
+}
 
+SORT_DEFINE(sort_size_t, size_t, LESS)
+SORT_DEFINE(sort_uint64, uint64_t, LESS)
+SORT_DEFINE(sort_float, float, LESS)
@@ -1,6 +1,6 @@
 /**
  * \file            sort.h
- * \brief           Prototype of function sort
+ * \brief           Prototypes of the sort functions
  */
 
 /*
@@ -42,6 +42,7 @@
 /**********************/
 
 #include <stdlib.h>
+#include <stdint.h>
 
 
 /*************************/
@@ -49,6 +50,9 @@
 /*************************/
 
 void 	sort(void* const, size_t, size_t, int (*)(const void*, const void*, void*), void*);
+void 	sort_size_t(size_t* const, size_t);
+void 	sort_uint64(uint64_t* const, size_t);
+void 	sort_float(float* const, size_t);
 
 
 #endif /* guard */
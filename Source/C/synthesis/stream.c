@@ -0,0 +1,290 @@
+/**
+ * \file 		stream.c
+ * \brief 		define stream_synth
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of stream.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include "stream.h"
+#include "../config.h"
+#include "binarize.h"
+#include "binfile.h"
+#include "bitboard.h"
+#include "gram.h"
+#include "hash.h"
+#include "trace.h"
+
+
+/***********************/
+/*!< types definitions */
+/***********************/
+
+/**
+ * \brief 		stream_t
+ * \note		An image read a row at a time. After the row raw, the codes are
+ *              the packed grams whose bottom row is raw.
+*/
+typedef struct
+{
+	const gram_kernel_t* 	kernel; 	/*!< kernel of the grams */
+	const ppm_t* 	image; 		/*!< mapped image */
+	uint32_t 		median; 	/*!< brightness code of the threshold */
+	uint8_t* 		buffer; 	/*!< a row of converted pixels */
+	bitboard_t 		line; 		/*!< a row of the bitboard */
+	uint64_t* 		codes; 		/*!< rolling codes of a row of grams */
+	int32_t 		raw; 		/*!< next row */
+} stream_t;
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+int 	stream_open(stream_t*, const gram_kernel_t*, const ppm_t*);
+void 	stream_rewind(stream_t*);
+int 	stream_next(stream_t*);
+void 	stream_close(stream_t*);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    start to stream an image
+ * \note 	    the median brightness is computed by a first pass on the image.
+ * \param[out] 	stream: stream
+ * \param[in] 	kernel: kernel of the grams
+ * \param[in] 	image: mapped image
+ * \return 		0: any error.
+ *              1: out of memory.
+ */
+int
+stream_open(stream_t* stream, const gram_kernel_t* kernel, const ppm_t* image)
+{
+	stream->kernel = kernel;
+	stream->image = image;
+	stream->line.words = NULL;
+	stream->buffer = malloc(3*(size_t)image->width);
+	stream->codes = calloc(image->width, sizeof (uint64_t));
+	TRACE_COUNT(TRACE_ALLOCATIONS, 2);
+	if (stream->buffer == NULL || stream->codes == NULL ||
+		bitboard_alloc(&stream->line, image->width, 1) ||
+		binarize_ppm_median(image, &stream->median)) {
+		free(stream->buffer);
+		free(stream->codes);
+		bitboard_free(&stream->line);
+		return 1;
+	}
+	stream->raw = 0;
+	return 0;
+}
+
+/**
+ * \brief 	    restart a stream from the first row
+ * \param[in] 	stream: stream
+ */
+void
+stream_rewind(stream_t* stream)
+{
+	for (int32_t col = 0; col < stream->image->width; ++col)
+		stream->codes[col] = 0;
+	stream->raw = 0;
+}
+
+/**
+ * \brief 	    binarize the next row and roll the codes
+ * \param[in] 	stream: stream
+ * \return 		1 if the codes are a complete row of grams.
+ */
+int
+stream_next(stream_t* stream)
+{
+	const gram_kernel_t* kernel = stream->kernel;
+	int32_t num_of_cols = stream->image->width - kernel->size + 1;
+
+	binarize_ppm_row(stream->image, stream->raw, stream->median, stream->buffer, stream->line.words);
+	if (num_of_cols > 0) {
+		kernel->roll(kernel, stream->line.words, stream->codes, stream->codes, (size_t)num_of_cols);
+	}
+	return ++stream->raw >= kernel->size && num_of_cols > 0;
+}
+
+/**
+ * \brief 	    free a stream
+ * \param[in] 	stream: stream
+ */
+void
+stream_close(stream_t* stream)
+{
+	free(stream->buffer);
+	free(stream->codes);
+	bitboard_free(&stream->line);
+}
+
+/**
+ * \brief 	    synthesize an image streaming its rows
+ * \note 	    the image is read four times from the mapping: the histogram of the
+ *              brightness, the count of the grams, the recurrence map and the bitboard.
+ *              The memory is a few rows of the image and the table of distinct grams,
+ *              the map and the bitboard are written to the file a row at a time.
+ * \param[in] 	model: model of the synthesis
+ * \param[in] 	kernel: kernel of the grams
+ * \param[in] 	image: mapped image
+ * \param[in] 	fp: synthesis file
+ * \return 		0: any error.
+ *              1: out of memory.
+ *              2: write error.
+ */
+int
+stream_synth(int32_t model, const gram_kernel_t* kernel, const ppm_t* image, FILE* fp)
+{
+	int32_t width = image->width, height = image->height, num_of_cols = width - kernel->size + 1;
+	stream_t stream;
+	hash_t table = {0};
+	binfile_t file;
+
+	if (stream_open(&stream, kernel, image)) {
+		return 1;
+	}
+	if (hash_alloc(&table, 0, NULL)) {
+		stream_close(&stream);
+		return 1;
+	}
+	if (binfile_create(&file, fp, model, kernel->size, width, height)) {
+		hash_free(&table);
+		stream_close(&stream);
+		return 2;
+	}
+
+	/* count the grams */
+	while (stream.raw < height) {
+		if (stream_next(&stream)) {
+			size_t first = (size_t)(stream.raw - kernel->size) * width;
+
+			for (int32_t col = 0; col < num_of_cols; ++col) {
+				if (hash_insert(&table, stream.codes[col], first + col)) {
+					hash_free(&table);
+					stream_close(&stream);
+					return 1;
+				}
+			}
+		}
+	}
+
+	/* list of the grams and recurrences, in ascending order */
+	{
+		uint64_t* keys = calloc(table.size ? table.size : 1, sizeof (uint64_t));
+		size_t* slots = calloc(table.size ? table.size : 1, sizeof (size_t));
+		int output = 0;
+
+		TRACE_COUNT(TRACE_ALLOCATIONS, 2);
+		if (keys == NULL || slots == NULL || hash_sorted(&table, keys, slots, kernel->bits)) {
+			free(keys);
+			free(slots);
+			hash_free(&table);
+			stream_close(&stream);
+			return 1;
+		}
+		output = binfile_write_grams(&file, keys, table.size) || binfile_begin(&file, BINFILE_COUNTS, BINFILE_RAW);
+		for (size_t i = 0; !output && i < table.size; ++i) {
+			uint32_t recurrence = table.counts[slots[i]];
+
+			output = binfile_write(&file, &recurrence, sizeof (uint32_t));
+		}
+		free(keys);
+		free(slots);
+		if (output || binfile_begin(&file, BINFILE_MAP, BINFILE_RAW)) {
+			hash_free(&table);
+			stream_close(&stream);
+			return 2;
+		}
+	}
+
+	/* recurrence map, a row of floats at a time */
+	{
+		float* map = calloc(width, sizeof (float));
+		int32_t num_of_rows = 0;
+		int output = 0;
+
+		TRACE_COUNT(TRACE_ALLOCATIONS, 1);
+		if (map == NULL) {
+			hash_free(&table);
+			stream_close(&stream);
+			return 1;
+		}
+		stream_rewind(&stream);
+		while (stream.raw < height) {
+			if (stream_next(&stream)) {
+				for (int32_t col = 0; col < num_of_cols; ++col)
+					map[col] = 1./hash_find(&table, stream.codes[col]);
+				output = output || binfile_write(&file, map, width * sizeof (float));
+				++num_of_rows;
+			}
+		}
+		for (int32_t col = 0; col < width; ++col)
+			map[col] = 0;
+		for (; num_of_rows < height; ++num_of_rows)
+			output = output || binfile_write(&file, map, width * sizeof (float));
+		free(map);
+		if (output || binfile_begin(&file, BINFILE_BITBOARD, BINFILE_RAW)) {
+			hash_free(&table);
+			stream_close(&stream);
+			return 2;
+		}
+	}
+
+	/* bitboard, a row of bytes at a time */
+	{
+		uint8_t* row = stream.buffer;
+		int output = 0;
+
+		for (int32_t raw = 0; !output && raw < height; ++raw) {
+			binarize_ppm_row(image, raw, stream.median, stream.buffer, stream.line.words);
+			bitboard_unpack(&stream.line, 0, row);
+			output = binfile_write(&file, row, width * sizeof (uint8_t));
+		}
+		if (output || binfile_finish(&file, gram_count(kernel, width, height))) {
+			hash_free(&table);
+			stream_close(&stream);
+			return 2;
+		}
+	}
+
+	hash_free(&table);
+	stream_close(&stream);
+	return 0;
+}
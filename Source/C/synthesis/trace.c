@@ -0,0 +1,314 @@
+/**
+ * \file 		trace.c
+ * \brief 		define trace_event, trace_dump
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of trace.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include "trace.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define TRACE_DEPTH 16 /* max nesting of the spans of a thread */
+
+
+/***********************/
+/*!< types definitions */
+/***********************/
+
+/**
+ * \brief 		trace_record_t
+ * \note		An event of a thread, with the counters of the thread at that time.
+*/
+typedef struct
+{
+	uint64_t 	time; 						/*!< nanoseconds since the first event */
+	uint64_t 	counts[TRACE_COUNTERS]; 	/*!< counters of the thread */
+	const char* name; 						/*!< name of the span, or of the thread */
+	const char* image; 						/*!< image of the span, NULL for none */
+	int32_t 	tid; 						/*!< thread of the event */
+	char 		phase; 						/*!< 'B' begin, 'E' end, 'M' name of the thread */
+} trace_record_t;
+
+/**
+ * \brief 		trace_ring_t
+ * \note		Ring of the events of a thread. Only its thread writes it, and a ring
+ *              released by an ended thread is taken by the next new one.
+*/
+typedef struct trace_ring_s
+{
+	trace_record_t 			records[TRACE_EVENTS]; 	/*!< events, head % TRACE_EVENTS is the next one */
+	uint64_t 				head; 					/*!< num of events written */
+	int32_t 				tid; 					/*!< thread holding the ring */
+	atomic_int 				busy; 					/*!< 1 while a thread holds the ring */
+	struct trace_ring_s* 	next; 					/*!< next ring of the list */
+} trace_ring_t;
+
+
+/****************************/
+/*!< function and variables */
+/****************************/
+
+static const char* const 		trace_names[TRACE_COUNTERS] = {"comparisons", "bytes_read", "bytes_written", "allocations"};
+_Thread_local uint64_t 			trace_counts[TRACE_COUNTERS];
+static _Thread_local trace_ring_t* 	trace_ring; 			/*!< ring of the thread */
+static _Atomic(trace_ring_t*) 	trace_rings; 			/*!< list of the rings */
+static atomic_int 				trace_tids; 			/*!< num of traced threads */
+static pthread_once_t 			trace_once = PTHREAD_ONCE_INIT;
+static pthread_key_t 			trace_key; 				/*!< releases the ring at the end of its thread */
+static struct timespec 			trace_origin; 			/*!< time of the first event */
+
+void 			trace_init(void);
+void 			trace_release(void*);
+trace_ring_t* 	trace_take(void);
+void 			trace_string(FILE*, const char*);
+void 			trace_record(FILE*, const trace_record_t*, const trace_record_t*, int);
+
+
+/******************************/
+/*!< function implementations */
+/******************************/
+
+/**
+ * \brief 	    init the trace, once at the first event
+ */
+void
+trace_init(void)
+{
+	clock_gettime(CLOCK_MONOTONIC, &trace_origin);
+	pthread_key_create(&trace_key, trace_release);
+}
+
+/**
+ * \brief 	    release the ring of an ended thread
+ * \param[in] 	ring: ring of the thread
+ */
+void
+trace_release(void* ring)
+{
+	atomic_store_explicit(&((trace_ring_t*)ring)->busy, 0, memory_order_release);
+}
+
+/**
+ * \brief 	    take a released ring, or push a new one on the list
+ * \note 	    lock-free: a ring is taken by a compare and swap of its busy flag.
+ * \return 		ring of the thread, NULL if out of memory.
+ */
+trace_ring_t*
+trace_take(void)
+{
+	trace_ring_t* ring;
+
+	pthread_once(&trace_once, trace_init);
+	for (ring = atomic_load(&trace_rings); ring != NULL; ring = ring->next) {
+		int released = 0;
+
+		if (atomic_compare_exchange_strong(&ring->busy, &released, 1)) {
+			break;
+		}
+	}
+	if (ring == NULL) {
+		ring = calloc(1, sizeof (trace_ring_t));
+		if (ring == NULL) {
+			return NULL;
+		}
+		atomic_init(&ring->busy, 1);
+		ring->next = atomic_load(&trace_rings);
+		while (!atomic_compare_exchange_weak(&trace_rings, &ring->next, ring))
+			;
+	}
+	ring->tid = atomic_fetch_add(&trace_tids, 1) + 1;
+	pthread_setspecific(trace_key, ring);
+	return ring;
+}
+
+/**
+ * \brief 	    record an event of the thread
+ * \note 	    an event that does not fit in memory is lost.
+ * \param[in] 	phase: 'B' begin of a span, 'E' end of the last span, 'M' name of the thread
+ * \param[in] 	name: name of the span or of the thread, a literal
+ * \param[in] 	image: image of the span, NULL for none. It has to outlive the trace.
+ */
+void
+trace_event(char phase, const char* name, const char* image)
+{
+	trace_record_t* record;
+	struct timespec now;
+
+	if (trace_ring == NULL && (trace_ring = trace_take()) == NULL) {
+		return;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	record = &trace_ring->records[trace_ring->head++ % TRACE_EVENTS];
+	record->time = (uint64_t)(now.tv_sec - trace_origin.tv_sec) * 1000000000u + now.tv_nsec - trace_origin.tv_nsec;
+	memcpy(record->counts, trace_counts, sizeof (trace_counts));
+	record->name = name;
+	record->image = image;
+	record->tid = trace_ring->tid;
+	record->phase = phase;
+}
+
+/**
+ * \brief 	    write a JSON string
+ * \param[in] 	fp: file
+ * \param[in] 	string: string
+ */
+void
+trace_string(FILE* fp, const char* string)
+{
+	fputc('"', fp);
+	for (; *string != '\0'; ++string) {
+		if (*string == '"' || *string == '\\') {
+			fputc('\\', fp);
+		}
+		fputc(*string, fp);
+	}
+	fputc('"', fp);
+}
+
+/**
+ * \brief 	    write an event in the trace event format
+ * \note 	    the end of a span has as arguments the counters of the thread during the span.
+ * \param[in] 	fp: file
+ * \param[in] 	record: event
+ * \param[in] 	begin: begin of the span ended by the event, NULL for none
+ * \param[in] 	first: 1 if it is the first event of the file
+ */
+void
+trace_record(FILE* fp, const trace_record_t* record, const trace_record_t* begin, int first)
+{
+	fprintf(fp, "%s\n{\"pid\": %ld, \"tid\": %d, \"ph\": \"%c\", \"ts\": %.3f, \"name\": ", first ? "" : ",",
+		(long)getpid(), record->tid, record->phase, 1e-3*record->time);
+	trace_string(fp, record->phase == 'M' ? "thread_name" : record->name);
+	if (record->phase == 'M') {
+		fprintf(fp, ", \"args\": {\"name\": ");
+		trace_string(fp, record->name);
+		fprintf(fp, "}");
+	} else if (record->phase == 'B' && record->image != NULL) {
+		fprintf(fp, ", \"args\": {\"image\": ");
+		trace_string(fp, record->image);
+		fprintf(fp, "}");
+	} else if (record->phase == 'E' && begin != NULL) {
+		fprintf(fp, ", \"args\": {");
+		for (int32_t i = 0; i < TRACE_COUNTERS; ++i)
+			fprintf(fp, "%s\"%s\": %llu", i ? ", " : "", trace_names[i],
+				(unsigned long long)(record->counts[i] - begin->counts[i]));
+		fprintf(fp, "}");
+	}
+	fprintf(fp, "}");
+}
+
+/**
+ * \brief 	    write the trace of the run and free the rings
+ * \note 	    the trace is TRACE_FILE in the synthesis folder, in the trace event format
+ *              of chrome://tracing and Perfetto. The threads have ended: the rings are
+ *              read without locks. The ends of spans overwritten in a ring are dropped,
+ *              the spans left open end at the last event of their thread.
+ * \param[in] 	directory: synthesis folder
+ * \return 		0: any error.
+ *              1: write error.
+ */
+int
+trace_dump(const char* directory)
+{
+	char path[FILENAME_MAX];
+	trace_ring_t* ring = atomic_exchange(&trace_rings, NULL);
+	FILE* fp;
+	int output, first = 1;
+
+	/* the rings are freed, a later event of this thread takes a new one */
+	pthread_once(&trace_once, trace_init);
+	pthread_setspecific(trace_key, NULL);
+	trace_ring = NULL;
+
+	snprintf(path, FILENAME_MAX, "%s/%s", directory, TRACE_FILE);
+	fp = fopen(path, "w");
+	if (fp != NULL) {
+		fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+	}
+	while (ring != NULL) {
+		trace_ring_t* next = ring->next;
+		const trace_record_t* stack[TRACE_DEPTH];
+		int32_t depth = 0;
+
+		for (uint64_t i = ring->head > TRACE_EVENTS ? ring->head - TRACE_EVENTS : 0; fp != NULL && i <= ring->head; ++i) {
+			const trace_record_t* record = i < ring->head ? &ring->records[i % TRACE_EVENTS] : NULL;
+
+			/* close the spans of the previous thread of the ring */
+			while (depth > 0 && (record == NULL || record->tid != stack[depth - 1]->tid)) {
+				const trace_record_t* last = &ring->records[(i - 1) % TRACE_EVENTS];
+				trace_record_t end = *last;
+
+				end.phase = 'E';
+				end.name = stack[depth - 1]->name;
+				end.tid = stack[depth - 1]->tid;
+				trace_record(fp, &end, stack[--depth], first);
+				first = 0;
+			}
+			if (record == NULL || (record->phase == 'E' && depth == 0)) {
+				continue;
+			}
+			trace_record(fp, record, record->phase == 'E' ? stack[depth - 1] : NULL, first);
+			first = 0;
+			if (record->phase == 'E') {
+				--depth;
+			} else if (record->phase == 'B' && depth < TRACE_DEPTH) {
+				stack[depth++] = record;
+			}
+		}
+		free(ring);
+		ring = next;
+	}
+	if (fp != NULL) {
+		fprintf(fp, "\n]}\n");
+	}
+	output = fp == NULL || ferror(fp);
+	if (fp != NULL && fclose(fp) != 0) {
+		output = 1;
+	}
+	return output;
+}
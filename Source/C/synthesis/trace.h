@@ -0,0 +1,88 @@
+/**
+ * \file            trace.h
+ * \brief           Trace of the stages of the synthesis, compiled in by SYNTHESIS_TRACE
+ */
+
+/*
+ * Copyright (c) 2023 Stefano MAGRINI ALUNNO
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of trace.
+ *
+ * Author:          Stefano MAGRINI ALUNNO <stefanomagrini99@gmail.com>
+ */
+
+
+
+
+
+
+#ifndef TRACE_H
+#define TRACE_H
+
+
+/**********************/
+/*!< included headers */
+/**********************/
+
+#include <stdlib.h>
+#include <stdint.h>
+
+
+/***********************/
+/*!< MACRO definitions */
+/***********************/
+
+#define TRACE_COMPARISONS 0 /* comparisons of grams, by the comparison sort and the probes of the hash tables */
+#define TRACE_BYTES_READ 1 /* bytes of the images mapped or hashed */
+#define TRACE_BYTES_WRITTEN 2 /* bytes of the synthesis files */
+#define TRACE_ALLOCATIONS 3 /* buffers allocated by the synthesis of the images */
+#define TRACE_COUNTERS 4 /* num of counters */
+#define TRACE_EVENTS 8192 /* events kept by a thread, the oldest ones are overwritten */
+#define TRACE_FILE "trace.json" /* trace in the synthesis folder */
+
+#ifdef SYNTHESIS_TRACE
+	#define TRACE_BEGIN(name, image) trace_event('B', name, image)
+	#define TRACE_END(name) trace_event('E', name, NULL)
+	#define TRACE_THREAD(name) trace_event('M', name, NULL)
+	#define TRACE_COUNT(counter, n) ((void)(trace_counts[counter] += (uint64_t)(n)))
+	#define TRACE_DUMP(directory) trace_dump(directory)
+#else
+	#define TRACE_BEGIN(name, image) ((void)0)
+	#define TRACE_END(name) ((void)0)
+	#define TRACE_THREAD(name) ((void)0)
+	#define TRACE_COUNT(counter, n) ((void)0)
+	#define TRACE_DUMP(directory) 0
+#endif /* SYNTHESIS_TRACE */
+
+
+/*************************/
+/*!< function prototypes */
+/*************************/
+
+extern _Thread_local uint64_t 	trace_counts[TRACE_COUNTERS]; 	/*!< counters of the thread */
+
+void 	trace_event(char, const char*, const char*);
+int 	trace_dump(const char*);
+
+
+#endif /* guard */
@@ -6,14 +6,103 @@ Date: 2023 / 10 / 06
 This file defines functions that can be used to analyze the results.
 
 It requires the installation of:
-    * 'struct', 'os', 'PIL'
+    * 'struct', 'os', 'numpy', 'PIL'
 """
 
 import struct
 import os
+import numpy as np
 from PIL import Image
 
 
+""" Synthesis file, version 2 """
+BINFILE_MAGIC = b'SYNB'
+BINFILE_HEADER = struct.Struct('<4sHHii2iiiQQII')  # 56 bytes
+BINFILE_SECTION = struct.Struct('<IIQQ')  # id, encoding, offset, size
+BINFILE_SECTIONS = 4
+BINFILE_GRAMS = 1
+BINFILE_COUNTS = 2
+BINFILE_MAP = 3
+BINFILE_BITBOARD = 4
+BINFILE_GRAMS_WIDE = 5
+BINFILE_CONFIDENCE_SCALE = 10000  # OPINION_SCALE of opinion.h
+
+
+def read_synthesis(src_file: str) -> dict:
+    """
+    This function maps a synthesis file of version 2.
+
+    The file is mapped by numpy.memmap: the recurrences, the recurrence map and
+    the bitboard are views of the mapping, nothing is copied until they are
+    read. Only the grams, stored as varint-delta packed codes, are decoded;
+    the grams of more than 64 bits of the multilayer model are stored raw.
+
+    Parameters
+    ----------
+    src_file : str
+        Path of the synthesis file.
+
+    Returns
+    -------
+    synthesis : dict
+        'gram_size', 'model', 'layers' (0 but for the multilayer model), 'area'
+        and 'confidence' (0 but for the opinion model), 'width', 'height', 'total',
+        'codes': uint64 packed grams, ascending, the first pixel in the most
+        significant bits, or num_of_grams x 2 uint64 high and low words of the
+        grams of more than 64 bits,
+        'counts': uint32 recurrences of the grams,
+        'map': float32 height x width recurrence map, or None if missing,
+        'bitboard': uint8 height x width bitboard, the layers of the pixels for
+        the multilayer model, or None if missing.
+
+    """
+    raw = np.memmap(src_file, dtype=np.uint8, mode='r')
+    (magic, version, endianness, model, gram_size, first, second, width, height,
+        num_of_grams, total, num_of_sections, _) = BINFILE_HEADER.unpack_from(raw, 0)
+    if magic != BINFILE_MAGIC or version != 2 or endianness != 0x0102:
+        raise ValueError(f"{src_file} is not a synthesis file of version 2")
+
+    sections = {}
+    for i in range(num_of_sections):
+        section_id, _, offset, size = BINFILE_SECTION.unpack_from(
+            raw, BINFILE_HEADER.size + i * BINFILE_SECTION.size)
+        sections[section_id] = raw[offset:offset + size]
+
+    if BINFILE_GRAMS_WIDE in sections:
+        codes = sections[BINFILE_GRAMS_WIDE].view('<u8').reshape(-1, 2)
+    else:
+        # varint-delta grams: 7 bits a byte, the high bit set on all bytes but the last
+        grams = np.asarray(sections[BINFILE_GRAMS])
+        last = (grams & 0x80) == 0
+        starts = np.concatenate(([0], np.flatnonzero(last)[:-1] + 1))
+        shifts = np.arange(len(grams)) - np.repeat(starts, np.diff(np.append(starts, len(grams))))
+        digits = (grams & 0x7f).astype(np.uint64) << (7 * shifts).astype(np.uint64)
+        deltas = np.add.reduceat(digits, starts) if len(grams) else np.zeros(0, np.uint64)
+        codes = np.cumsum(deltas, dtype=np.uint64)
+    if len(codes) != num_of_grams:
+        raise ValueError(f"{src_file} has a truncated section of grams")
+
+    def view(section_id, dtype):
+        section = sections.get(section_id)
+        return None if section is None else section.view(dtype)
+
+    recurrence_map = view(BINFILE_MAP, '<f4')
+    bitboard = view(BINFILE_BITBOARD, np.uint8)
+    return {
+        'gram_size': gram_size,
+        'model': model,
+        'layers': first if model == 1 else 0,
+        'area': first if model == 2 else 0,
+        'confidence': second / BINFILE_CONFIDENCE_SCALE if model == 2 else 0,
+        'width': width,
+        'height': height,
+        'total': total,
+        'codes': codes,
+        'counts': view(BINFILE_COUNTS, '<u4'),
+        'map': None if recurrence_map is None else recurrence_map.reshape(height, width),
+        'bitboard': None if bitboard is None else bitboard.reshape(height, width)}
+
+
 def work_analysis(src_file: str, dest_dir: str) -> tuple:
     """
     This function analyzes individual works.
@@ -36,27 +125,16 @@ def work_analysis(src_file: str, dest_dir: str) -> tuple:
 
     """
     """
-    # extract data from source file
-    with open(src_file, 'rb') as file:
-        size = struct.unpack('i', file.read(4))[0]
-        num_of_data = struct.unpack('i', file.read(4))[0]
-
-        grams = []
-        recurrences = []
-
-        num_of_px = size ** 2
-        for _ in range(num_of_data):
-            grams.append(file.read(num_of_px))
-
-        for _ in range(num_of_data):
-            recurrences.append(struct.unpack('i', file.read(4))[0])
-
-        width = struct.unpack('i', file.read(4))[0]
-        height = struct.unpack('i', file.read(4))[0]
-        recurrence_map = struct.unpack(
-            'f'*width*height,
-            file.read(width*height*4))
-        bw_imag = file.read(width*height*4)
+    # map the synthesis file
+    synthesis = read_synthesis(src_file)
+    size = synthesis['gram_size']
+    width = synthesis['width']
+    height = synthesis['height']
+    recurrence_map = synthesis['map'].ravel()
+    bw_imag = synthesis['bitboard'].ravel()
+    shifts = np.arange(size ** 2 - 1, -1, -1, dtype=np.uint64)
+    grams = [bytes(((code >> shifts) & 1).astype(np.uint8)) for code in synthesis['codes']]
+    recurrences = synthesis['counts'].tolist()
 
     # make map
     normalized_values = [int(value * 255) for value in recurrence_map]
@@ -81,60 +159,29 @@ def work_analysis(src_file: str, dest_dir: str) -> tuple:
 
 def author_analysis(directory, works_list):
     """
-    def merge(list1, list2):
-        merged = []
-        i = 0
-        j = 0
-        while i < len(list1) and j < len(list2):
-            data_i = list1[i]
-            data_j = list2[j]
-
-            # comparison
-            for b1, b2 in zip(data_i[0], data_j[0]):
-                if b1 < b2:
-                    ret = -1
-                    break
-                elif b1 > b2:
-                    ret = 1
-                    break
-            else:
-                ret = 0
-
-            # append in merged list
-            if ret < 0:
-                merged.append(data_i)
-                i += 1
-            elif ret > 0:
-                merged.append(data_j)
-                j += 1
-            else:
-                merged.append((data_i[0], data_i[1] + data_j[1]))
-                i += 1
-                j += 1
-        merged += list1[i:]
-        merged += list2[j:]
-        return merged
-
-    def multiple_merge(lists):
-        while len(lists) > 1:
-            lists = sorted(lists, key=lambda x: len(x[0]), reverse=True)
-            # perform a merge of the last two elements of lists
-            lists.append((merge(lists.pop()[0], lists.pop()[0]),))
-        return lists[0]
-
-    author_grams_list = multiple_merge(works_list)[0]
-
-    sorted_data = sorted(author_grams_list, key=lambda x: x[1])
-    size = len(sorted_data[0])
-    order_grams_file = os.path.join(directory, 'order_grams.bin')
-    with open(order_grams_file, 'wb') as file:
-        file.write(struct.pack('i', size))
-        for data in sorted_data:
-            file.write(data[0])
-            file.write(struct.pack('i', data[1]))
-    return
+    This function analyzes an author.
+
+    The aggregated profile of the author, 'order_grams.bin' in 'directory', is
+    written by the program in Source/C/author for all authors at once. It holds
+    int32 gram size, int32 num of grams, the grams packed in (size^2 + 7) // 8
+    bytes each, the first pixel in the most significant bit, then their uint64
+    recurrences, by increasing recurrence.
+
+    Parameters
+    ----------
+    directory : str
+        Directory of the author's analysis.
+    works_list : List
+        Analyses of the works of the author.
+
+    Returns
+    -------
+    order_grams_file : str
+        Path of the aggregated profile of the author.
+
     """
-    return
+    return os.path.join(directory, 'order_grams.bin')
+
 
 def analysis(directory, authors_list):
 	return
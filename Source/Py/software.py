@@ -11,17 +11,19 @@ This script imports the following functions:
 	* 'analyze_work',
 	* 'analyze_author',
 	* 'analyze'
-from the 'analysis' file.
+from the 'analysis' file, and the binding of the synthesis library from the 'synthesis' file.
 
 It requires the installation of:
-	* 'os', 'shutil', 'subprocess', 'sys', 'typing'
+	* 'os', 're', 'shutil', 'subprocess', 'sys', 'typing'
 """
 
 from analysis import work_analysis
 from analysis import author_analysis
 from analysis import analysis
 from typing import List, Dict
+import synthesis
 import os
+import re
 import shutil
 import subprocess
 import sys
@@ -36,6 +38,9 @@ test_analysis_directory = os.path.join('Set', 'Test_Analysis')
 temporary_directory = 'Temporary'
 source_synthesis_directory = os.path.join('Source', 'C', 'synthesis')
 source_comparison_directory = os.path.join('Source', 'C', 'comparison')
+source_author_directory = os.path.join('Source', 'C', 'author')
+comparison_file = os.path.join('Set', 'Comparison.bin')
+config_file = os.path.join('Source', 'C', 'config.h')
 
 
 def read_training(directory: str) -> Dict[str, List[str]]:
@@ -105,6 +110,92 @@ def read_test(directory: str) -> List[str]:
 	return works_info
 
 
+def configured_model() -> int:
+	"""
+	Read the model of the syntheses from the configuration file of the C programs.
+
+	Returns
+	-------
+	model : int
+		MODEL of 'config.h', 0 if it can not be read.
+
+	"""
+	try:
+		with open(config_file) as config:
+			match = re.search(r'^#define MODEL (\d+)', config.read(), re.MULTILINE)
+	except OSError:
+		return 0
+	return int(match.group(1)) if match else 0
+
+
+def library_synth(source: str, destination: str, works: List[str]) -> bool:
+	"""
+	Perform the syntheses in process, if the library is built.
+
+	The images are synthesized by the thread pool of 'libsynthesis.so', so no
+	input file is written and no program is started. As the program does, the
+	library skips the images whose synthesis is current in 'manifest.txt'.
+	The library only makes syntheses of the model 0, so the other models are
+	left to the synthesis program.
+
+	Parameters
+	----------
+	source : str
+		Folder of the images
+	destination : str
+		Folder of the syntheses
+	works : List[str]
+		Images respect the folders
+
+	Returns
+	-------
+	done : bool
+		False if the library is not built or the model is not 0.
+
+	"""
+	if not synthesis.available() or configured_model() != 0:
+		return False
+
+	print("Starting synthesis library...")
+	try:
+		synthesis.update(
+			[os.path.join(source, work) for work in works],
+			[os.path.join(destination, work.replace('.ppm', '.bin')) for work in works],
+			os.path.join(destination, 'manifest.txt'))
+		print("Any Error!\n")
+	except Exception as e:
+		print(f"Error: {e}")
+		sys.exit(1)
+	return True
+
+
+def prune_synth(destination: str, works: List[str]):
+	"""
+	Remove the syntheses of the works that left the set.
+
+	The synthesis folders are kept between the runs, so that only the new or
+	changed works are synthesized again.
+
+	Parameters
+	----------
+	destination : str
+		Folder of the syntheses
+	works : List[str]
+		Images respect the folder
+
+	Returns
+	-------
+	None.
+
+	"""
+	current = {os.path.normpath(work.replace('.ppm', '.bin')) for work in works}
+	for root, _, files in os.walk(destination):
+		for file in files:
+			path = os.path.relpath(os.path.join(root, file), destination)
+			if file.endswith('.bin') and os.path.normpath(path) not in current:
+				os.remove(os.path.join(root, file))
+
+
 def train_synth(training: Dict[str, List[str]], test: List[str]):
 	"""
 	Perform a synth on all.
@@ -124,10 +215,7 @@ def train_synth(training: Dict[str, List[str]], test: List[str]):
 	None.
 
 	"""
-	# refresh Training_Synthesis folder
-	if os.path.exists(training_synthesis_directory):
-		shutil.rmtree(training_synthesis_directory)
-
+	# keep the current syntheses in Training_Synthesis folder
 	for author in training:
 		author_folder_path = os.path.join(
 			training_synthesis_directory, author)
@@ -141,12 +229,16 @@ def train_synth(training: Dict[str, List[str]], test: List[str]):
 		for work in works:
 			work_directory_list.append(os.path.join(author, f"{work}"))
 	num_of_directory = len(work_directory_list)
+	prune_synth(training_synthesis_directory, work_directory_list)
 
 	input_txt_contest = f"{training_directory}\n"
 	input_txt_contest += f"{training_synthesis_directory}\n"
 	input_txt_contest += f"{num_of_directory}\n"
 	input_txt_contest += "\n".join(work_directory_list)
 
+	if library_synth(training_directory, training_synthesis_directory, work_directory_list):
+		return
+
 	with open(input_txt_path, "w") as file_input:
 		file_input.write(input_txt_contest)
 
@@ -202,6 +294,37 @@ def analysis_training(training: Dict[str, List[str]], test: List[str]):
 				training_analysis_directory, author, work.replace('.ppm', ''))
 			os.makedirs(works_path, exist_ok=True)
 
+	# aggregated profiles of the authors, in parallel
+	input_txt_path = os.path.join(temporary_directory, "input.txt")
+
+	work_directory_list = []
+	for author, works in training.items():
+		for work in works:
+			work_directory_list.append(os.path.join(author, f"{work}"))
+
+	input_txt_contest = f"{training_synthesis_directory}\n"
+	input_txt_contest += f"{training_analysis_directory}\n"
+	input_txt_contest += f"{len(work_directory_list)}\n"
+	input_txt_contest += "\n".join(work_directory_list)
+
+	with open(input_txt_path, "w") as file_input:
+		file_input.write(input_txt_contest)
+
+	executable_path = os.path.join(source_author_directory, "author")
+	print("Starting author program...")
+	try:
+		result = subprocess.run(
+			[executable_path,
+				os.path.join(temporary_directory, "input.txt")],
+			stderr=subprocess.PIPE, text=True)
+		if result.returncode != 0:
+			print("Error...")
+			print(result.stderr)
+			sys.exit(1)
+	except Exception as e:
+		print(f"Error: {e}")
+		sys.exit(1)
+
 	# analysis of the synthesis, di author e del dataset
 	print("Starting analysis of synthesis...")
 
@@ -244,10 +367,7 @@ def test_synth(training: Dict[str, List[str]], test: List[str]):
 	None.
 
 	"""
-	# refresh Test_Synthesis folder
-	if os.path.exists(test_synthesis_directory):
-		shutil.rmtree(test_synthesis_directory)
-
+	# keep the current syntheses in Test_Synthesis folder
 	if len(test) != 0:
 		os.makedirs(test_synthesis_directory, exist_ok=True)
 
@@ -256,12 +376,16 @@ def test_synth(training: Dict[str, List[str]], test: List[str]):
 
 	work_directory_list = test
 	num_of_directory = len(work_directory_list)
+	prune_synth(test_synthesis_directory, work_directory_list)
 
 	input_txt_contest = f"{test_directory}\n"
 	input_txt_contest += f"{test_synthesis_directory}\n"
 	input_txt_contest += f"{num_of_directory}\n"
 	input_txt_contest += "\n".join(work_directory_list)
 
+	if library_synth(test_directory, test_synthesis_directory, work_directory_list):
+		return
+
 	with open(input_txt_path, "w") as file_input:
 		file_input.write(input_txt_contest)
 
@@ -332,7 +456,67 @@ def analysis_test(training, test):
 	return
 
 
-def comparison(training, test):
+def comparison(training: Dict[str, List[str]], test: List[str]):
+	"""
+	Compares each work of the test set with each work of the training set.
+
+	Prepares the input file and calls the program that computes in parallel
+	the similarity matrices of the syntheses.
+	The file 'comparison_file' holds the number of test works, the number of
+	training works, the number of metrics, then a float32 matrix test x training
+	for each metric: cosine similarity, histogram intersection and
+	Jensen-Shannon distance. The rows follow the test list and the columns
+	follow the training works, author by author.
+
+	Parameters
+	----------
+	training : Dict[str, List[str]]
+		It's the training set dictionary.
+	test : List[str]
+		It's the test set list.
+
+	Returns
+	-------
+	None.
+
+	"""
+	# make dir for input.txt file
+	input_txt_path = os.path.join(temporary_directory, "input.txt")
+
+	training_list = []
+	for author, works in training.items():
+		for work in works:
+			training_list.append(os.path.join(author, f"{work}"))
+
+	input_txt_contest = f"{test_synthesis_directory}\n"
+	input_txt_contest += f"{training_synthesis_directory}\n"
+	input_txt_contest += f"{comparison_file}\n"
+	input_txt_contest += f"{len(test)}\n"
+	input_txt_contest += "".join(f"{work}\n" for work in test)
+	input_txt_contest += f"{len(training_list)}\n"
+	input_txt_contest += "\n".join(training_list)
+
+	with open(input_txt_path, "w") as file_input:
+		file_input.write(input_txt_contest)
+
+	# start comparison program
+	executable_path = os.path.join(source_comparison_directory, "comparison")
+	print("Starting comparison program...")
+	try:
+		result = subprocess.run(
+			[executable_path,
+				os.path.join(temporary_directory, "input.txt")],
+			stderr=subprocess.PIPE, text=True)
+		if result.returncode != 0:
+			print("Error...")
+			print(result.stderr)
+			sys.exit(1)
+		else:
+			print("Any Error!\n")
+	except Exception as e:
+		print(f"Error: {e}")
+		sys.exit(1)
+
 	return
 
 
@@ -0,0 +1,298 @@
+"""Synthesis library binding.
+
+Author: Stefano Magrini Alunno
+Date: 2023 / 10 / 06
+
+This file binds the shared library 'libsynthesis.so' through ctypes, so the
+syntheses run in process: no input file, no subprocess and, for the interactive
+uses, no round trip of the '.bin' files on disk.
+
+The library is built by 'make LIB' in Source/C/synthesis.
+
+It requires the installation of:
+    * 'ctypes', 'os', 'typing', 'numpy'
+"""
+
+from typing import List, Optional, Union
+import ctypes
+import os
+import numpy as np
+
+""" Path of the shared library """
+library_path = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)),
+    '..', 'C', 'synthesis', 'libsynthesis.so')
+
+SYNTHESIS_ABI_VERSION = 1
+
+
+class Synthesis(ctypes.Structure):
+    """Mirror of synthesis_t in libsynthesis.h."""
+
+    _fields_ = [
+        ('gram_size', ctypes.c_int32),
+        ('width', ctypes.c_int32),
+        ('height', ctypes.c_int32),
+        ('size', ctypes.c_uint64),
+        ('total', ctypes.c_uint64),
+        ('codes', ctypes.POINTER(ctypes.c_uint64)),
+        ('counts', ctypes.POINTER(ctypes.c_uint32)),
+        ('map', ctypes.POINTER(ctypes.c_float)),
+        ('bitboard', ctypes.POINTER(ctypes.c_uint8))]
+
+
+_library = None
+
+
+def available() -> bool:
+    """
+    This function checks that the library is built.
+
+    Returns
+    -------
+    available : bool
+        True if 'libsynthesis.so' exists.
+
+    """
+    return os.path.exists(library_path)
+
+
+def _load() -> ctypes.CDLL:
+    """
+    This function loads the library once and declares its functions.
+
+    Returns
+    -------
+    library : ctypes.CDLL
+        The library.
+
+    """
+    global _library
+    if _library is None:
+        library = ctypes.CDLL(library_path)
+        library.synthesis_abi_version.restype = ctypes.c_int
+        if library.synthesis_abi_version() != SYNTHESIS_ABI_VERSION:
+            raise RuntimeError(f"{library_path} has an incompatible version")
+        library.synthesis_gram_size.restype = ctypes.c_int32
+        library.synthesis_set_gram_size.argtypes = [ctypes.c_int32]
+        library.synthesis_from_path.argtypes = [
+            ctypes.c_char_p, ctypes.c_int32, ctypes.POINTER(Synthesis)]
+        library.synthesis_from_buffer.argtypes = [
+            ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int32, ctypes.POINTER(Synthesis)]
+        library.synthesis_write.argtypes = [ctypes.POINTER(Synthesis), ctypes.c_char_p]
+        library.synthesis_batch.argtypes = [
+            ctypes.c_int32, ctypes.POINTER(ctypes.c_char_p), ctypes.POINTER(ctypes.c_char_p),
+            ctypes.POINTER(Synthesis), ctypes.c_int32, ctypes.POINTER(ctypes.c_int32)]
+        library.synthesis_update.argtypes = [
+            ctypes.c_int32, ctypes.POINTER(ctypes.c_char_p), ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_char_p, ctypes.c_int32, ctypes.POINTER(ctypes.c_int32)]
+        library.synthesis_release.argtypes = [ctypes.POINTER(Synthesis)]
+        library.synthesis_release.restype = None
+        library.synthesis_error.argtypes = [ctypes.c_int]
+        library.synthesis_error.restype = ctypes.c_char_p
+        _library = library
+    return _library
+
+
+def _check(code: int, what: str):
+    """
+    This function raises the error of the library, if any.
+
+    Parameters
+    ----------
+    code : int
+        Returned code.
+    what : str
+        Image or file of the error.
+
+    Returns
+    -------
+    None.
+
+    """
+    if code != 0:
+        message = _load().synthesis_error(code).decode()
+        raise RuntimeError(f"{message}: {what}")
+
+
+def _to_dict(result: Synthesis) -> dict:
+    """
+    This function copies a synthesis in numpy arrays and releases it.
+
+    Parameters
+    ----------
+    result : Synthesis
+        Synthesis of the library.
+
+    Returns
+    -------
+    synthesis : dict
+        Same keys of 'read_synthesis' in analysis.py.
+
+    """
+    try:
+        shape = (result.height, result.width)
+        size = result.size
+        return {
+            'gram_size': result.gram_size,
+            'model': 0,
+            'width': result.width,
+            'height': result.height,
+            'total': result.total,
+            'codes': np.ctypeslib.as_array(result.codes, (size,)).copy() if size
+            else np.zeros(0, np.uint64),
+            'counts': np.ctypeslib.as_array(result.counts, (size,)).copy() if size
+            else np.zeros(0, np.uint32),
+            'map': np.ctypeslib.as_array(result.map, shape).copy(),
+            'bitboard': np.ctypeslib.as_array(result.bitboard, shape).copy()}
+    finally:
+        _load().synthesis_release(ctypes.byref(result))
+
+
+def set_gram_size(size: int):
+    """
+    This function sets the size of the grams of the next syntheses.
+
+    Parameters
+    ----------
+    size : int
+        Size of the grams, from 1 to 8.
+
+    Returns
+    -------
+    None.
+
+    """
+    _check(_load().synthesis_set_gram_size(size), f"gram size {size}")
+
+
+def synthesize(image: Union[str, bytes], threads: int = 0) -> dict:
+    """
+    This function synthesizes an image in process.
+
+    Parameters
+    ----------
+    image : Union[str, bytes]
+        Path of the image, or the bytes of a P4, P5 or P6 image file.
+    threads : int
+        Threads of a large image, 0 uses the num of online CPUs.
+
+    Returns
+    -------
+    synthesis : dict
+        Same keys of 'read_synthesis' in analysis.py.
+
+    """
+    library = _load()
+    result = Synthesis()
+    if isinstance(image, (bytes, bytearray)):
+        data = bytes(image)
+        code = library.synthesis_from_buffer(data, len(data), threads, ctypes.byref(result))
+        _check(code, "buffer")
+    else:
+        code = library.synthesis_from_path(image.encode(), threads, ctypes.byref(result))
+        _check(code, image)
+    return _to_dict(result)
+
+
+def synthesize_batch(inputs: List[str], outputs: Optional[List[str]] = None,
+                     threads: int = 0, keep: bool = False) -> Optional[List[dict]]:
+    """
+    This function synthesizes a list of images on the thread pool of the library.
+
+    Parameters
+    ----------
+    inputs : List[str]
+        Paths of the images.
+    outputs : Optional[List[str]]
+        Paths of the synthesis files, None to write nothing.
+    threads : int
+        Num of threads, 0 uses the num of online CPUs.
+    keep : bool
+        If True, the syntheses are returned.
+
+    Returns
+    -------
+    syntheses : Optional[List[dict]]
+        The syntheses if keep is True, else None.
+
+    """
+    library = _load()
+    count = len(inputs)
+    c_inputs = (ctypes.c_char_p * max(count, 1))(*[path.encode() for path in inputs])
+    c_outputs = None
+    if outputs is not None:
+        c_outputs = (ctypes.c_char_p * max(count, 1))(*[path.encode() for path in outputs])
+    results = (Synthesis * max(count, 1))() if keep else None
+    failed = ctypes.c_int32(-1)
+
+    code = library.synthesis_batch(count, c_inputs, c_outputs, results, threads, ctypes.byref(failed))
+    if code != 0:
+        for i in range(count if keep else 0):
+            library.synthesis_release(ctypes.byref(results[i]))
+        _check(code, inputs[failed.value])
+    return [_to_dict(results[i]) for i in range(count)] if keep else None
+
+
+def update(inputs: List[str], outputs: List[str], manifest: str, threads: int = 0):
+    """
+    This function writes the synthesis files that are not current.
+
+    A synthesis file is current if its image and the parameters of the
+    synthesis did not change since the run recorded in the manifest, the same
+    'manifest.txt' of the synthesis program.
+
+    Parameters
+    ----------
+    inputs : List[str]
+        Paths of the images.
+    outputs : List[str]
+        Paths of the synthesis files.
+    manifest : str
+        Path of the manifest.
+    threads : int
+        Num of threads, 0 uses the num of online CPUs.
+
+    Returns
+    -------
+    None.
+
+    """
+    library = _load()
+    count = len(inputs)
+    c_inputs = (ctypes.c_char_p * max(count, 1))(*[path.encode() for path in inputs])
+    c_outputs = (ctypes.c_char_p * max(count, 1))(*[path.encode() for path in outputs])
+    failed = ctypes.c_int32(-1)
+
+    code = library.synthesis_update(count, c_inputs, c_outputs, manifest.encode(), threads, ctypes.byref(failed))
+    _check(code, inputs[failed.value] if failed.value >= 0 else manifest)
+
+
+def write(synthesis: dict, dest_file: str):
+    """
+    This function writes a synthesis file of version 2.
+
+    Parameters
+    ----------
+    synthesis : dict
+        Synthesis returned by 'synthesize'.
+    dest_file : str
+        Path of the synthesis file.
+
+    Returns
+    -------
+    None.
+
+    """
+    codes = np.ascontiguousarray(synthesis['codes'], dtype=np.uint64)
+    counts = np.ascontiguousarray(synthesis['counts'], dtype=np.uint32)
+    recurrence_map = np.ascontiguousarray(synthesis['map'], dtype=np.float32)
+    bitboard = np.ascontiguousarray(synthesis['bitboard'], dtype=np.uint8)
+    result = Synthesis(
+        synthesis['gram_size'], synthesis['width'], synthesis['height'],
+        len(codes), synthesis['total'],
+        codes.ctypes.data_as(ctypes.POINTER(ctypes.c_uint64)),
+        counts.ctypes.data_as(ctypes.POINTER(ctypes.c_uint32)),
+        recurrence_map.ctypes.data_as(ctypes.POINTER(ctypes.c_float)),
+        bitboard.ctypes.data_as(ctypes.POINTER(ctypes.c_uint8)))
+    _check(_load().synthesis_write(ctypes.byref(result), dest_file.encode()), dest_file)